@@ -0,0 +1,299 @@
+#include "AnswerDataCodec.h"
+
+#include <QCborValue>
+#include <QCborArray>
+#include <QCborMap>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDebug>
+
+namespace {
+
+// CBOR自描述标签编码后的前缀 (0xd9 0xd9 0xf7)
+const char kSelfDescribePrefix[] = "\xd9\xd9\xf7";
+
+// JSON中的数值是否为整数（QJsonValue统一以double保存）
+bool isIntegral(const QJsonValue &value)
+{
+    if (!value.isDouble()) {
+        return false;
+    }
+    double d = value.toDouble();
+    return d == static_cast<double>(static_cast<qint64>(d));
+}
+
+// 从题目ID字符串解析整数ID
+bool parseQuestionId(const QString &key, qint64 *id)
+{
+    bool ok = false;
+    qint64 value = key.toLongLong(&ok);
+    if (ok && id) {
+        *id = value;
+    }
+    return ok;
+}
+
+} // namespace
+
+QByteArray AnswerDataCodec::encode(const QString &json)
+{
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8(), &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        qWarning() << "答题数据JSON解析失败:" << parseError.errorString();
+        return QByteArray();
+    }
+
+    QCborArray entries;
+    Layout layout = LayoutRaw;
+
+    if (doc.isObject()) {
+        // 题目ID为键的对象
+        layout = LayoutObject;
+        QJsonObject obj = doc.object();
+        for (auto it = obj.constBegin(); it != obj.constEnd(); ++it) {
+            qint64 questionId = 0;
+            if (!parseQuestionId(it.key(), &questionId) || !it.value().isObject()) {
+                layout = LayoutRaw;
+                break;
+            }
+
+            QJsonObject item = it.value().toObject();
+            QCborMap entry;
+            entry[KeyQuestionId] = questionId;
+            if (item.value("correct").isBool()) {
+                entry[KeyCorrect] = item.take("correct").toBool();
+            }
+            if (item.contains("userAnswer")) {
+                entry[KeyUserAnswer] = QCborValue::fromJsonValue(item.take("userAnswer"));
+            }
+            if (item.contains("correctAnswer")) {
+                entry[KeyCorrectAnswer] = QCborValue::fromJsonValue(item.take("correctAnswer"));
+            }
+            if (!item.isEmpty()) {
+                entry[KeyExtra] = QCborMap::fromJsonObject(item);
+            }
+            entries.append(entry);
+        }
+    } else if (doc.isArray()) {
+        // 记录数组
+        layout = LayoutArray;
+        const QJsonArray arr = doc.array();
+        for (const QJsonValue &value : arr) {
+            QJsonObject item = value.toObject();
+            if (!value.isObject() || !isIntegral(item.value("questionId"))) {
+                layout = LayoutRaw;
+                break;
+            }
+
+            QCborMap entry;
+            entry[KeyQuestionId] = static_cast<qint64>(item.take("questionId").toDouble());
+            if (item.value("isCorrect").isBool()) {
+                entry[KeyCorrect] = item.take("isCorrect").toBool();
+            }
+            if (item.contains("userAnswer")) {
+                entry[KeyUserAnswer] = QCborValue::fromJsonValue(item.take("userAnswer"));
+            }
+            if (item.contains("correctAnswer")) {
+                entry[KeyCorrectAnswer] = QCborValue::fromJsonValue(item.take("correctAnswer"));
+            }
+            if (isIntegral(item.value("bankId"))) {
+                entry[KeyBankId] = static_cast<qint64>(item.take("bankId").toDouble());
+            }
+            if (!item.isEmpty()) {
+                entry[KeyExtra] = QCborMap::fromJsonObject(item);
+            }
+            entries.append(entry);
+        }
+    }
+
+    QCborArray root;
+    root.append(FormatVersion);
+    root.append(static_cast<int>(layout));
+    if (layout == LayoutRaw) {
+        // 无法识别的结构整体保存，保证数据不丢失
+        if (doc.isObject()) {
+            root.append(QCborMap::fromJsonObject(doc.object()));
+        } else if (doc.isArray()) {
+            root.append(QCborArray::fromJsonArray(doc.array()));
+        } else {
+            root.append(QCborValue());
+        }
+    } else {
+        root.append(entries);
+    }
+
+    QCborValue tagged(QCborKnownTags::Signature, root);
+    return tagged.toCbor();
+}
+
+bool AnswerDataCodec::isEncoded(const QByteArray &data)
+{
+    return data.startsWith(QByteArray::fromRawData(kSelfDescribePrefix, 3));
+}
+
+QString AnswerDataCodec::toJson(const QVariant &stored)
+{
+    if (stored.userType() != QMetaType::QByteArray) {
+        return stored.toString();
+    }
+
+    QByteArray data = stored.toByteArray();
+    if (!isEncoded(data)) {
+        return QString::fromUtf8(data);
+    }
+
+    QCborParserError parseError;
+    QCborValue tagged = QCborValue::fromCbor(data, &parseError);
+    if (parseError.error != QCborError::NoError) {
+        qWarning() << "答题数据CBOR解析失败:" << parseError.errorString();
+        return QString();
+    }
+
+    QCborArray root = tagged.taggedValue().toArray();
+    if (root.size() < 3 || root.at(0).toInteger() != FormatVersion) {
+        qWarning() << "不支持的答题数据编码版本";
+        return QString();
+    }
+
+    Layout layout = static_cast<Layout>(root.at(1).toInteger());
+    QCborValue payload = root.at(2);
+    QJsonDocument doc;
+
+    if (layout == LayoutObject) {
+        QJsonObject obj;
+        const QCborArray entries = payload.toArray();
+        for (const QCborValue &value : entries) {
+            QCborMap entry = value.toMap();
+            QJsonObject item = entry.value(KeyExtra).toMap().toJsonObject();
+            if (entry.contains(KeyUserAnswer)) {
+                item["userAnswer"] = entry.value(KeyUserAnswer).toJsonValue();
+            }
+            if (entry.contains(KeyCorrect)) {
+                item["correct"] = entry.value(KeyCorrect).toBool();
+            }
+            if (entry.contains(KeyCorrectAnswer)) {
+                item["correctAnswer"] = entry.value(KeyCorrectAnswer).toJsonValue();
+            }
+            obj[QString::number(entry.value(KeyQuestionId).toInteger())] = item;
+        }
+        doc.setObject(obj);
+    } else if (layout == LayoutArray) {
+        QJsonArray arr;
+        const QCborArray entries = payload.toArray();
+        for (const QCborValue &value : entries) {
+            QCborMap entry = value.toMap();
+            QJsonObject item = entry.value(KeyExtra).toMap().toJsonObject();
+            item["questionId"] = entry.value(KeyQuestionId).toInteger();
+            if (entry.contains(KeyCorrect)) {
+                item["isCorrect"] = entry.value(KeyCorrect).toBool();
+            }
+            if (entry.contains(KeyUserAnswer)) {
+                item["userAnswer"] = entry.value(KeyUserAnswer).toJsonValue();
+            }
+            if (entry.contains(KeyCorrectAnswer)) {
+                item["correctAnswer"] = entry.value(KeyCorrectAnswer).toJsonValue();
+            }
+            if (entry.contains(KeyBankId)) {
+                item["bankId"] = entry.value(KeyBankId).toInteger();
+            }
+            arr.append(item);
+        }
+        doc.setArray(arr);
+    } else if (payload.isMap()) {
+        doc.setObject(payload.toMap().toJsonObject());
+    } else if (payload.isArray()) {
+        doc.setArray(payload.toArray().toJsonArray());
+    }
+
+    return QString::fromUtf8(doc.toJson(QJsonDocument::Compact));
+}
+
+QList<AnswerDataCodec::Entry> AnswerDataCodec::entries(const QVariant &stored)
+{
+    QList<Entry> result;
+
+    QByteArray data = stored.toByteArray();
+    if (stored.userType() == QMetaType::QByteArray && isEncoded(data)) {
+        QCborArray root = QCborValue::fromCbor(data).taggedValue().toArray();
+        if (root.size() >= 3 && root.at(0).toInteger() == FormatVersion
+                && root.at(1).toInteger() != LayoutRaw) {
+            const QCborArray items = root.at(2).toArray();
+            result.reserve(items.size());
+            for (const QCborValue &value : items) {
+                QCborMap entry = value.toMap();
+                Entry e;
+                e.questionId = static_cast<int>(entry.value(KeyQuestionId).toInteger());
+                e.correct = entry.value(KeyCorrect).toBool();
+                e.bankId = static_cast<int>(entry.value(KeyBankId).toInteger(-1));
+                result.append(e);
+            }
+            return result;
+        }
+    }
+
+    // 旧JSON文本或原样保存的结构，按JSON解析
+    QJsonDocument doc = QJsonDocument::fromJson(toJson(stored).toUtf8());
+    if (doc.isObject()) {
+        QJsonObject obj = doc.object();
+        for (auto it = obj.constBegin(); it != obj.constEnd(); ++it) {
+            qint64 questionId = 0;
+            if (!parseQuestionId(it.key(), &questionId)) {
+                continue;
+            }
+            QJsonObject item = it.value().toObject();
+            Entry e;
+            e.questionId = static_cast<int>(questionId);
+            e.correct = item.value("correct").toBool();
+            result.append(e);
+        }
+    } else if (doc.isArray()) {
+        const QJsonArray arr = doc.array();
+        for (const QJsonValue &value : arr) {
+            QJsonObject item = value.toObject();
+            if (!isIntegral(item.value("questionId"))) {
+                continue;
+            }
+            Entry e;
+            e.questionId = item.value("questionId").toInt();
+            e.correct = item.value("isCorrect").toBool();
+            e.bankId = isIntegral(item.value("bankId")) ? item.value("bankId").toInt() : -1;
+            result.append(e);
+        }
+    }
+
+    return result;
+}
+
+QVariantList AnswerDataCodec::answeredIds(const QVariant &stored)
+{
+    QVariantList ids;
+    const QList<Entry> list = entries(stored);
+    for (const Entry &e : list) {
+        ids.append(e.questionId);
+    }
+    return ids;
+}
+
+QVariantList AnswerDataCodec::wrongIds(const QVariant &stored)
+{
+    QVariantList ids;
+    const QList<Entry> list = entries(stored);
+    for (const Entry &e : list) {
+        if (!e.correct) {
+            ids.append(e.questionId);
+        }
+    }
+    return ids;
+}
+
+QVariantMap AnswerDataCodec::correctness(const QVariant &stored)
+{
+    QVariantMap result;
+    const QList<Entry> list = entries(stored);
+    for (const Entry &e : list) {
+        result[QString::number(e.questionId)] = e.correct;
+    }
+    return result;
+}
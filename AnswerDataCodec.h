@@ -0,0 +1,99 @@
+#ifndef ANSWERDATACODEC_H
+#define ANSWERDATACODEC_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <QVariantList>
+#include <QVariantMap>
+#include <QList>
+
+/**
+ * @brief 答题数据编解码器
+ *
+ * 将QML提交的答题JSON（user_bank_progress.user_answers、user_answer_records.answer_data）
+ * 压缩为CBOR二进制存储，并提供不经过JavaScript的类型化访问接口。
+ *
+ * 支持两种已有的JSON形态：
+ *  - 题目ID为键的对象：{"12": {"userAnswer": "A", "correct": true, "correctAnswer": "A"}, ...}
+ *  - 记录数组：[{"questionId": 12, "isCorrect": true, "userAnswer": "A", "bankId": 3, ...}, ...]
+ * 常用字段使用整数键编码，其余字段原样保留，解码后可还原为等价的JSON。
+ * 读取时同时兼容旧的JSON文本。
+ */
+class AnswerDataCodec
+{
+public:
+    /**
+     * @brief 单道题目的作答结果
+     */
+    struct Entry {
+        int questionId = 0;
+        bool correct = false;
+        int bankId = -1;    // -1 表示答题数据中没有题库信息
+    };
+
+    /**
+     * @brief 将答题JSON文本编码为CBOR二进制
+     * @param json QML提交的JSON文本
+     * @return CBOR数据；JSON无法解析时返回空QByteArray
+     */
+    static QByteArray encode(const QString &json);
+
+    /**
+     * @brief 判断数据是否为本编解码器生成的CBOR
+     * @param data 数据库中读取的原始字节
+     * @return 是否为CBOR编码
+     */
+    static bool isEncoded(const QByteArray &data);
+
+    /**
+     * @brief 将数据库中的存储值还原为JSON文本
+     * @param stored 数据库列值（CBOR二进制或旧JSON文本）
+     * @return JSON文本，供QML端兼容使用
+     */
+    static QString toJson(const QVariant &stored);
+
+    /**
+     * @brief 解析存储值中的每道题作答结果
+     * @param stored 数据库列值（CBOR二进制或旧JSON文本）
+     * @return 按存储顺序排列的作答条目
+     */
+    static QList<Entry> entries(const QVariant &stored);
+
+    /**
+     * @brief 已作答的题目ID列表
+     */
+    static QVariantList answeredIds(const QVariant &stored);
+
+    /**
+     * @brief 答错的题目ID列表
+     */
+    static QVariantList wrongIds(const QVariant &stored);
+
+    /**
+     * @brief 每道题的对错情况，键为题目ID字符串，值为是否正确
+     */
+    static QVariantMap correctness(const QVariant &stored);
+
+private:
+    // CBOR中的数据布局
+    enum Layout {
+        LayoutObject = 0,   // 题目ID为键的对象
+        LayoutArray = 1,    // 记录数组
+        LayoutRaw = 2       // 无法识别的结构，整体保存
+    };
+
+    // 条目中使用整数表示的字段键
+    enum EntryKey {
+        KeyQuestionId = 0,
+        KeyCorrect = 1,
+        KeyUserAnswer = 2,
+        KeyCorrectAnswer = 3,
+        KeyBankId = 4,
+        KeyExtra = 5
+    };
+
+    static const int FormatVersion = 1;
+};
+
+#endif // ANSWERDATACODEC_H
@@ -0,0 +1,278 @@
+#include "AvatarImageProvider.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QThread>
+#include <QTimer>
+
+namespace {
+
+// 缩略图最大边长，覆盖排行榜和用户列表中最大的头像显示尺寸
+const int kThumbnailSize = 256;
+
+// 解码缓存上限（KB）
+const int kCacheCostKB = 16 * 1024;
+
+int imageCostKB(const QImage &image)
+{
+    return qMax(1, static_cast<int>(image.sizeInBytes() / 1024));
+}
+
+// 每个缩略图文件一把锁，同一缩略图的检查、读取和生成串行执行
+QMutex s_thumbnailLocksMutex;
+QHash<QString, QSharedPointer<QMutex>> s_thumbnailLocks;
+
+QSharedPointer<QMutex> thumbnailLock(const QString &thumbnailPath)
+{
+    QMutexLocker locker(&s_thumbnailLocksMutex);
+    QSharedPointer<QMutex> &lock = s_thumbnailLocks[thumbnailPath];
+    if (!lock) {
+        lock.reset(new QMutex);
+    }
+    return lock;
+}
+
+/**
+ * @brief 单次图像请求，在线程池中读取缩略图（不存在或过期时从原图生成）
+ */
+class AvatarImageResponse : public QQuickImageResponse, public QRunnable
+{
+public:
+    AvatarImageResponse(const QString &cacheKey, const QString &sourcePath, const QString &thumbnailPath,
+                        const QSize &requestedSize, const QSharedPointer<AvatarImageProvider::ImageCache> &cache)
+        : m_cacheKey(cacheKey)
+        , m_sourcePath(sourcePath)
+        , m_thumbnailPath(thumbnailPath)
+        , m_requestedSize(requestedSize)
+        , m_cache(cache)
+    {
+        // 响应对象由QML引擎释放
+        setAutoDelete(false);
+    }
+
+    // 缓存命中或无法加载时直接完成
+    explicit AvatarImageResponse(const QImage &image, const QString &errorString = QString())
+        : m_image(image)
+        , m_errorString(errorString)
+    {
+        setAutoDelete(false);
+        QTimer::singleShot(0, this, [this]() { emit finished(); });
+    }
+
+    QQuickTextureFactory *textureFactory() const override
+    {
+        return QQuickTextureFactory::textureFactoryForImage(m_image);
+    }
+
+    QString errorString() const override
+    {
+        return m_errorString;
+    }
+
+    void run() override
+    {
+        // 等待同一缩略图的生成完成后再判断是否需要重新生成
+        QSharedPointer<QMutex> lock = thumbnailLock(m_thumbnailPath);
+        QMutexLocker thumbnailLocker(lock.data());
+        
+        QFileInfo sourceInfo(m_sourcePath);
+        QFileInfo thumbnailInfo(m_thumbnailPath);
+
+        if (thumbnailInfo.exists() && thumbnailInfo.lastModified() >= sourceInfo.lastModified()) {
+            QImageReader reader(m_thumbnailPath);
+            m_image = reader.read();
+        }
+
+        if (m_image.isNull()) {
+            m_image = AvatarImageProvider::createThumbnail(m_sourcePath, m_thumbnailPath);
+        }
+        thumbnailLocker.unlock();
+
+        if (m_image.isNull()) {
+            m_errorString = QString("无法加载图像: %1").arg(m_sourcePath);
+            emit finished();
+            return;
+        }
+
+        if (m_requestedSize.isValid()
+                && (m_requestedSize.width() < m_image.width() || m_requestedSize.height() < m_image.height())) {
+            m_image = m_image.scaled(m_requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+
+        {
+            QMutexLocker locker(&m_cache->mutex);
+            m_cache->images.insert(m_cacheKey, new QImage(m_image), imageCostKB(m_image));
+        }
+
+        emit finished();
+    }
+
+private:
+    QString m_cacheKey;
+    QString m_sourcePath;
+    QString m_thumbnailPath;
+    QSize m_requestedSize;
+    QSharedPointer<AvatarImageProvider::ImageCache> m_cache;
+    QImage m_image;
+    QString m_errorString;
+};
+
+} // namespace
+
+AvatarImageProvider::AvatarImageProvider()
+    : m_cache(new ImageCache)
+{
+    m_cache->images.setMaxCost(kCacheCostKB);
+
+    // 解码线程数量有限，避免与人脸识别争抢CPU
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 2));
+
+    m_thumbnailDir = QCoreApplication::applicationDirPath() + "/thumbnails";
+    QDir().mkpath(m_thumbnailDir);
+}
+
+AvatarImageProvider::~AvatarImageProvider()
+{
+    m_pool.waitForDone();
+}
+
+QQuickImageResponse *AvatarImageProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    // 去掉用于刷新QML缓存的版本参数，例如 "<工号>?v=2"（见DatabaseManager::getUserImageVersion）
+    QString imageId = id.section('?', 0, 0);
+    bool face = imageId.startsWith("face/");
+    QString workId = face ? imageId.mid(5) : imageId;
+
+    QString cacheKey = QString("%1|%2x%3").arg(imageId).arg(requestedSize.width()).arg(requestedSize.height());
+    {
+        QMutexLocker locker(&m_cache->mutex);
+        if (QImage *cached = m_cache->images.object(cacheKey)) {
+            return new AvatarImageResponse(*cached);
+        }
+    }
+
+    QString sourcePath;
+    {
+        QMutexLocker locker(&m_pathsMutex);
+        auto it = m_userImages.constFind(workId);
+        if (it != m_userImages.constEnd()) {
+            sourcePath = face ? it.value().faceImagePath : it.value().avatarPath;
+        }
+    }
+
+    if (sourcePath.isEmpty()) {
+        return new AvatarImageResponse(QImage(), QString("未找到用户图像: %1").arg(imageId));
+    }
+
+    AvatarImageResponse *response = new AvatarImageResponse(cacheKey, sourcePath, thumbnailPath(workId, face),
+                                                             requestedSize, m_cache);
+    m_pool.start(response);
+    return response;
+}
+
+void AvatarImageProvider::setUserImagePaths(const QVariantMap &imagePaths)
+{
+    QMutexLocker locker(&m_pathsMutex);
+    for (auto it = imagePaths.constBegin(); it != imagePaths.constEnd(); ++it) {
+        QVariantMap paths = it.value().toMap();
+        UserImages images;
+        images.avatarPath = paths.value("avatarPath").toString();
+        images.faceImagePath = paths.value("faceImagePath").toString();
+        m_userImages.insert(it.key(), images);
+    }
+    qDebug() << "头像提供器已登记" << m_userImages.size() << "个用户的图像";
+}
+
+QImage AvatarImageProvider::createThumbnail(const QString &sourcePath, const QString &thumbnailPath)
+{
+    QImageReader reader(sourcePath);
+    reader.setAutoTransform(true);
+
+    // 解码时直接缩小，不在内存中生成全尺寸图像
+    QSize size = reader.size();
+    if (size.isValid() && (size.width() > kThumbnailSize || size.height() > kThumbnailSize)) {
+        reader.setScaledSize(size.scaled(kThumbnailSize, kThumbnailSize, Qt::KeepAspectRatio));
+    }
+
+    QImage image = reader.read();
+    if (image.isNull()) {
+        qDebug() << "读取图像失败:" << sourcePath << reader.errorString();
+        return image;
+    }
+
+    // 先写临时文件再替换，读取方不会读到写了一半的缩略图
+    QSaveFile file(thumbnailPath);
+    if (!file.open(QIODevice::WriteOnly) || !image.save(&file, "JPG", 90) || !file.commit()) {
+        qDebug() << "保存缩略图失败:" << thumbnailPath;
+    }
+    return image;
+}
+
+void AvatarImageProvider::updateUserImages(const QString &workId, const QString &avatarPath, const QString &faceImagePath)
+{
+    {
+        QMutexLocker locker(&m_pathsMutex);
+        UserImages images;
+        images.avatarPath = avatarPath;
+        images.faceImagePath = faceImagePath;
+        m_userImages.insert(workId, images);
+    }
+    dropCachedImages(workId);
+
+    // 录入时在后台生成缩略图，首次显示时无需解码原图
+    QString avatarThumbnail = thumbnailPath(workId, false);
+    QString faceThumbnail = thumbnailPath(workId, true);
+    m_pool.start([avatarPath, faceImagePath, avatarThumbnail, faceThumbnail]() {
+        if (!avatarPath.isEmpty()) {
+            QSharedPointer<QMutex> lock = thumbnailLock(avatarThumbnail);
+            QMutexLocker locker(lock.data());
+            createThumbnail(avatarPath, avatarThumbnail);
+        }
+        if (!faceImagePath.isEmpty()) {
+            QSharedPointer<QMutex> lock = thumbnailLock(faceThumbnail);
+            QMutexLocker locker(lock.data());
+            createThumbnail(faceImagePath, faceThumbnail);
+        }
+    });
+}
+
+void AvatarImageProvider::removeUserImages(const QString &workId)
+{
+    {
+        QMutexLocker locker(&m_pathsMutex);
+        m_userImages.remove(workId);
+    }
+    dropCachedImages(workId);
+
+    for (const QString &path : {thumbnailPath(workId, false), thumbnailPath(workId, true)}) {
+        QSharedPointer<QMutex> lock = thumbnailLock(path);
+        QMutexLocker locker(lock.data());
+        QFile::remove(path);
+    }
+}
+
+QString AvatarImageProvider::thumbnailPath(const QString &workId, bool face) const
+{
+    return QString("%1/%2_%3.jpg").arg(m_thumbnailDir, workId, QString(face ? "face" : "avatar"));
+}
+
+void AvatarImageProvider::dropCachedImages(const QString &workId)
+{
+    QString avatarPrefix = workId + "|";
+    QString facePrefix = "face/" + workId + "|";
+
+    QMutexLocker locker(&m_cache->mutex);
+    const QList<QString> keys = m_cache->images.keys();
+    for (const QString &key : keys) {
+        if (key.startsWith(avatarPrefix) || key.startsWith(facePrefix)) {
+            m_cache->images.remove(key);
+        }
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef AVATARIMAGEPROVIDER_H
+#define AVATARIMAGEPROVIDER_H
+
+#include <QQuickImageProvider>
+#include <QThreadPool>
+#include <QSharedPointer>
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QImage>
+#include <QString>
+#include <QSize>
+#include <QVariantMap>
+
+/**
+ * @brief 头像和人脸缩略图的异步图像提供器
+ *
+ * QML中通过 "image://avatars/<工号>?v=<版本>" 获取头像，"image://avatars/face/<工号>?v=<版本>" 获取人脸图像，
+ * 版本由dbManager.getUserImageVersion(工号)给出，图像更新后URL随之变化，QML不再使用缓存中的旧图。
+ * 录入人脸时在后台生成缩略图，加载时只解码缩略图，解码在独立线程池中完成，
+ * 解码结果按LRU缓存，排行榜和用户列表反复刷新时无需重新解码原图。
+ */
+class AvatarImageProvider : public QQuickAsyncImageProvider
+{
+    Q_OBJECT
+
+public:
+    AvatarImageProvider();
+    ~AvatarImageProvider();
+
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+
+    /**
+     * @brief 批量登记用户的原图路径（启动时调用），缩略图在首次请求时按需生成
+     * @param imagePaths 工号 -> {avatarPath, faceImagePath}
+     */
+    void setUserImagePaths(const QVariantMap &imagePaths);
+
+    /**
+     * @brief 从原图生成缩略图（先写临时文件再替换）
+     *
+     * 同一缩略图的生成由调用方串行执行。
+     * @param sourcePath 原图路径
+     * @param thumbnailPath 缩略图保存路径
+     * @return 缩略图，失败时返回空QImage
+     */
+    static QImage createThumbnail(const QString &sourcePath, const QString &thumbnailPath);
+
+public slots:
+    // 用户录入或更新图像后调用：更新原图路径、清除缓存并在后台重新生成缩略图
+    void updateUserImages(const QString &workId, const QString &avatarPath, const QString &faceImagePath);
+
+    // 用户被删除后调用：清除原图路径和缓存
+    void removeUserImages(const QString &workId);
+
+public:
+    // 解码结果缓存，与进行中的请求共享，避免提供器先于请求析构
+    struct ImageCache {
+        QMutex mutex;
+        QCache<QString, QImage> images;
+    };
+
+private:
+    struct UserImages {
+        QString avatarPath;
+        QString faceImagePath;
+    };
+
+    // 缩略图保存路径
+    QString thumbnailPath(const QString &workId, bool face) const;
+
+    // 清除某个用户的所有缓存项
+    void dropCachedImages(const QString &workId);
+
+    QThreadPool m_pool;
+    QSharedPointer<ImageCache> m_cache;
+
+    QMutex m_pathsMutex;
+    QHash<QString, UserImages> m_userImages;
+
+    QString m_thumbnailDir;
+};
+
+#endif // AVATARIMAGEPROVIDER_H
@@ -1,4 +1,5 @@
 #include "DatabaseManager.h"
+#include "PerfTrace.h"
 #include <QDir>
 #include <QStandardPaths>
 #include <QSqlDatabase>
@@ -8,13 +9,94 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include "FaceRecognizer.h"
+#include "InferenceExecutor.h"
+#include "AnswerDataCodec.h"
 #include <QFile>
 #include <QVariantMap>
 #include <QUrl>
+#include <QHash>
+#include <QSet>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <algorithm>
+#include <QFileInfo>
 
 // Forward declaration of helper functions
 QString getFieldValue(const QVariantMap &map, const QStringList &possibleKeys);
 
+// 将数据库中保存的图像路径转换为本地绝对路径（以/开头的路径相对于应用程序目录）
+static QString toLocalImagePath(const QString &path)
+{
+    if (path.isEmpty()) {
+        return path;
+    }
+    if (path.startsWith("file:///")) {
+        return QUrl(path).toLocalFile();
+    }
+    if (QDir::isAbsolutePath(path) && !path.startsWith("/")) {
+        return path;
+    }
+    QString appDir = QCoreApplication::applicationDirPath();
+    return path.startsWith("/") ? appDir + path : appDir + "/" + path;
+}
+
+// 1:N识别时由特征库召回、再用全精度特征重新排序的候选数量
+static const int kFaceRerankCandidates = 32;
+
+// face_index_type为auto时，注册人数达到该值后使用HNSW索引
+static const int kFaceIndexMinCount = 2000;
+
+// HNSW索引中已删除节点超过该比例时，保存前重建索引
+static const double kFaceIndexMaxDeletedRatio = 0.25;
+
+// 两次识别尝试间隔超过该时长时视为新的一次登录
+static const qint64 kLoginAttemptGapMs = 30000;
+
+// 跟踪人脸的检测置信度相对确认身份时变化超过该值时，不再复用身份
+static const float kIdentityScoreDrift = 0.15f;
+
+// 重排序模板缓存最多保存的人数
+static const int kTemplateCacheSize = 1024;
+
+// 访问日志写入失败后重试的间隔
+static const int kAccessLogRetryMs = 5000;
+
+// 数据库不可写时队列中最多保留的访问日志条数
+static const int kMaxPendingAccessLogs = 10000;
+
+// 未检测到人脸时的多人识别结果
+static QVariantMap emptyGroupResult()
+{
+    QVariantMap result;
+    result["faceCount"] = 0;
+    result["recognizedCount"] = 0;
+    result["faces"] = QVariantList();
+    return result;
+}
+
+// 把检测到的人脸转换为多人识别的结果项，特征按相同顺序写入probes
+static QVariantList groupFaceItems(const QList<FaceRecognizer::FaceFeature> &detected, QList<QVector<float>> &probes)
+{
+    QVariantList faces;
+    for (const FaceRecognizer::FaceFeature &face : detected) {
+        QVariantMap item;
+        item["x"] = face.box.x();
+        item["y"] = face.box.y();
+        item["width"] = face.box.width();
+        item["height"] = face.box.height();
+        item["score"] = face.score;
+        item["acceptable"] = face.quality["acceptable"];
+        item["qualityReason"] = face.quality["reason"];
+        item["qualityMessage"] = face.quality["message"];
+        item["recognized"] = false;
+        faces.append(item);
+        probes.append(face.feature);
+    }
+    return faces;
+}
+
 DatabaseManager::DatabaseManager(QObject *parent) : QObject(parent)
 {
     // 设置数据库文件路径到工程目录下
@@ -28,6 +110,8 @@ DatabaseManager::DatabaseManager(QObject *parent) : QObject(parent)
     
     m_dbPath = applicationDir + "/database/sparkexam.db";
     qDebug() << "Database path:" << m_dbPath;
+    
+    m_templateCache.setMaxCost(kTemplateCacheSize);
 
     // 初始化数据库
     initDatabase();
@@ -35,6 +119,11 @@ DatabaseManager::DatabaseManager(QObject *parent) : QObject(parent)
 
 DatabaseManager::~DatabaseManager()
 {
+    saveFaceIndex();
+    
+    // 退出前写入队列中剩余的访问日志
+    flushAccessLogs();
+    
     if (m_database.isOpen()) {
         m_database.close();
     }
@@ -42,6 +131,7 @@ DatabaseManager::~DatabaseManager()
 
 bool DatabaseManager::initDatabase()
 {
+    PERF_TRACE_METHOD();
     // 打开数据库连接
     if (QSqlDatabase::contains(QSqlDatabase::defaultConnection)) {
         m_database = QSqlDatabase::database(QSqlDatabase::defaultConnection);
@@ -115,9 +205,30 @@ bool DatabaseManager::initDatabase()
         // 继续执行，不因此中断程序
     }
     
+    // 创建热点查询使用的索引（需在架构更新之后，确保created_at等列已存在）
+    if (!createIndexes()) {
+        qDebug() << "创建数据库索引失败";
+        // 继续执行，缺少索引只影响查询性能
+    }
+    
     // 初始化默认设置
     initDefaultSettings();
     
+    // 旧版本保存的JSON答题数据转换为CBOR编码（需在默认设置之后，否则设置表非空会跳过默认值初始化）
+    if (!migrateAnswerDataEncoding()) {
+        qDebug() << "转换答题数据编码失败";
+        // 继续执行，读取时兼容JSON文本
+    }
+    
+    // 首次升级时根据已有答题记录生成错题汇总，之后由saveUserAnswerRecord增量维护
+    if (getSetting("record_wrong_questions_built") != "true") {
+        if (rebuildRecordWrongQuestions()) {
+            setSetting("record_wrong_questions_built", "true");
+        } else {
+            qDebug() << "生成答题记录错题汇总失败";
+        }
+    }
+    
     qDebug() << "数据库初始化完成";
     return true;
 }
@@ -152,6 +263,7 @@ bool DatabaseManager::createTables()
         "work_id TEXT NOT NULL, "
         "access_time TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
         "access_result BOOLEAN NOT NULL, "
+        "attempts INTEGER, "
         "FOREIGN KEY (work_id) REFERENCES users(work_id)"
         ")"
     );
@@ -305,6 +417,46 @@ bool DatabaseManager::createTables()
         return false;
     }
 
+    // 创建答题记录错题汇总表（由答题记录派生，保存答题记录时增量维护）
+    success = query.exec(
+        "CREATE TABLE IF NOT EXISTS user_record_wrong_questions ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "work_id TEXT NOT NULL, "
+        "bank_id INTEGER NOT NULL, "
+        "question_id INTEGER NOT NULL, "
+        "wrong_count INTEGER DEFAULT 1, "
+        "last_wrong_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+        "UNIQUE(work_id, bank_id, question_id), "
+        "FOREIGN KEY (work_id) REFERENCES users(work_id), "
+        "FOREIGN KEY (bank_id) REFERENCES question_banks(id) ON DELETE CASCADE, "
+        "FOREIGN KEY (question_id) REFERENCES questions(id) ON DELETE CASCADE"
+        ")"
+    );
+
+    if (!success) {
+        qDebug() << "Failed to create user_record_wrong_questions table:" << query.lastError().text();
+        return false;
+    }
+
+    // 创建人脸特征表（每人可有多个模板，全精度float32特征，识别时只加载量化后的特征到内存；
+    // 不同识别后端的特征不能互相比较，按backend分别保存）
+    success = query.exec(
+        "CREATE TABLE IF NOT EXISTS face_features ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "work_id TEXT NOT NULL, "
+        "feature BLOB NOT NULL, "
+        "source TEXT DEFAULT 'enrol', "
+        "backend TEXT DEFAULT 'seeta', "
+        "created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+        "FOREIGN KEY (work_id) REFERENCES users(work_id)"
+        ")"
+    );
+
+    if (!success) {
+        qDebug() << "Failed to create face_features table:" << query.lastError().text();
+        return false;
+    }
+
     // 创建账户信息表
     success = query.exec(
         "CREATE TABLE IF NOT EXISTS accounts ("
@@ -330,6 +482,7 @@ bool DatabaseManager::addFaceData(const QString &name, const QString &gender,
                                  const QString &workId, const QString &faceImagePath, 
                                  const QString &avatarPath, bool isAdmin)
 {
+    PERF_TRACE_METHOD();
     QSqlQuery query;
     
     // 将绝对路径转换为相对路径
@@ -371,11 +524,15 @@ bool DatabaseManager::addFaceData(const QString &name, const QString &gender,
         return false;
     }
     
+    refreshFaceFeature(workId, toLocalImagePath(relativeFaceImagePath));
+    ++m_userImageVersions[workId];
+    emit userImagesChanged(workId, toLocalImagePath(relativeAvatarPath), toLocalImagePath(relativeFaceImagePath));
     return true;
 }
 
 bool DatabaseManager::deleteFaceData(const QString &workId)
 {
+    PERF_TRACE_METHOD();
     QSqlQuery query;
     query.prepare("DELETE FROM users WHERE work_id = :work_id");
     query.bindValue(":work_id", workId);
@@ -385,11 +542,16 @@ bool DatabaseManager::deleteFaceData(const QString &workId)
         return false;
     }
     
+    removeFaceTemplates(workId);
+    
+    ++m_userImageVersions[workId];
+    emit userImagesRemoved(workId);
     return true;
 }
 
 QVariantList DatabaseManager::getAllFaceData()
 {
+    PERF_TRACE_METHOD();
     QVariantList result;
     QSqlQuery query("SELECT * FROM users ORDER BY name");
     QString appDir = QCoreApplication::applicationDirPath();
@@ -439,11 +601,13 @@ QVariantList DatabaseManager::getAllFaceData()
         result.append(row);
     }
     
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
 QVariantList DatabaseManager::getAllFaceDataSorted()
 {
+    PERF_TRACE_METHOD();
     QVariantList result;
     QString appDir = QCoreApplication::applicationDirPath();
     
@@ -593,11 +757,13 @@ QVariantList DatabaseManager::getAllFaceDataSorted()
                  << " - 排序值: " << pair.second;
     }
     
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
 QVariantMap DatabaseManager::getFaceDataByWorkId(const QString &workId)
 {
+    PERF_TRACE_METHOD();
     QVariantMap result;
     QSqlQuery query;
     query.prepare("SELECT * FROM users WHERE work_id = :work_id");
@@ -656,8 +822,35 @@ QVariantMap DatabaseManager::getFaceDataByWorkId(const QString &workId)
     return result;
 }
 
+int DatabaseManager::getUserImageVersion(const QString &workId) const
+{
+    return m_userImageVersions.value(workId, 0);
+}
+
+QVariantMap DatabaseManager::getUserImagePaths()
+{
+    PERF_TRACE_METHOD();
+    QVariantMap result;
+    QSqlQuery query;
+    
+    if (!query.exec("SELECT work_id, avatar_path, face_image_path FROM users")) {
+        qDebug() << "Failed to get user image paths:" << query.lastError().text();
+        return result;
+    }
+    
+    while (query.next()) {
+        QVariantMap paths;
+        paths["avatarPath"] = toLocalImagePath(query.value(1).toString());
+        paths["faceImagePath"] = toLocalImagePath(query.value(2).toString());
+        result[query.value(0).toString()] = paths;
+    }
+    
+    return result;
+}
+
 bool DatabaseManager::verifyFace(const QString &workId, const QString &faceImagePath)
 {
+    PERF_TRACE_METHOD();
     qDebug() << "Verifying face for work ID:" << workId << "using image:" << faceImagePath;
     
     // 检查图像文件是否存在
@@ -667,21 +860,12 @@ bool DatabaseManager::verifyFace(const QString &workId, const QString &faceImage
         return false;
     }
     
-    // 记录验证结果
-    QSqlQuery logQuery;
-    logQuery.prepare(
-        "INSERT INTO access_logs (work_id, access_result) "
-        "VALUES (:work_id, :access_result)"
-    );
-    
     // 检查用户是否存在，getFaceDataByWorkId已经处理了路径转换
     QVariantMap userData = getFaceDataByWorkId(workId);
     if (userData.isEmpty()) {
         qDebug() << "User with work ID" << workId << "not found in database";
         // 用户不存在，记录失败
-        logQuery.bindValue(":work_id", workId);
-        logQuery.bindValue(":access_result", 0);
-        logQuery.exec();
+        logAccess(workId, false);
         return false;
     }
     
@@ -700,189 +884,1082 @@ bool DatabaseManager::verifyFace(const QString &workId, const QString &faceImage
     QFileInfo registeredImageFile(registeredFaceImage);
     if (!registeredImageFile.exists() || !registeredImageFile.isFile()) {
         qDebug() << "Registered face image file does not exist or is not a file:" << registeredFaceImage;
-        logQuery.bindValue(":work_id", workId);
-        logQuery.bindValue(":access_result", 0);
-        logQuery.exec();
+        logAccess(workId, false);
+        return false;
+    }
+    
+    // 初始化人脸识别器
+    if (!faceRecognizer()->initialize()) {
+        qDebug() << "Failed to initialize face recognizer.";
+        logAccess(workId, false);
+        return false;
+    }
+    
+    // 比较两张人脸图像
+    float similarity = faceRecognizer()->compareFaces(registeredFaceImage, faceImagePath);
+    
+    // 获取相似度阈值
+    float threshold = getSetting("face_recognition_threshold", "0.6").toFloat();
+    
+    // 判断是否通过验证
+    bool result = similarity >= threshold;
+    
+    // 记录验证结果
+    logAccess(workId, result);
+    
+    qDebug() << "Face verification result:" << result << "Similarity:" << similarity << "Threshold:" << threshold;
+    
+    return result;
+}
+
+void DatabaseManager::setFaceRecognizer(FaceRecognizer *recognizer)
+{
+    if (m_faceRecognizer == recognizer) {
+        return;
+    }
+    if (m_faceRecognizer && m_faceRecognizer->parent() == this) {
+        m_faceRecognizer->deleteLater();
+    }
+    m_faceRecognizer = recognizer;
+    m_trackedIdentity = TrackedIdentity();
+}
+
+FaceRecognizer *DatabaseManager::faceRecognizer()
+{
+    if (!m_faceRecognizer) {
+        m_faceRecognizer = new FaceRecognizer(this);
+    }
+    return m_faceRecognizer;
+}
+
+void DatabaseManager::logAccess(const QString &workId, bool granted, const QVariant &attempts)
+{
+    // 首次记录时读取批量写入的设置
+    if (!m_accessLogTimer) {
+        m_accessLogFlushRows = qMax(1, getSetting("access_log_flush_rows", "32").toInt());
+        m_accessLogTimer = new QTimer(this);
+        m_accessLogTimer->setSingleShot(true);
+        m_accessLogFlushMs = qMax(0, getSetting("access_log_flush_ms", "1000").toInt());
+        connect(m_accessLogTimer, &QTimer::timeout, this, &DatabaseManager::flushAccessLogs);
+    }
+    
+    // 写入时间取记录时刻，格式与CURRENT_TIMESTAMP一致（UTC）
+    PendingAccessLog log;
+    log.workId = workId;
+    log.granted = granted;
+    log.attempts = attempts;
+    log.accessTime = QDateTime::currentDateTimeUtc().toString("yyyy-MM-dd HH:mm:ss");
+    m_pendingAccessLogs.append(log);
+    
+    if (m_pendingAccessLogs.size() >= m_accessLogFlushRows) {
+        flushAccessLogs();
+    } else if (!m_accessLogTimer->isActive()) {
+        m_accessLogTimer->start(m_accessLogFlushMs);
+    }
+}
+
+void DatabaseManager::flushAccessLogs()
+{
+    PERF_TRACE_METHOD();
+    if (m_accessLogTimer) {
+        m_accessLogTimer->stop();
+    }
+    if (m_pendingAccessLogs.isEmpty()) {
+        return;
+    }
+    if (!m_database.isOpen()) {
+        retryAccessLogs(QList<PendingAccessLog>());
+        return;
+    }
+    
+    QList<PendingAccessLog> logs;
+    logs.swap(m_pendingAccessLogs);
+    
+    // 一个事务写入全部日志，只同步一次磁盘；已在其他事务中时直接写入该事务
+    bool ownTransaction = m_database.transaction();
+    
+    QSqlQuery query(m_database);
+    query.prepare(
+        "INSERT INTO access_logs (work_id, access_time, access_result, attempts) "
+        "VALUES (:work_id, :access_time, :access_result, :attempts)"
+    );
+    for (int i = 0; i < logs.size(); ++i) {
+        const PendingAccessLog &log = logs.at(i);
+        query.bindValue(":work_id", log.workId);
+        query.bindValue(":access_time", log.accessTime);
+        query.bindValue(":access_result", log.granted ? 1 : 0);
+        query.bindValue(":attempts", log.attempts);
+        if (!query.exec()) {
+            qDebug() << "写入访问日志失败:" << query.lastError().text();
+            if (ownTransaction) {
+                m_database.rollback();
+                retryAccessLogs(logs);
+            } else {
+                // 已写入外层事务的日志随外层事务提交，只重试剩余的
+                retryAccessLogs(logs.mid(i));
+            }
+            return;
+        }
+    }
+    
+    if (ownTransaction && !m_database.commit()) {
+        qDebug() << "提交访问日志失败:" << m_database.lastError().text();
+        m_database.rollback();
+        retryAccessLogs(logs);
+        return;
+    }
+    PERF_TRACE_ROWS(logs.size());
+}
+
+void DatabaseManager::retryAccessLogs(const QList<PendingAccessLog> &logs)
+{
+    // 放回队列前部，保持记录顺序
+    m_pendingAccessLogs = logs + m_pendingAccessLogs;
+    
+    // 数据库长时间不可写时丢弃最早的日志，队列不无限增长
+    if (m_pendingAccessLogs.size() > kMaxPendingAccessLogs) {
+        int dropped = m_pendingAccessLogs.size() - kMaxPendingAccessLogs;
+        m_pendingAccessLogs.erase(m_pendingAccessLogs.begin(), m_pendingAccessLogs.begin() + dropped);
+        qDebug() << "访问日志队列已满，丢弃最早的日志:" << dropped;
+    }
+    
+    if (m_accessLogTimer && !m_pendingAccessLogs.isEmpty()) {
+        m_accessLogTimer->start(kAccessLogRetryMs);
+    }
+}
+
+QVariantMap DatabaseManager::recognizeFace(const QString &faceImagePath)
+{
+    PERF_TRACE_METHOD();
+    qDebug() << "Recognizing face using image:" << faceImagePath;
+    
+    QVariantMap result;
+    result["recognized"] = false;
+    
+    // 检查图像文件是否存在
+    QFileInfo imageFile(faceImagePath);
+    if (!imageFile.exists() || !imageFile.isFile()) {
+        qDebug() << "Face image file does not exist or is not a file:" << faceImagePath;
+        return result;
+    }
+    
+    // 加载特征库（首次识别时加载模型并为未提取特征的用户补充提取）
+    if (!ensureFaceGallery()) {
+        qDebug() << "Failed to load face gallery.";
+        return result;
+    }
+    
+    // 获取相似度阈值
+    float threshold = getSetting("face_recognition_threshold", "0.6").toFloat();
+    qDebug() << "Face recognition threshold:" << threshold;
+    
+    // 同一张人脸的跟踪未中断时复用上次确认的身份，不再提取特征和比对
+    QString cachedWorkId;
+    float cachedSimilarity = 0.0f;
+    if (reuseTrackedIdentity(cachedWorkId, cachedSimilarity)) {
+        countRecognitionAttempt();
+        result = confirmRecognition(cachedWorkId, cachedSimilarity, QVector<float>());
+        result["cached"] = true;
+        if (!result["recognized"].toBool()) {
+            m_trackedIdentity = TrackedIdentity();
+        }
+        return result;
+    }
+    
+    // 先评估人脸质量，过小、模糊或侧脸的帧不提取特征，由界面提示后重新采集
+    QVariantMap quality;
+    QVector<float> probe = faceRecognizer()->extractFeatureVector(faceImagePath, &quality);
+    result["faceDetected"] = quality["faceDetected"];
+    if (!quality["faceDetected"].toBool()) {
+        qDebug() << "No face detected in the recognition image";
+        return result;
+    }
+    
+    // 检测到人脸的每一帧都算一次尝试，间隔过长时重新计数
+    countRecognitionAttempt();
+    
+    if (!quality["acceptable"].toBool()) {
+        qDebug() << "Face quality too low, skip recognition:" << quality["reason"].toString();
+        result["qualityRejected"] = true;
+        result["qualityReason"] = quality["reason"];
+        result["qualityMessage"] = quality["message"];
+        return result;
+    }
+    if (probe.isEmpty()) {
+        qDebug() << "Failed to extract feature from the recognition image";
+        return result;
+    }
+    
+    // 由特征库（或HNSW索引）召回候选，再用全精度特征重新计算相似度，得分与逐一比对一致
+    QList<FaceGallery::Candidate> candidates = rankFaceCandidates(probe, kFaceRerankCandidates);
+    if (candidates.isEmpty()) {
+        qDebug() << "No face features found in gallery";
+        return result;
+    }
+    
+    float highestSimilarity = candidates.first().score;
+    QString bestWorkId = candidates.first().workId;
+    
+    // 判断是否找到匹配的用户
+    if (highestSimilarity >= threshold && !bestWorkId.isEmpty()) {
+        result = confirmRecognition(bestWorkId, highestSimilarity, probe);
+        
+        // 记住本次确认的身份和当前跟踪轨迹，轨迹不中断时后续帧直接复用
+        float trackScore = 0.0f;
+        m_trackedIdentity.trackId = faceRecognizer()->trackId(&trackScore);
+        m_trackedIdentity.trackScore = trackScore;
+        m_trackedIdentity.workId = bestWorkId;
+        m_trackedIdentity.similarity = highestSimilarity;
+        m_trackedIdentity.confirmed.restart();
+    } else {
+        qDebug() << "No matching face found. Highest similarity:" << highestSimilarity;
+    }
+    
+    return result;
+}
+
+QVariantMap DatabaseManager::confirmRecognition(const QString &workId, float similarity, const QVector<float> &probe)
+{
+    QVariantMap result;
+    result["faceDetected"] = true;
+    result["recognized"] = false;
+    
+    QVariantMap bestMatch = getFaceDataByWorkId(workId);
+    if (bestMatch.isEmpty()) {
+        qDebug() << "Recognized user no longer exists:" << workId;
+        return result;
+    }
+    qDebug() << "Face recognized as user:" << bestMatch["name"].toString() 
+             << "with similarity:" << similarity << "attempts:" << m_recognitionAttempts;
+    
+    // 记录访问日志
+    logAccess(workId, true, m_recognitionAttempts);
+    
+    // 返回识别结果
+    result["recognized"] = true;
+    result["name"] = bestMatch["name"];
+    result["workId"] = workId;
+    result["similarity"] = similarity;
+    result["attempts"] = m_recognitionAttempts;
+    m_recognitionAttempts = 0;
+    
+    if (!probe.isEmpty()) {
+        updateLoginTemplates(workId, probe, similarity);
+    }
+    return result;
+}
+
+QVariantMap DatabaseManager::recognizeAllFaces(const QString &frameImagePath)
+{
+    PERF_TRACE_METHOD();
+    QVariantMap result = emptyGroupResult();
+    if (!prepareGroupRecognition(frameImagePath)) {
+        return result;
+    }
+    
+    // 一次检测，各人脸在推理线程上依次提取特征，调用线程等待完成
+    QSize imageSize;
+    QList<QVector<float>> probes;
+    QVariantList faces = groupFaceItems(faceRecognizer()->extractAllFeatureVectors(frameImagePath, &imageSize), probes);
+    result = matchGroupFaces(faces, probes);
+    result["imageWidth"] = imageSize.width();
+    result["imageHeight"] = imageSize.height();
+    PERF_TRACE_ROWS(faces.size());
+    return result;
+}
+
+bool DatabaseManager::recognizeAllFacesAsync(const QString &frameImagePath)
+{
+    PERF_TRACE_METHOD();
+    if (!prepareGroupRecognition(frameImagePath)) {
+        return false;
+    }
+    
+    // 特征提取在推理线程上进行，召回、比对和写访问日志回到界面线程
+    QPointer<DatabaseManager> self(this);
+    QPointer<FaceRecognizer> recognizer(faceRecognizer());
+    return InferenceExecutor::getInstance().tryPost([self, recognizer, frameImagePath]() {
+        if (!recognizer) {
+            return;
+        }
+        QSize imageSize;
+        QList<QVector<float>> probes;
+        QVariantList faces = groupFaceItems(recognizer->extractAllFeatureVectors(frameImagePath, &imageSize), probes);
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [self, faces, probes, imageSize]() {
+            if (!self) {
+                return;
+            }
+            QVariantMap result = self->matchGroupFaces(faces, probes);
+            result["imageWidth"] = imageSize.width();
+            result["imageHeight"] = imageSize.height();
+            emit self->allFacesRecognized(result);
+        }, Qt::QueuedConnection);
+    });
+}
+
+bool DatabaseManager::prepareGroupRecognition(const QString &frameImagePath)
+{
+    QFileInfo imageFile(frameImagePath);
+    if (!imageFile.exists() || !imageFile.isFile()) {
+        qDebug() << "Group image file does not exist or is not a file:" << frameImagePath;
+        return false;
+    }
+    
+    // 特征库和模型在界面线程上加载
+    if (!ensureFaceGallery()) {
+        qDebug() << "Failed to load face gallery.";
+        return false;
+    }
+    return true;
+}
+
+QVariantMap DatabaseManager::matchGroupFaces(QVariantList faces, const QList<QVector<float>> &probes)
+{
+    QVariantMap result = emptyGroupResult();
+    result["faceCount"] = faces.size();
+    if (faces.isEmpty()) {
+        qDebug() << "No face detected in the group image";
+        return result;
+    }
+    
+    float threshold = getSetting("face_recognition_threshold", "0.6").toFloat();
+    
+    // 所有人脸一起召回和重排序
+    QList<QList<FaceGallery::Candidate>> ranked = rankFaceCandidates(probes, kFaceRerankCandidates);
+    
+    // 按得分从高到低分配身份，同一个人在一帧中只能对应一张人脸
+    struct Match {
+        int face;
+        QString workId;
+        float score;
+    };
+    QList<Match> matches;
+    for (int i = 0; i < ranked.size(); ++i) {
+        for (const FaceGallery::Candidate &candidate : ranked[i]) {
+            if (candidate.score >= threshold) {
+                matches.append({i, candidate.workId, candidate.score});
+            }
+        }
+    }
+    std::sort(matches.begin(), matches.end(), [](const Match &a, const Match &b) {
+        return a.score > b.score;
+    });
+    QHash<int, Match> assigned;
+    QSet<QString> assignedIds;
+    for (const Match &match : matches) {
+        if (!assigned.contains(match.face) && !assignedIds.contains(match.workId)) {
+            assigned.insert(match.face, match);
+            assignedIds.insert(match.workId);
+        }
+    }
+    
+    int recognizedCount = 0;
+    for (int i = 0; i < faces.size(); ++i) {
+        if (!assigned.contains(i)) {
+            continue;
+        }
+        const Match &match = assigned[i];
+        QVariantMap user = getFaceDataByWorkId(match.workId);
+        if (!user.isEmpty()) {
+            QVariantMap item = faces[i].toMap();
+            item["recognized"] = true;
+            item["workId"] = match.workId;
+            item["name"] = user["name"];
+            item["similarity"] = match.score;
+            faces[i] = item;
+            ++recognizedCount;
+            logAccess(match.workId, true);
+        }
+    }
+    
+    qDebug() << "Group recognition: faces" << faces.size() << "recognized" << recognizedCount;
+    result["faces"] = faces;
+    result["recognizedCount"] = recognizedCount;
+    return result;
+}
+
+void DatabaseManager::countRecognitionAttempt()
+{
+    if (!m_lastRecognitionAttempt.isValid() || m_lastRecognitionAttempt.elapsed() > kLoginAttemptGapMs) {
+        m_recognitionAttempts = 0;
+    }
+    ++m_recognitionAttempts;
+    m_lastRecognitionAttempt.restart();
+}
+
+bool DatabaseManager::reuseTrackedIdentity(QString &workId, float &similarity)
+{
+    if (m_trackedIdentity.workId.isEmpty()) {
+        return false;
+    }
+    
+    // face_identity_cache_ms为0时不复用
+    qint64 timeoutMs = getSetting("face_identity_cache_ms", "5000").toLongLong();
+    float trackScore = 0.0f;
+    int trackId = faceRecognizer()->trackId(&trackScore);
+    
+    QString reason;
+    if (timeoutMs <= 0) {
+        reason = "disabled";
+    } else if (trackId == 0 || trackId != m_trackedIdentity.trackId) {
+        reason = "track changed";
+    } else if (m_trackedIdentity.confirmed.elapsed() > timeoutMs) {
+        reason = "expired";
+    } else if (qAbs(trackScore - m_trackedIdentity.trackScore) > kIdentityScoreDrift) {
+        reason = "score drift";
+    }
+    
+    if (!reason.isEmpty()) {
+        qDebug() << "Tracked identity not reused:" << reason;
+        m_trackedIdentity = TrackedIdentity();
+        return false;
+    }
+    
+    workId = m_trackedIdentity.workId;
+    similarity = m_trackedIdentity.similarity;
+    qDebug() << "Reusing tracked identity:" << workId << "track:" << trackId;
+    return true;
+}
+
+QVariantMap DatabaseManager::findDuplicateFaces(const QString &faceImagePath, const QString &excludeWorkId, int maxResults)
+{
+    PERF_TRACE_METHOD();
+    QVariantMap result;
+    result["faceDetected"] = false;
+    result["duplicate"] = false;
+    result["matches"] = QVariantList();
+    
+    QString imagePath = toLocalImagePath(faceImagePath);
+    QFileInfo imageFile(imagePath);
+    if (!imageFile.exists() || !imageFile.isFile()) {
+        qDebug() << "Face image file does not exist or is not a file:" << imagePath;
+        return result;
+    }
+    
+    if (!ensureFaceGallery()) {
+        qDebug() << "Failed to load face gallery.";
+        return result;
+    }
+    
+    QVector<float> feature = faceRecognizer()->extractFeatureVector(imagePath);
+    if (feature.isEmpty()) {
+        qDebug() << "录入图像中未能提取人脸特征:" << imagePath;
+        return result;
+    }
+    result["faceDetected"] = true;
+    
+    // 保存特征，录入时不再重复提取
+    m_pendingFeaturePath = imageFile.absoluteFilePath();
+    m_pendingFeatureModified = imageFile.lastModified();
+    m_pendingFeature = feature;
+    
+    float threshold = getSetting("face_duplicate_threshold",
+                                 getSetting("face_recognition_threshold", "0.6")).toFloat();
+    result["threshold"] = threshold;
+    
+    QVariantList matches;
+    QList<FaceGallery::Candidate> candidates = rankFaceCandidates(feature, kFaceRerankCandidates);
+    for (const FaceGallery::Candidate &candidate : candidates) {
+        if (matches.size() >= maxResults) {
+            break;
+        }
+        if (candidate.workId == excludeWorkId) {
+            continue;
+        }
+        QVariantMap match;
+        match["workId"] = candidate.workId;
+        match["name"] = getFaceDataByWorkId(candidate.workId)["name"];
+        match["similarity"] = candidate.score;
+        matches.append(match);
+    }
+    result["matches"] = matches;
+    
+    if (!matches.isEmpty() && matches.first().toMap()["similarity"].toFloat() >= threshold) {
+        result["duplicate"] = true;
+        qDebug() << "录入的人脸与已有人员相似:" << matches.first().toMap()["workId"].toString()
+                 << "相似度:" << matches.first().toMap()["similarity"].toFloat() << "阈值:" << threshold;
+    }
+    
+    PERF_TRACE_ROWS(matches.size());
+    return result;
+}
+
+bool DatabaseManager::mergeFaceImage(const QString &workId, const QString &faceImagePath)
+{
+    PERF_TRACE_METHOD();
+    if (!userExists(workId)) {
+        qDebug() << "Failed to merge face image, user not found:" << workId;
         return false;
     }
     
-    // 创建人脸识别器
-    static FaceRecognizer faceRecognizer;
+    QVector<float> feature = takePendingFeature(toLocalImagePath(faceImagePath));
+    if (feature.isEmpty()) {
+        qDebug() << "合并的人脸图像中未能提取特征:" << faceImagePath;
+        return false;
+    }
+    
+    if (addFaceTemplate(workId, feature, "merge") < 0) {
+        return false;
+    }
+    pruneFaceTemplates(workId, getSetting("face_max_templates", "5").toInt());
+    return true;
+}
+
+QVariantMap DatabaseManager::getRecognitionStats(int days)
+{
+    PERF_TRACE_METHOD();
+    flushAccessLogs();
+    QVariantMap result;
+    
+    // 与cleanupOldLogs相同，直接比较时间字符串以使用idx_access_logs_time索引
+    QString cutoffDate = QDateTime::currentDateTime().addDays(-days).toString("yyyy-MM-dd");
+    
+    QSqlQuery query;
+    query.prepare(
+        "SELECT COUNT(*), "
+        "SUM(CASE WHEN attempts <= 1 THEN 1 ELSE 0 END), "
+        "AVG(attempts), "
+        "MAX(attempts) "
+        "FROM access_logs "
+        "WHERE access_time >= :cutoff_date AND access_result = 1 AND attempts IS NOT NULL"
+    );
+    query.bindValue(":cutoff_date", cutoffDate);
+    
+    if (!query.exec() || !query.next()) {
+        qDebug() << "Failed to get recognition stats:" << query.lastError().text();
+        return result;
+    }
+    
+    int logins = query.value(0).toInt();
+    result["days"] = days;
+    result["logins"] = logins;
+    result["firstFrameSuccessRate"] = logins > 0 ? query.value(1).toDouble() / logins : 0.0;
+    result["meanAttempts"] = logins > 0 ? query.value(2).toDouble() : 0.0;
+    result["maxAttempts"] = query.value(3).toInt();
+    
+    QSqlQuery templateQuery;
+    templateQuery.prepare("SELECT COUNT(DISTINCT work_id), COUNT(*) FROM face_features WHERE backend = :backend");
+    templateQuery.bindValue(":backend", faceRecognizer()->backendName());
+    if (templateQuery.exec() && templateQuery.next()) {
+        int identities = templateQuery.value(0).toInt();
+        result["identities"] = identities;
+        result["templates"] = identities > 0 ? templateQuery.value(1).toDouble() / identities : 0.0;
+    }
+    
+    qDebug() << "人脸登录统计（最近" << days << "天）：登录" << logins << "次"
+             << "首帧成功率" << result["firstFrameSuccessRate"].toDouble()
+             << "平均尝试" << result["meanAttempts"].toDouble() << "次"
+             << "平均每人模板" << result["templates"].toDouble() << "个";
+    return result;
+}
+
+QString DatabaseManager::templateLabel(const QString &workId, qint64 templateId)
+{
+    return QString("%1#%2").arg(workId).arg(templateId);
+}
+
+QString DatabaseManager::templateOwner(const QString &label)
+{
+    return label.section('#', 0, -2);
+}
+
+QList<FaceGallery::Candidate> DatabaseManager::rankFaceCandidates(const QVector<float> &feature, int count)
+{
+    return rankFaceCandidates(QList<QVector<float>>() << feature, count).value(0);
+}
+
+QList<QList<FaceGallery::Candidate>> DatabaseManager::rankFaceCandidates(const QList<QVector<float>> &features, int count)
+{
+    QList<QList<FaceGallery::Candidate>> ranked;
+    QList<QList<FaceGallery::Candidate>> candidates = searchFaceCandidates(features, count);
+    
+    // 召回的是模板，按人汇总该人的全部模板；所有查询的候选人一次读取
+    QList<QStringList> candidateIds;
+    QStringList allIds;
+    for (const QList<FaceGallery::Candidate> &list : candidates) {
+        QStringList ids;
+        for (const FaceGallery::Candidate &candidate : list) {
+            QString workId = templateOwner(candidate.workId);
+            if (!ids.contains(workId)) {
+                ids.append(workId);
+            }
+            if (!allIds.contains(workId)) {
+                allIds.append(workId);
+            }
+        }
+        candidateIds.append(ids);
+    }
+    QHash<QString, QList<FaceTemplate>> templates;
+    if (!allIds.isEmpty()) {
+        templates = cachedFaceTemplates(allIds);
+    }
+    bool useMean = getSetting("face_template_scoring", "max") == "mean";
+    
+    for (int i = 0; i < features.size(); ++i) {
+        QList<FaceGallery::Candidate> list;
+        for (const QString &workId : candidateIds.value(i)) {
+            FaceGallery::Candidate candidate;
+            candidate.workId = workId;
+            candidate.score = aggregateTemplateScore(features[i], templates.value(workId), useMean);
+            list.append(candidate);
+        }
+        std::sort(list.begin(), list.end(), [](const FaceGallery::Candidate &a, const FaceGallery::Candidate &b) {
+            return a.score > b.score;
+        });
+        ranked.append(list);
+    }
+    return ranked;
+}
+
+QHash<QString, QList<DatabaseManager::FaceTemplate>> DatabaseManager::cachedFaceTemplates(const QStringList &workIds)
+{
+    QHash<QString, QList<FaceTemplate>> templates;
+    QStringList missing;
+    for (const QString &workId : workIds) {
+        if (QList<FaceTemplate> *cached = m_templateCache.object(workId)) {
+            templates.insert(workId, *cached);
+        } else {
+            missing.append(workId);
+        }
+    }
+    
+    if (!missing.isEmpty()) {
+        QHash<QString, QList<FaceTemplate>> loaded = loadFaceTemplates(missing);
+        for (const QString &workId : missing) {
+            QList<FaceTemplate> list = loaded.value(workId);
+            templates.insert(workId, list);
+            m_templateCache.insert(workId, new QList<FaceTemplate>(list));
+        }
+    }
+    return templates;
+}
+
+float DatabaseManager::aggregateTemplateScore(const QVector<float> &feature, const QList<FaceTemplate> &templates, bool useMean)
+{
+    if (templates.isEmpty()) {
+        return 0.0f;
+    }
+    
+    float best = 0.0f;
+    float sum = 0.0f;
+    for (const FaceTemplate &faceTemplate : templates) {
+        float similarity = faceRecognizer()->calculateSimilarity(feature, faceTemplate.feature);
+        best = qMax(best, similarity);
+        sum += similarity;
+    }
+    return useMean ? sum / templates.size() : best;
+}
+
+bool DatabaseManager::ensureFaceGallery()
+{
+    if (m_faceGalleryLoaded) {
+        return true;
+    }
+    
+    if (!faceRecognizer()->initialize()) {
+        qDebug() << "Failed to initialize face recognizer.";
+        return false;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    
+    QString backendName = faceRecognizer()->backendName();
+    int featureSize = faceRecognizer()->featureSize();
+    m_galleryBackend = backendName;
+    QString stamp = faceFeatureStamp();
+    int featureCount = stamp.section(':', 0, 0).toInt();
+    
+    QString indexType = getSetting("face_index_type", "auto");
+    m_useFaceIndex = indexType == "hnsw" || (indexType == "auto" && featureCount >= kFaceIndexMinCount);
+    m_faceIndexDirty = false;
+    m_faceGallery.clear();
+    m_faceIndex.clear();
+    m_templateCache.clear();
+    
+    // 索引文件与数据库一致时直接加载，否则重新建立
+    bool indexLoaded = false;
+    if (m_useFaceIndex) {
+        indexLoaded = m_faceIndex.load(faceIndexPath(), stamp)
+                && (m_faceIndex.size() == 0 || m_faceIndex.dimension() == featureSize);
+        if (!indexLoaded) {
+            m_faceIndex.clear();
+        }
+    } else {
+        m_faceGallery.setQuantization(FaceGallery::quantizationFromString(getSetting("face_gallery_quantization", "int8")));
+    }
+    
+    if (!indexLoaded) {
+        QSqlQuery loadQuery;
+        loadQuery.prepare("SELECT id, work_id, feature FROM face_features WHERE backend = :backend ORDER BY id");
+        loadQuery.bindValue(":backend", backendName);
+        loadQuery.exec();
+        while (loadQuery.next()) {
+            QVector<float> feature = FaceGallery::fromBlob(loadQuery.value(2).toByteArray());
+            if (feature.size() != featureSize) {
+                qDebug() << "人脸特征维度与模型不一致，跳过:" << loadQuery.value(1).toString() << feature.size();
+                continue;
+            }
+            setGalleryFeature(templateLabel(loadQuery.value(1).toString(), loadQuery.value(0).toLongLong()), feature);
+        }
+        saveFaceIndex();
+    }
     
-    // 初始化人脸识别器
-    if (!faceRecognizer.initialize()) {
-        qDebug() << "Failed to initialize face recognizer.";
-        logQuery.bindValue(":work_id", workId);
-        logQuery.bindValue(":access_result", 0);
-        logQuery.exec();
-        return false;
+    m_faceGalleryLoaded = true;
+    if (m_useFaceIndex) {
+        qDebug() << "人脸HNSW索引" << (indexLoaded ? "从文件加载" : "重新建立") << "完成，后端:" << backendName
+                 << "模板数:" << m_faceIndex.size()
+                 << "内存:" << m_faceIndex.memoryBytes() << "字节"
+                 << "耗时:" << timer.elapsed() << "ms";
+    } else {
+        qDebug() << "人脸特征库加载完成，后端:" << backendName << "模板数:" << m_faceGallery.size()
+                 << "量化方式:" << FaceGallery::quantizationName(m_faceGallery.quantization())
+                 << "内存:" << m_faceGallery.memoryBytes() << "字节"
+                 << "耗时:" << timer.elapsed() << "ms";
     }
     
-    // 比较两张人脸图像
-    float similarity = faceRecognizer.compareFaces(registeredFaceImage, faceImagePath);
+    startFeatureBackfill();
+    return true;
+}
+
+void DatabaseManager::startFeatureBackfill()
+{
+    if (m_backfillRunning) {
+        return;
+    }
     
-    // 获取相似度阈值
-    float threshold = getSetting("face_recognition_threshold", "0.6").toFloat();
+    // 旧版本录入、录入时特征库未加载或切换了识别后端的用户还没有当前后端的特征
+    QSqlQuery query;
+    query.prepare("SELECT work_id, face_image_path FROM users "
+                  "WHERE work_id NOT IN (SELECT work_id FROM face_features WHERE backend = :backend)");
+    query.bindValue(":backend", faceRecognizer()->backendName());
+    if (!query.exec()) {
+        qDebug() << "查询未提取人脸特征的用户失败:" << query.lastError().text();
+        return;
+    }
     
-    // 判断是否通过验证
-    bool result = similarity >= threshold;
+    m_pendingBackfill.clear();
+    while (query.next()) {
+        m_pendingBackfill.append(qMakePair(query.value(0).toString(), toLocalImagePath(query.value(1).toString())));
+    }
+    if (m_pendingBackfill.isEmpty()) {
+        return;
+    }
     
-    // 记录验证结果
-    logQuery.bindValue(":work_id", workId);
-    logQuery.bindValue(":access_result", result ? 1 : 0);
-    logQuery.exec();
+    qDebug() << "后台补充提取人脸特征，用户数:" << m_pendingBackfill.size();
+    m_backfillRunning = true;
+    m_backfillCount = 0;
+    backfillNextFeature();
+}
+
+void DatabaseManager::backfillNextFeature()
+{
+    while (!m_pendingBackfill.isEmpty()) {
+        QPair<QString, QString> item = m_pendingBackfill.takeFirst();
+        QString workId = item.first;
+        QString imagePath = item.second;
+        if (imagePath.isEmpty() || !QFileInfo::exists(imagePath)) {
+            qDebug() << "用户人脸图像不存在，跳过特征提取:" << workId << imagePath;
+            continue;
+        }
+        
+        QPointer<DatabaseManager> self(this);
+        QPointer<FaceRecognizer> recognizer(faceRecognizer());
+        InferenceExecutor::getInstance().post([self, recognizer, workId, imagePath]() {
+            QVector<float> feature = recognizer ? recognizer->extractFeatureVector(imagePath) : QVector<float>();
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [self, workId, feature]() {
+                if (self) {
+                    self->finishFeatureBackfill(workId, feature);
+                }
+            }, Qt::QueuedConnection);
+        });
+        return;
+    }
     
-    qDebug() << "Face verification result:" << result << "Similarity:" << similarity << "Threshold:" << threshold;
+    m_backfillRunning = false;
+    qDebug() << "后台补充提取人脸特征完成，提取:" << m_backfillCount;
+}
+
+void DatabaseManager::finishFeatureBackfill(const QString &workId, const QVector<float> &feature)
+{
+    if (feature.isEmpty()) {
+        qDebug() << "用户人脸图像中未能提取特征:" << workId;
+    } else {
+        // 提取期间用户可能已被删除或重新录入
+        QSqlQuery query;
+        query.prepare("SELECT EXISTS(SELECT 1 FROM users WHERE work_id = :work_id), "
+                      "EXISTS(SELECT 1 FROM face_features WHERE work_id = :work_id AND backend = :backend)");
+        query.bindValue(":work_id", workId);
+        query.bindValue(":backend", faceRecognizer()->backendName());
+        if (query.exec() && query.next() && query.value(0).toBool() && !query.value(1).toBool()
+                && addFaceTemplate(workId, feature, "enrol") >= 0) {
+            ++m_backfillCount;
+        }
+    }
     
-    return result;
+    backfillNextFeature();
 }
 
-QVariantMap DatabaseManager::recognizeFace(const QString &faceImagePath)
+QList<QList<FaceGallery::Candidate>> DatabaseManager::searchFaceCandidates(const QList<QVector<float>> &features, int count) const
 {
-    qDebug() << "Recognizing face using image:" << faceImagePath;
+    if (!m_useFaceIndex) {
+        return m_faceGallery.batchCandidates(features, count);
+    }
     
-    QVariantMap result;
-    result["recognized"] = false;
+    QList<QList<FaceGallery::Candidate>> candidates;
+    for (const QVector<float> &feature : features) {
+        candidates.append(feature.isEmpty() ? QList<FaceGallery::Candidate>() : m_faceIndex.candidates(feature, count));
+    }
+    return candidates;
+}
+
+void DatabaseManager::setGalleryFeature(const QString &label, const QVector<float> &feature)
+{
+    if (m_useFaceIndex) {
+        m_faceIndex.setFeature(label, feature);
+        m_faceIndexDirty = true;
+    } else {
+        m_faceGallery.setFeature(label, feature);
+    }
+}
+
+void DatabaseManager::removeGalleryFeature(const QString &label)
+{
+    if (m_useFaceIndex) {
+        if (m_faceIndex.contains(label)) {
+            m_faceIndex.removeFeature(label);
+            m_faceIndexDirty = true;
+        }
+    } else {
+        m_faceGallery.removeFeature(label);
+    }
+}
+
+QString DatabaseManager::faceIndexPath() const
+{
+    // 每个识别后端一个索引文件，切换后端后再切回不必重建
+    return QFileInfo(m_dbPath).absolutePath() + QString("/face_index_%1.hnsw").arg(m_galleryBackend);
+}
+
+QString DatabaseManager::faceFeatureStamp()
+{
+    // 行数和最大id在新增、删除、替换特征后都会变化；末尾的v2表示索引中的标识为 工号#模板id
+    QSqlQuery query;
+    query.prepare("SELECT COUNT(*), IFNULL(MAX(id), 0) FROM face_features WHERE backend = :backend");
+    query.bindValue(":backend", m_galleryBackend);
+    if (query.exec() && query.next()) {
+        return QString("%1:%2:v2").arg(query.value(0).toLongLong()).arg(query.value(1).toLongLong());
+    }
+    return QString();
+}
+
+void DatabaseManager::saveFaceIndex()
+{
+    if (!m_useFaceIndex || !m_faceIndexDirty || !m_database.isOpen()) {
+        return;
+    }
     
-    // 检查图像文件是否存在
-    QFileInfo imageFile(faceImagePath);
-    if (!imageFile.exists() || !imageFile.isFile()) {
-        qDebug() << "Face image file does not exist or is not a file:" << faceImagePath;
-        return result;
+    if (m_faceIndex.deletedRatio() > kFaceIndexMaxDeletedRatio) {
+        qDebug() << "人脸索引中已删除的节点过多，重建索引";
+        m_faceIndex.compact();
     }
     
-    // 创建人脸识别器
-    static FaceRecognizer faceRecognizer;
+    QElapsedTimer timer;
+    timer.start();
+    if (m_faceIndex.save(faceIndexPath(), faceFeatureStamp())) {
+        m_faceIndexDirty = false;
+        qDebug() << "人脸索引已保存:" << faceIndexPath() << "耗时:" << timer.elapsed() << "ms";
+    }
+}
+
+void DatabaseManager::refreshFaceFeature(const QString &workId, const QString &faceImagePath)
+{
+    // 录入图像变化后，原有模板（包括自动添加的）都不再可靠
+    removeFaceTemplates(workId);
     
-    // 初始化人脸识别器
-    if (!faceRecognizer.initialize()) {
-        qDebug() << "Failed to initialize face recognizer.";
-        return result;
+    if (!m_faceGalleryLoaded) {
+        // 特征库加载时会为该用户补充提取，录入时不必等待模型加载
+        m_pendingFeaturePath.clear();
+        m_pendingFeature.clear();
+        return;
     }
     
-    // 获取相似度阈值
-    float threshold = getSetting("face_recognition_threshold", "0.6").toFloat();
-    qDebug() << "Face recognition threshold:" << threshold;
+    QVector<float> feature = takePendingFeature(faceImagePath);
+    if (feature.isEmpty()) {
+        qDebug() << "录入的人脸图像中未能提取特征:" << workId << faceImagePath;
+        return;
+    }
     
-    // 获取最近识别过的用户 - 优先比较这些用户
-    static QStringList recentUsers;
+    addFaceTemplate(workId, feature, "enrol");
+}
+
+QVector<float> DatabaseManager::takePendingFeature(const QString &imagePath)
+{
+    // 录入前查重时已提取过同一图像的特征
+    QVector<float> feature;
+    QFileInfo imageFile(imagePath);
+    if (!m_pendingFeature.isEmpty() && imageFile.absoluteFilePath() == m_pendingFeaturePath
+            && imageFile.lastModified() == m_pendingFeatureModified) {
+        feature = m_pendingFeature;
+    } else {
+        feature = faceRecognizer()->extractFeatureVector(imagePath);
+    }
+    m_pendingFeaturePath.clear();
+    m_pendingFeature.clear();
+    return feature;
+}
+
+qint64 DatabaseManager::addFaceTemplate(const QString &workId, const QVector<float> &feature, const QString &source)
+{
+    QSqlQuery query;
+    query.prepare("INSERT INTO face_features (work_id, feature, source, backend) "
+                  "VALUES (:work_id, :feature, :source, :backend)");
+    query.bindValue(":work_id", workId);
+    query.bindValue(":feature", FaceGallery::toBlob(feature));
+    query.bindValue(":source", source);
+    query.bindValue(":backend", faceRecognizer()->backendName());
+    if (!query.exec()) {
+        qDebug() << "保存人脸特征失败:" << query.lastError().text();
+        return -1;
+    }
     
-    // 最大比较用户数量，避免对所有用户进行比较
-    int maxUsersToCompare = 10;
+    qint64 templateId = query.lastInsertId().toLongLong();
+    m_templateCache.remove(workId);
+    if (m_faceGalleryLoaded) {
+        setGalleryFeature(templateLabel(workId, templateId), feature);
+    }
+    return templateId;
+}
+
+void DatabaseManager::removeFaceTemplates(const QString &workId)
+{
+    // 模板变化后不再复用该用户的身份
+    if (m_trackedIdentity.workId == workId) {
+        m_trackedIdentity = TrackedIdentity();
+    }
     
-    float highestSimilarity = 0.0f;
-    QVariantMap bestMatch;
+    QSqlQuery query;
+    if (m_faceGalleryLoaded) {
+        query.prepare("SELECT id FROM face_features WHERE work_id = :work_id AND backend = :backend");
+        query.bindValue(":work_id", workId);
+        query.bindValue(":backend", faceRecognizer()->backendName());
+        if (query.exec()) {
+            while (query.next()) {
+                removeGalleryFeature(templateLabel(workId, query.value(0).toLongLong()));
+            }
+        }
+    }
     
-    // 先检查人脸位置，确保有人脸再进行比对
-    QVariantMap facePosition = faceRecognizer.detectFacePosition(faceImagePath);
-    if (!facePosition["faceDetected"].toBool()) {
-        qDebug() << "No face detected in the recognition image";
-        return result;
+    // 所有后端的模板都删除
+    query.prepare("DELETE FROM face_features WHERE work_id = :work_id");
+    query.bindValue(":work_id", workId);
+    if (!query.exec()) {
+        qDebug() << "Failed to delete face features:" << query.lastError().text();
+    }
+    m_templateCache.remove(workId);
+}
+
+void DatabaseManager::pruneFaceTemplates(const QString &workId, int maxCount)
+{
+    if (maxCount < 1) {
+        return;
     }
     
-    // 获取所有用户
-    QVariantList allUsers = getAllFaceData();
-    if (allUsers.isEmpty()) {
-        qDebug() << "No users found in database";
-        return result;
+    // 录入模板始终保留，先删除最早的自动模板，再删除合并模板
+    QSqlQuery query;
+    query.prepare("SELECT id, source FROM face_features WHERE work_id = :work_id AND backend = :backend "
+                  "ORDER BY CASE source WHEN 'enrol' THEN 2 WHEN 'merge' THEN 1 ELSE 0 END, id");
+    query.bindValue(":work_id", workId);
+    query.bindValue(":backend", faceRecognizer()->backendName());
+    if (!query.exec()) {
+        qDebug() << "读取人脸模板失败:" << query.lastError().text();
+        return;
     }
     
-    // 重新排序用户列表，将最近识别过的用户放在前面
-    QVariantList sortedUsers;
+    QList<qint64> removable;
+    int total = 0;
+    while (query.next()) {
+        ++total;
+        if (query.value(1).toString() != "enrol") {
+            removable.append(query.value(0).toLongLong());
+        }
+    }
     
-    // 先添加最近识别过的用户
-    for (const QString &recentUserId : recentUsers) {
-        for (int i = 0; i < allUsers.size(); ++i) {
-            QVariantMap user = allUsers[i].toMap();
-            if (user["workId"].toString() == recentUserId) {
-                sortedUsers.append(user);
-                allUsers.removeAt(i);
-                break;
-            }
+    m_templateCache.remove(workId);
+    QSqlQuery deleteQuery;
+    deleteQuery.prepare("DELETE FROM face_features WHERE id = :id");
+    for (int i = 0; i < removable.size() && total > maxCount; ++i, --total) {
+        deleteQuery.bindValue(":id", removable[i]);
+        if (!deleteQuery.exec()) {
+            qDebug() << "删除人脸模板失败:" << deleteQuery.lastError().text();
+            continue;
         }
+        removeGalleryFeature(templateLabel(workId, removable[i]));
+    }
+}
+
+void DatabaseManager::updateLoginTemplates(const QString &workId, const QVector<float> &feature, float similarity)
+{
+    // 只用高置信度的登录图像更新，避免把其他人的脸加入模板
+    float updateThreshold = getSetting("face_template_update_threshold", "0.75").toFloat();
+    if (similarity < updateThreshold) {
+        return;
     }
     
-    // 然后添加其他用户
-    sortedUsers.append(allUsers);
+    // 与已有模板过于相似的图像不增加信息
+    float redundantThreshold = getSetting("face_template_redundant_threshold", "0.9").toFloat();
+    QList<FaceTemplate> templates = loadFaceTemplates(QStringList() << workId).value(workId);
+    if (aggregateTemplateScore(feature, templates, false) >= redundantThreshold) {
+        return;
+    }
     
-    // 限制比较的用户数量
-    int usersToCompare = qMin(maxUsersToCompare, sortedUsers.size());
+    qint64 templateId = addFaceTemplate(workId, feature, "auto");
+    if (templateId >= 0) {
+        qDebug() << "登录图像已作为新模板加入:" << workId << "模板id:" << templateId << "相似度:" << similarity;
+        pruneFaceTemplates(workId, getSetting("face_max_templates", "5").toInt());
+    }
+}
+
+QHash<QString, QList<DatabaseManager::FaceTemplate>> DatabaseManager::loadFaceTemplates(const QStringList &workIds)
+{
+    QHash<QString, QList<FaceTemplate>> templates;
     
-    // 遍历用户进行人脸比对
-    for (int i = 0; i < usersToCompare; ++i) {
-        QVariantMap user = sortedUsers[i].toMap();
-        
-        // 获取用户注册的人脸图像
-        QString registeredFaceImage = user["faceImage"].toString();
-        
-        // 如果路径是URL格式，转换为本地路径
-        if (registeredFaceImage.startsWith("file:///")) {
-            QUrl url(registeredFaceImage);
-            registeredFaceImage = url.toLocalFile();
-        }
-        
-        // 检查注册的人脸图像是否存在
-        QFileInfo registeredImageFile(registeredFaceImage);
-        if (!registeredImageFile.exists() || !registeredImageFile.isFile()) {
-            qDebug() << "Registered face image file does not exist or is not a file:" << registeredFaceImage;
-            continue;
+    QSqlQuery query;
+    if (workIds.isEmpty()) {
+        query.prepare("SELECT id, work_id, source, feature FROM face_features WHERE backend = ? ORDER BY id");
+        query.addBindValue(faceRecognizer()->backendName());
+    } else {
+        QStringList placeholders;
+        for (int i = 0; i < workIds.size(); ++i) {
+            placeholders.append("?");
         }
-        
-        // 比较两张人脸图像
-        float similarity = faceRecognizer.compareFaces(registeredFaceImage, faceImagePath);
-        qDebug() << "User:" << user["name"].toString() << "Similarity:" << similarity;
-        
-        // 记录最高相似度的用户
-        if (similarity > highestSimilarity) {
-            highestSimilarity = similarity;
-            bestMatch = user;
-            
-            // 如果相似度已经很高，直接返回结果
-            if (similarity > 0.85) {
-                break;
-            }
+        query.prepare(QString("SELECT id, work_id, source, feature FROM face_features "
+                              "WHERE backend = ? AND work_id IN (%1) ORDER BY id")
+                          .arg(placeholders.join(", ")));
+        query.addBindValue(faceRecognizer()->backendName());
+        for (const QString &workId : workIds) {
+            query.addBindValue(workId);
         }
     }
     
-    // 判断是否找到匹配的用户
-    if (highestSimilarity >= threshold && !bestMatch.isEmpty()) {
-        qDebug() << "Face recognized as user:" << bestMatch["name"].toString() 
-                 << "with similarity:" << highestSimilarity;
-        
-        // 更新最近识别的用户列表
-        QString recognizedUserId = bestMatch["workId"].toString();
-        recentUsers.removeAll(recognizedUserId);
-        recentUsers.prepend(recognizedUserId);
-        
-        // 最多保留5个最近用户
-        while (recentUsers.size() > 5) {
-            recentUsers.removeLast();
-        }
-        
-        // 记录访问日志
-        QSqlQuery logQuery;
-        logQuery.prepare(
-            "INSERT INTO access_logs (work_id, access_result) "
-            "VALUES (:work_id, :access_result)"
-        );
-        logQuery.bindValue(":work_id", bestMatch["workId"].toString());
-        logQuery.bindValue(":access_result", 1);
-        logQuery.exec();
-        
-        // 返回识别结果
-        result["recognized"] = true;
-        result["name"] = bestMatch["name"];
-        result["workId"] = bestMatch["workId"];
-        result["similarity"] = highestSimilarity;
-    } else {
-        qDebug() << "No matching face found. Highest similarity:" << highestSimilarity;
+    if (!query.exec()) {
+        qDebug() << "读取人脸特征失败:" << query.lastError().text();
+        return templates;
     }
     
-    return result;
+    while (query.next()) {
+        FaceTemplate faceTemplate;
+        faceTemplate.id = query.value(0).toLongLong();
+        faceTemplate.source = query.value(2).toString();
+        faceTemplate.feature = FaceGallery::fromBlob(query.value(3).toByteArray());
+        templates[query.value(1).toString()].append(faceTemplate);
+    }
+    return templates;
 }
 
 bool DatabaseManager::userExists(const QString &workId)
 {
+    PERF_TRACE_METHOD();
     QSqlQuery query;
     query.prepare("SELECT COUNT(*) FROM users WHERE work_id = :work_id");
     query.bindValue(":work_id", workId);
@@ -898,6 +1975,7 @@ bool DatabaseManager::updateFaceData(const QString &workId, const QString &name,
                                     const QString &gender, const QString &faceImagePath, 
                                     const QString &avatarPath, bool isAdmin)
 {
+    PERF_TRACE_METHOD();
     QSqlQuery query;
     
     // 将绝对路径转换为相对路径
@@ -944,11 +2022,15 @@ bool DatabaseManager::updateFaceData(const QString &workId, const QString &name,
         return false;
     }
     
+    refreshFaceFeature(workId, toLocalImagePath(relativeFaceImagePath));
+    ++m_userImageVersions[workId];
+    emit userImagesChanged(workId, toLocalImagePath(relativeAvatarPath), toLocalImagePath(relativeFaceImagePath));
     return true;
 }
 
 bool DatabaseManager::setSetting(const QString &key, const QString &value)
 {
+    PERF_TRACE_METHOD();
     // 检查是否已有此设置，有则更新，无则插入
     QSqlQuery checkQuery;
     checkQuery.prepare("SELECT COUNT(*) FROM settings WHERE key = :key");
@@ -996,6 +2078,7 @@ bool DatabaseManager::setSetting(const QString &key, const QString &value)
 
 QString DatabaseManager::getSetting(const QString &key, const QString &defaultValue)
 {
+    PERF_TRACE_METHOD();
     QSqlQuery query;
     query.prepare("SELECT value FROM settings WHERE key = :key");
     query.bindValue(":key", key);
@@ -1010,6 +2093,7 @@ QString DatabaseManager::getSetting(const QString &key, const QString &defaultVa
 
 bool DatabaseManager::deleteSetting(const QString &key)
 {
+    PERF_TRACE_METHOD();
     QSqlQuery query;
     query.prepare("DELETE FROM settings WHERE key = :key");
     query.bindValue(":key", key);
@@ -1024,6 +2108,7 @@ bool DatabaseManager::deleteSetting(const QString &key)
 
 QVariantMap DatabaseManager::getAllSettings()
 {
+    PERF_TRACE_METHOD();
     QVariantMap result;
     QSqlQuery query("SELECT key, value FROM settings");
     
@@ -1090,6 +2175,8 @@ void DatabaseManager::initDefaultSettings()
 
 QVariantList DatabaseManager::getAccessLogs(int limit, int offset)
 {
+    PERF_TRACE_METHOD();
+    flushAccessLogs();
     QVariantList result;
     QSqlQuery query;
     
@@ -1120,11 +2207,14 @@ QVariantList DatabaseManager::getAccessLogs(int limit, int offset)
         qDebug() << "Failed to get access logs:" << query.lastError().text();
     }
     
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
 QVariantList DatabaseManager::getAccessLogsByUser(const QString &workId, int limit, int offset)
 {
+    PERF_TRACE_METHOD();
+    flushAccessLogs();
     QVariantList result;
     QSqlQuery query;
     
@@ -1157,19 +2247,24 @@ QVariantList DatabaseManager::getAccessLogsByUser(const QString &workId, int lim
         qDebug() << "Failed to get user access logs:" << query.lastError().text();
     }
     
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
 bool DatabaseManager::cleanupOldLogs(int daysToKeep)
 {
+    PERF_TRACE_METHOD();
+    flushAccessLogs();
     QSqlQuery query;
     
     // 计算截止日期，删除此日期之前的所有日志
     QString cutoffDate = QDateTime::currentDateTime().addDays(-daysToKeep).toString("yyyy-MM-dd");
     
+    // 直接比较时间字符串（"yyyy-MM-dd hh:mm:ss" 与 "yyyy-MM-dd" 按字典序比较），
+    // 不对列套用date()，以便使用idx_access_logs_time索引
     query.prepare(
         "DELETE FROM access_logs "
-        "WHERE date(access_time) < date(:cutoff_date)"
+        "WHERE access_time < :cutoff_date"
     );
     
     query.bindValue(":cutoff_date", cutoffDate);
@@ -1188,6 +2283,7 @@ bool DatabaseManager::cleanupOldLogs(int daysToKeep)
 // 根据工号获取用户头像路径
 QString DatabaseManager::getUserAvatarPath(const QString &workId)
 {
+    PERF_TRACE_METHOD();
     QSqlQuery query(m_database);
     query.prepare("SELECT avatar_path FROM users WHERE work_id = :work_id");
     query.bindValue(":work_id", workId);
@@ -1232,6 +2328,7 @@ QString DatabaseManager::getUserAvatarPath(const QString &workId)
 
 bool DatabaseManager::addQuestionBank(const QString &name, int questionCount)
 {
+    PERF_TRACE_METHOD();
     // 检查是否存在同名题库
     QSqlQuery checkQuery(m_database);
     checkQuery.prepare("SELECT COUNT(*) FROM question_banks WHERE name = :name");
@@ -1270,6 +2367,7 @@ bool DatabaseManager::addQuestionBank(const QString &name, int questionCount)
 
 bool DatabaseManager::deleteQuestionBank(int bankId)
 {
+    PERF_TRACE_METHOD();
     qDebug() << "开始删除题库，ID:" << bankId;
     
     // 检查数据库连接
@@ -1356,6 +2454,7 @@ bool DatabaseManager::deleteQuestionBank(int bankId)
 
 QVariantList DatabaseManager::getAllQuestionBanks()
 {
+    PERF_TRACE_METHOD();
     QVariantList result;
     QSqlQuery query(m_database);
     query.prepare("SELECT * FROM question_banks ORDER BY import_time DESC");
@@ -1382,11 +2481,13 @@ QVariantList DatabaseManager::getAllQuestionBanks()
         result.append(row);
     }
     
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
 QVariantMap DatabaseManager::getQuestionBankById(int bankId)
 {
+    PERF_TRACE_METHOD();
     QVariantMap result;
     QSqlQuery query(m_database);
     
@@ -1418,6 +2519,7 @@ QVariantMap DatabaseManager::getQuestionBankById(int bankId)
 
 bool DatabaseManager::updateQuestionBank(int bankId, const QString &name)
 {
+    PERF_TRACE_METHOD();
     QSqlQuery query;
     query.prepare("UPDATE question_banks SET name = :name WHERE id = :id");
     query.bindValue(":name", name);
@@ -1437,6 +2539,7 @@ bool DatabaseManager::addQuestion(int bankId,
                                 const QString &analysis,
                                 const QStringList &options)
 {
+    PERF_TRACE_METHOD();
     QSqlQuery query(m_database);
     query.prepare(
         "INSERT INTO questions (bank_id, content, answer, analysis) "
@@ -1488,6 +2591,7 @@ bool DatabaseManager::addQuestion(int bankId,
 
 bool DatabaseManager::deleteQuestion(int questionId)
 {
+    PERF_TRACE_METHOD();
     // 获取题目所属的题库ID
     QSqlQuery query(m_database);
     query.prepare("SELECT bank_id FROM questions WHERE id = :id");
@@ -1527,6 +2631,7 @@ bool DatabaseManager::updateQuestion(int questionId,
                                    const QString &analysis,
                                    const QStringList &options)
 {
+    PERF_TRACE_METHOD();
     QSqlQuery query(m_database);
     query.prepare(
         "UPDATE questions SET content = :content, answer = :answer, analysis = :analysis "
@@ -1577,6 +2682,7 @@ bool DatabaseManager::updateQuestion(int questionId,
 
 QVariantList DatabaseManager::getQuestionsByBankId(int bankId)
 {
+    PERF_TRACE_METHOD();
     QVariantList result;
     QSqlQuery query(m_database);
     query.prepare("SELECT * FROM questions WHERE bank_id = :bank_id ORDER BY id");
@@ -1611,11 +2717,13 @@ QVariantList DatabaseManager::getQuestionsByBankId(int bankId)
         result.append(question);
     }
     
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
 QVariantMap DatabaseManager::getQuestionById(int questionId)
 {
+    PERF_TRACE_METHOD();
     QVariantMap result;
     QSqlQuery query(m_database);
     query.prepare("SELECT * FROM questions WHERE id = :id");
@@ -1646,8 +2754,102 @@ QVariantMap DatabaseManager::getQuestionById(int questionId)
     return result;
 }
 
+QVariantList DatabaseManager::getQuestionsByIds(const QVariantList &questionIds)
+{
+    PERF_TRACE_METHOD();
+    QVariantList result;
+    
+    if (questionIds.isEmpty()) {
+        return result;
+    }
+    
+    // 去重后的题目ID，保持首次出现的顺序
+    QList<int> uniqueIds;
+    QSet<int> seenIds;
+    for (const QVariant &idVar : questionIds) {
+        int questionId = idVar.toInt();
+        if (!seenIds.contains(questionId)) {
+            seenIds.insert(questionId);
+            uniqueIds.append(questionId);
+        }
+    }
+    
+    QHash<int, QVariantMap> questionsById;
+    QHash<int, QStringList> optionsById;
+    
+    // 按批次查询，避免超出SQLite单条语句的参数数量上限
+    const int batchSize = 500;
+    for (int start = 0; start < uniqueIds.size(); start += batchSize) {
+        QList<int> batch = uniqueIds.mid(start, batchSize);
+        
+        QStringList placeholders;
+        for (int i = 0; i < batch.size(); ++i) {
+            placeholders.append("?");
+        }
+        QString inClause = placeholders.join(", ");
+        
+        // 一次查询获取本批次的所有题目
+        QSqlQuery query(m_database);
+        query.prepare("SELECT id, bank_id, content, answer, analysis FROM questions "
+                      "WHERE id IN (" + inClause + ")");
+        for (int questionId : batch) {
+            query.addBindValue(questionId);
+        }
+        
+        if (!query.exec()) {
+            qDebug() << "批量获取题目失败:" << query.lastError().text();
+            return result;
+        }
+        
+        while (query.next()) {
+            QVariantMap question;
+            question["id"] = query.value("id").toInt();
+            question["bankId"] = query.value("bank_id").toInt();
+            question["content"] = query.value("content").toString();
+            question["answer"] = query.value("answer").toString();
+            question["analysis"] = query.value("analysis").toString();
+            questionsById.insert(question["id"].toInt(), question);
+        }
+        
+        // 一次查询获取本批次题目的所有选项，按题目和选项序号排序
+        QSqlQuery optionQuery(m_database);
+        optionQuery.prepare("SELECT question_id, option_text FROM question_options "
+                            "WHERE question_id IN (" + inClause + ") "
+                            "ORDER BY question_id, option_index");
+        for (int questionId : batch) {
+            optionQuery.addBindValue(questionId);
+        }
+        
+        if (!optionQuery.exec()) {
+            qDebug() << "批量获取题目选项失败:" << optionQuery.lastError().text();
+            return result;
+        }
+        
+        while (optionQuery.next()) {
+            optionsById[optionQuery.value(0).toInt()].append(optionQuery.value(1).toString());
+        }
+    }
+    
+    // 按请求顺序组装结果，不存在的题目ID直接跳过
+    for (int questionId : uniqueIds) {
+        auto it = questionsById.find(questionId);
+        if (it == questionsById.end()) {
+            continue;
+        }
+        
+        QVariantMap question = it.value();
+        question["options"] = optionsById.value(questionId);
+        result.append(question);
+    }
+    
+    qDebug() << "批量获取题目完成，请求" << questionIds.size() << "道，返回" << result.size() << "道";
+    PERF_TRACE_ROWS(result.size());
+    return result;
+}
+
 QVariantList DatabaseManager::getRandomQuestions(int bankId, int count)
 {
+    PERF_TRACE_METHOD();
     QVariantList result;
     QSqlQuery query(m_database);
     
@@ -1737,11 +2939,13 @@ QVariantList DatabaseManager::getRandomQuestions(int bankId, int count)
         result.append(question);
     }
     
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
 bool DatabaseManager::importQuestions(int bankId, const QVariantList &questions)
 {
+    PERF_TRACE_METHOD();
     if (questions.isEmpty()) {
         qDebug() << "没有题目需要导入";
         return false;
@@ -1821,6 +3025,7 @@ bool DatabaseManager::importQuestions(int bankId, const QVariantList &questions)
 // 获取所有智点
 QVariantList DatabaseManager::getAllKnowledgePoints()
 {
+    PERF_TRACE_METHOD();
     QVariantList points;
     
     if (!m_database.isOpen()) {
@@ -1847,12 +3052,99 @@ QVariantList DatabaseManager::getAllKnowledgePoints()
         points.append(point);
     }
     
+    PERF_TRACE_ROWS(points.size());
+    return points;
+}
+
+// 获取所有智点ID
+QVariantList DatabaseManager::getKnowledgePointIds()
+{
+    PERF_TRACE_METHOD();
+    QVariantList ids;
+    
+    if (!m_database.isOpen()) {
+        qDebug() << "数据库未打开，尝试重新打开";
+        if (!m_database.open()) {
+            qDebug() << "无法打开数据库:" << m_database.lastError().text();
+            return ids;
+        }
+    }
+    
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT id FROM knowledge_points ORDER BY id DESC")) {
+        qDebug() << "获取智点ID失败:" << query.lastError().text();
+        return ids;
+    }
+    
+    while (query.next()) {
+        ids.append(query.value(0).toInt());
+    }
+    
+    PERF_TRACE_ROWS(ids.size());
+    return ids;
+}
+
+// 按ID批量获取智点
+QVariantList DatabaseManager::getKnowledgePointsByIds(const QVariantList &pointIds)
+{
+    PERF_TRACE_METHOD();
+    QVariantList points;
+    
+    if (pointIds.isEmpty()) {
+        return points;
+    }
+    
+    if (!m_database.isOpen()) {
+        qDebug() << "数据库未打开，尝试重新打开";
+        if (!m_database.open()) {
+            qDebug() << "无法打开数据库:" << m_database.lastError().text();
+            return points;
+        }
+    }
+    
+    QStringList placeholders;
+    for (int i = 0; i < pointIds.size(); ++i) {
+        placeholders << "?";
+    }
+    
+    QSqlQuery query(m_database);
+    query.prepare(QString("SELECT id, title, content FROM knowledge_points WHERE id IN (%1)")
+                      .arg(placeholders.join(", ")));
+    for (const QVariant &id : pointIds) {
+        query.addBindValue(id.toInt());
+    }
+    
+    if (!query.exec()) {
+        qDebug() << "批量获取智点失败:" << query.lastError().text();
+        return points;
+    }
+    
+    QHash<int, QVariantMap> pointMap;
+    while (query.next()) {
+        QVariantMap point;
+        point["id"] = query.value("id").toInt();
+        point["title"] = query.value("title").toString();
+        point["content"] = query.value("content").toString();
+        pointMap.insert(point["id"].toInt(), point);
+    }
+    
+    // 按传入顺序返回，已删除的智点跳过
+    for (const QVariant &id : pointIds) {
+        auto it = pointMap.constFind(id.toInt());
+        if (it != pointMap.constEnd()) {
+            points.append(it.value());
+        }
+    }
+    
+    PERF_TRACE_ROWS(points.size());
     return points;
 }
 
 // 添加单个智点
 bool DatabaseManager::addKnowledgePoint(const QString &title, const QString &content)
 {
+    PERF_TRACE_METHOD();
     if (title.isEmpty() || content.isEmpty()) {
         qDebug() << "智点标题或内容不能为空";
         return false;
@@ -1876,12 +3168,14 @@ bool DatabaseManager::addKnowledgePoint(const QString &title, const QString &con
         return false;
     }
     
+    emit knowledgePointsChanged();
     return true;
 }
 
 // 删除智点
 bool DatabaseManager::deleteKnowledgePoint(int pointId)
 {
+    PERF_TRACE_METHOD();
     if (!m_database.isOpen()) {
         qDebug() << "数据库未打开，尝试重新打开";
         if (!m_database.open()) {
@@ -1899,12 +3193,14 @@ bool DatabaseManager::deleteKnowledgePoint(int pointId)
         return false;
     }
     
+    emit knowledgePointsChanged();
     return true;
 }
 
 // 批量导入智点
 bool DatabaseManager::importKnowledgePoints(const QVariantList &points)
 {
+    PERF_TRACE_METHOD();
     if (points.isEmpty()) {
         qDebug() << "没有智点需要导入";
         return false;
@@ -1960,6 +3256,7 @@ bool DatabaseManager::importKnowledgePoints(const QVariantList &points)
             return false;
         }
         qDebug() << "成功导入" << successCount << "条智点数据，失败" << failCount << "条";
+        emit knowledgePointsChanged();
         return true;
     } else {
         m_database.rollback();
@@ -1971,6 +3268,7 @@ bool DatabaseManager::importKnowledgePoints(const QVariantList &points)
 // 清空所有智点
 bool DatabaseManager::clearAllKnowledgePoints()
 {
+    PERF_TRACE_METHOD();
     if (!m_database.isOpen()) {
         qDebug() << "数据库未打开，尝试重新打开";
         if (!m_database.open()) {
@@ -1988,6 +3286,7 @@ bool DatabaseManager::clearAllKnowledgePoints()
     }
     
     qDebug() << "成功清空所有智点";
+    emit knowledgePointsChanged();
     return true;
 }
 
@@ -2013,6 +3312,7 @@ bool DatabaseManager::saveUserAnswerRecord(const QString &workId,
                                        const QString &questionBankInfo,
                                        const QString &pentagonType)
 {
+    PERF_TRACE_METHOD();
     if (!m_database.isOpen()) {
         qDebug() << "数据库未打开，尝试重新打开";
         if (!m_database.open()) {
@@ -2040,6 +3340,9 @@ bool DatabaseManager::saveUserAnswerRecord(const QString &workId,
     // 在继续前确保表结构是最新的
     updateDatabaseSchema();
     
+    // 答题记录与错题汇总在同一事务中写入
+    m_database.transaction();
+    
     QSqlQuery query(m_database);
     
     // 准备SQL语句，使用参数化查询防止SQL注入
@@ -2056,7 +3359,13 @@ bool DatabaseManager::saveUserAnswerRecord(const QString &workId,
     query.bindValue(":exam_type", examType);
     query.bindValue(":total_questions", totalQuestions);
     query.bindValue(":correct_count", correctCount);
-    query.bindValue(":answer_data", answerData);
+    // 答题数据以CBOR编码存储，无法解析的JSON原样保存
+    QByteArray encodedAnswerData = AnswerDataCodec::encode(answerData);
+    if (encodedAnswerData.isEmpty()) {
+        query.bindValue(":answer_data", answerData);
+    } else {
+        query.bindValue(":answer_data", encodedAnswerData);
+    }
     query.bindValue(":question_bank_info", questionBankInfo);
     query.bindValue(":pentagon_type", pentagonType);
     
@@ -2083,6 +3392,20 @@ bool DatabaseManager::saveUserAnswerRecord(const QString &workId,
             }
         }
         
+        m_database.rollback();
+        return false;
+    }
+    
+    // 增量更新答题记录错题汇总
+    QVariant storedAnswerData = encodedAnswerData.isEmpty() ? QVariant(answerData) : QVariant(encodedAnswerData);
+    if (!accumulateRecordWrongQuestions(workId, storedAnswerData, questionBankInfo)) {
+        m_database.rollback();
+        return false;
+    }
+    
+    if (!m_database.commit()) {
+        qDebug() << "提交答题记录失败:" << m_database.lastError().text();
+        m_database.rollback();
         return false;
     }
     
@@ -2092,6 +3415,7 @@ bool DatabaseManager::saveUserAnswerRecord(const QString &workId,
 
 QVariantList DatabaseManager::getUserAnswerRecords(const QString &workId, int limit, int offset)
 {
+    PERF_TRACE_METHOD();
     QVariantList result;
     
     if (!m_database.isOpen()) {
@@ -2127,7 +3451,8 @@ QVariantList DatabaseManager::getUserAnswerRecords(const QString &workId, int li
         record["examType"] = query.value("exam_type").toString();
         record["totalQuestions"] = query.value("total_questions").toInt();
         record["correctCount"] = query.value("correct_count").toInt();
-        record["answerData"] = query.value("answer_data").toString();
+        record["answerData"] = AnswerDataCodec::toJson(query.value("answer_data"));
+        record["wrongQuestionIds"] = AnswerDataCodec::wrongIds(query.value("answer_data"));
         record["scorePercentage"] = query.value("score_percentage").toFloat();
         record["createdAt"] = query.value("created_at").toString();
         record["questionBankInfo"] = query.value("question_bank_info").toString();
@@ -2136,11 +3461,13 @@ QVariantList DatabaseManager::getUserAnswerRecords(const QString &workId, int li
         result.append(record);
     }
     
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
 QVariantList DatabaseManager::getAllAnswerRecords(int limit, int offset)
 {
+    PERF_TRACE_METHOD();
     QVariantList result;
     
     if (!m_database.isOpen()) {
@@ -2176,7 +3503,8 @@ QVariantList DatabaseManager::getAllAnswerRecords(int limit, int offset)
         record["examType"] = query.value("exam_type").toString();
         record["totalQuestions"] = query.value("total_questions").toInt();
         record["correctCount"] = query.value("correct_count").toInt();
-        record["answerData"] = query.value("answer_data").toString();
+        record["answerData"] = AnswerDataCodec::toJson(query.value("answer_data"));
+        record["wrongQuestionIds"] = AnswerDataCodec::wrongIds(query.value("answer_data"));
         record["scorePercentage"] = query.value("score_percentage").toFloat();
         record["createdAt"] = query.value("created_at").toString();
         record["questionBankInfo"] = query.value("question_bank_info").toString();
@@ -2185,6 +3513,7 @@ QVariantList DatabaseManager::getAllAnswerRecords(int limit, int offset)
         result.append(record);
     }
     
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
@@ -2195,6 +3524,7 @@ QVariantList DatabaseManager::getAllAnswerRecords(int limit, int offset)
  */
 QVariantMap DatabaseManager::getUserPracticeData(const QString &workId)
 {
+    PERF_TRACE_METHOD();
     QVariantMap result;
     
     // 获取基本用户信息
@@ -2210,7 +3540,7 @@ QVariantMap DatabaseManager::getUserPracticeData(const QString &workId)
     QSqlQuery query(m_database);
     
     // 统计总做题数
-    query.prepare("SELECT COUNT(*) FROM user_answer_records WHERE workId = :workId");
+    query.prepare("SELECT COUNT(*) FROM user_answer_records WHERE work_id = :workId");
     query.bindValue(":workId", workId);
     
     if (query.exec() && query.next()) {
@@ -2221,7 +3551,7 @@ QVariantMap DatabaseManager::getUserPracticeData(const QString &workId)
     }
     
     // 统计正确题数和正确率
-    query.prepare("SELECT SUM(correctCount), SUM(totalQuestions) FROM user_answer_records WHERE workId = :workId");
+    query.prepare("SELECT SUM(correct_count), SUM(total_questions) FROM user_answer_records WHERE work_id = :workId");
     query.bindValue(":workId", workId);
     
     if (query.exec() && query.next()) {
@@ -2243,7 +3573,7 @@ QVariantMap DatabaseManager::getUserPracticeData(const QString &workId)
     }
     
     // 获取平均用时（假设有duration字段，单位为秒）
-    query.prepare("SELECT AVG(duration) FROM user_answer_records WHERE workId = :workId");
+    query.prepare("SELECT AVG(duration) FROM user_answer_records WHERE work_id = :workId");
     query.bindValue(":workId", workId);
     
     if (query.exec() && query.next() && !query.value(0).isNull()) {
@@ -2255,7 +3585,7 @@ QVariantMap DatabaseManager::getUserPracticeData(const QString &workId)
     }
     
     // 获取最近一次做题时间
-    query.prepare("SELECT MAX(createdAt) FROM user_answer_records WHERE workId = :workId");
+    query.prepare("SELECT MAX(created_at) FROM user_answer_records WHERE work_id = :workId");
     query.bindValue(":workId", workId);
     
     if (query.exec() && query.next() && !query.value(0).isNull()) {
@@ -2277,6 +3607,7 @@ QVariantMap DatabaseManager::getUserPracticeData(const QString &workId)
  */
 QVariantList DatabaseManager::getUserMonthlyPracticeData(const QString &workId, int monthCount)
 {
+    PERF_TRACE_METHOD();
     QVariantList result;
     
     // 检查用户是否存在
@@ -2302,22 +3633,22 @@ QVariantList DatabaseManager::getUserMonthlyPracticeData(const QString &workId,
         monthData["month"] = month;
         monthData["monthName"] = QString("%1年%2月").arg(year).arg(month);
         
-        // 获取月份第一天和最后一天
+        // 获取月份第一天和下月第一天，构成半开区间[startDate, endDate)
         QDate firstDay(year, month, 1);
-        QDate lastDay = firstDay.addMonths(1).addDays(-1);
+        QDate nextMonthFirstDay = firstDay.addMonths(1);
         
-        // 转换为ISO格式的字符串，适用于SQLite日期比较
+        // 转换为ISO格式的字符串，直接与created_at比较以使用索引
         QString startDate = firstDay.toString(Qt::ISODate);
-        QString endDate = lastDay.toString(Qt::ISODate);
+        QString endDate = nextMonthFirstDay.toString(Qt::ISODate);
         
         QSqlQuery query(m_database);
         
         // 查询该月完成的题目数量
-        query.prepare("SELECT COUNT(*), SUM(correctCount), SUM(totalQuestions) "
+        query.prepare("SELECT COUNT(*), SUM(correct_count), SUM(total_questions) "
                      "FROM user_answer_records "
-                     "WHERE workId = :workId "
-                     "AND date(createdAt) >= date(:startDate) "
-                     "AND date(createdAt) <= date(:endDate)");
+                     "WHERE work_id = :workId "
+                     "AND created_at >= :startDate "
+                     "AND created_at < :endDate");
         query.bindValue(":workId", workId);
         query.bindValue(":startDate", startDate);
         query.bindValue(":endDate", endDate);
@@ -2354,9 +3685,9 @@ QVariantList DatabaseManager::getUserMonthlyPracticeData(const QString &workId,
         // 获取平均用时
         query.prepare("SELECT AVG(duration) "
                      "FROM user_answer_records "
-                     "WHERE workId = :workId "
-                     "AND date(createdAt) >= date(:startDate) "
-                     "AND date(createdAt) <= date(:endDate)");
+                     "WHERE work_id = :workId "
+                     "AND created_at >= :startDate "
+                     "AND created_at < :endDate");
         query.bindValue(":workId", workId);
         query.bindValue(":startDate", startDate);
         query.bindValue(":endDate", endDate);
@@ -2371,6 +3702,7 @@ QVariantList DatabaseManager::getUserMonthlyPracticeData(const QString &workId,
         result.append(monthData);
     }
     
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
@@ -2383,6 +3715,7 @@ QVariantList DatabaseManager::getUserMonthlyPracticeData(const QString &workId,
  */
 QVariantList DatabaseManager::getUserDailyPracticeData(const QString &workId, int year, int month)
 {
+    PERF_TRACE_METHOD();
     QVariantList result;
     
     // 检查用户是否存在
@@ -2391,24 +3724,24 @@ QVariantList DatabaseManager::getUserDailyPracticeData(const QString &workId, in
         return result;
     }
     
-    // 获取月份的第一天和最后一天
+    // 获取月份的第一天和下月第一天，构成半开区间[startDate, endDate)
     QDate firstDay(year, month, 1);
-    QDate lastDay = firstDay.addMonths(1).addDays(-1);
+    QDate nextMonthFirstDay = firstDay.addMonths(1);
     
-    // 转换为ISO格式的字符串，适用于SQLite日期比较
+    // 转换为ISO格式的字符串，直接与created_at比较以使用索引
     QString startDate = firstDay.toString(Qt::ISODate);
-    QString endDate = lastDay.toString(Qt::ISODate);
+    QString endDate = nextMonthFirstDay.toString(Qt::ISODate);
     
     QSqlQuery query(m_database);
     
     // 查询该用户在指定月份每天的做题数量
-    query.prepare("SELECT strftime('%d', createdAt) as day, "
-                 "SUM(totalQuestions) as questionCount "
+    query.prepare("SELECT strftime('%d', created_at) as day, "
+                 "SUM(total_questions) as questionCount "
                  "FROM user_answer_records "
-                 "WHERE workId = :workId "
-                 "AND date(createdAt) >= date(:startDate) "
-                 "AND date(createdAt) <= date(:endDate) "
-                 "GROUP BY strftime('%d', createdAt) "
+                 "WHERE work_id = :workId "
+                 "AND created_at >= :startDate "
+                 "AND created_at < :endDate "
+                 "GROUP BY strftime('%d', created_at) "
                  "ORDER BY day");
     
     query.bindValue(":workId", workId);
@@ -2427,6 +3760,7 @@ QVariantList DatabaseManager::getUserDailyPracticeData(const QString &workId, in
         qWarning() << "获取每日刷题数据失败：" << query.lastError().text();
     }
     
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
@@ -2437,6 +3771,7 @@ QVariantList DatabaseManager::getUserDailyPracticeData(const QString &workId, in
  */
 int DatabaseManager::getUserCurrentMonthQuestionCount(const QString &workId)
 {
+    PERF_TRACE_METHOD();
     // 检查用户是否存在
     if (!userExists(workId)) {
         qWarning() << "用户不存在，工号：" << workId;
@@ -2448,13 +3783,13 @@ int DatabaseManager::getUserCurrentMonthQuestionCount(const QString &workId)
     int year = currentDate.year();
     int month = currentDate.month();
     
-    // 获取当月第一天和最后一天
+    // 获取当月第一天和下月第一天，构成半开区间[startDate, endDate)
     QDate firstDay(year, month, 1);
-    QDate lastDay = firstDay.addMonths(1).addDays(-1);
+    QDate nextMonthFirstDay = firstDay.addMonths(1);
     
-    // 转换为ISO格式的字符串，适用于SQLite日期比较
+    // 转换为ISO格式的字符串，直接与created_at比较以使用索引
     QString startDate = firstDay.toString(Qt::ISODate);
-    QString endDate = lastDay.toString(Qt::ISODate);
+    QString endDate = nextMonthFirstDay.toString(Qt::ISODate);
     
     QSqlQuery query(m_database);
     
@@ -2462,8 +3797,8 @@ int DatabaseManager::getUserCurrentMonthQuestionCount(const QString &workId)
     query.prepare("SELECT SUM(total_questions) "
                  "FROM user_answer_records "
                  "WHERE work_id = :workId "
-                 "AND date(created_at) >= date(:startDate) "
-                 "AND date(created_at) <= date(:endDate)");
+                 "AND created_at >= :startDate "
+                 "AND created_at < :endDate");
     query.bindValue(":workId", workId);
     query.bindValue(":startDate", startDate);
     query.bindValue(":endDate", endDate);
@@ -2484,6 +3819,7 @@ int DatabaseManager::getUserCurrentMonthQuestionCount(const QString &workId)
  */
 QVariantList DatabaseManager::getUserYearlyQuestionData(const QString &workId)
 {
+    PERF_TRACE_METHOD();
     QVariantList result;
     
     // 检查用户是否存在
@@ -2507,17 +3843,19 @@ QVariantList DatabaseManager::getUserYearlyQuestionData(const QString &workId)
     
     QSqlQuery query(m_database);
     
-    // 查询本年度每月的题目总数
+    // 查询本年度每月的题目总数，用[本年1月1日, 次年1月1日)区间代替strftime('%Y')过滤以使用索引
     query.prepare("SELECT strftime('%m', created_at) as month, "
                  "SUM(total_questions) as questionCount "
                  "FROM user_answer_records "
                  "WHERE work_id = :workId "
-                 "AND strftime('%Y', created_at) = :year "
+                 "AND created_at >= :startDate "
+                 "AND created_at < :endDate "
                  "GROUP BY strftime('%m', created_at) "
                  "ORDER BY month");
     
     query.bindValue(":workId", workId);
-    query.bindValue(":year", QString::number(currentYear));
+    query.bindValue(":startDate", QDate(currentYear, 1, 1).toString(Qt::ISODate));
+    query.bindValue(":endDate", QDate(currentYear + 1, 1, 1).toString(Qt::ISODate));
     
     if (query.exec()) {
         while (query.next()) {
@@ -2533,6 +3871,7 @@ QVariantList DatabaseManager::getUserYearlyQuestionData(const QString &workId)
         qWarning() << "获取年度刷题数据失败：" << query.lastError().text();
     }
     
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
@@ -2543,6 +3882,7 @@ QVariantList DatabaseManager::getUserYearlyQuestionData(const QString &workId)
  */
 QVariantList DatabaseManager::getUserRollingYearQuestionData(const QString &workId)
 {
+    PERF_TRACE_METHOD();
     QVariantList result;
     
     // 检查用户是否存在
@@ -2562,12 +3902,11 @@ QVariantList DatabaseManager::getUserRollingYearQuestionData(const QString &work
     QDate startDate = currentDate.addMonths(-11);
     startDate.setDate(startDate.year(), startDate.month(), 1); // 设置为月初
     
-    // 设置当前月的月末（这样才能包含当月数据）
-    int lastDay = QDate(currentDate.year(), currentDate.month(), 1).daysInMonth();
-    QDate endDate = QDate(currentDate.year(), currentDate.month(), lastDay);
+    // 设置为下月第一天作为开区间终点（这样才能包含当月数据）
+    QDate endDate = QDate(currentDate.year(), currentDate.month(), 1).addMonths(1);
     
     qDebug() << "获取从" << startDate.toString(Qt::ISODate) 
-             << "到" << endDate.toString(Qt::ISODate) << "的滚动年度数据";
+             << "到" << endDate.toString(Qt::ISODate) << "(不含)的滚动年度数据";
     
     // 为12个月初始化数组
     QMap<QString, int> monthData;
@@ -2591,8 +3930,8 @@ QVariantList DatabaseManager::getUserRollingYearQuestionData(const QString &work
                  "SUM(total_questions) as questionCount "
                  "FROM user_answer_records "
                  "WHERE work_id = :workId "
-                 "AND date(created_at) >= date(:startDate) "
-                 "AND date(created_at) <= date(:endDate) "
+                 "AND created_at >= :startDate "
+                 "AND created_at < :endDate "
                  "GROUP BY yearMonth "
                  "ORDER BY yearMonth");
     
@@ -2628,6 +3967,7 @@ QVariantList DatabaseManager::getUserRollingYearQuestionData(const QString &work
         qDebug() << "添加到结果数组:" << key << "值:" << monthData[key] << "，索引:" << i;
     }
     
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
@@ -2638,6 +3978,7 @@ QVariantList DatabaseManager::getUserRollingYearQuestionData(const QString &work
  */
 QVariantMap DatabaseManager::getUserAbilityData(const QString &workId)
 {
+    PERF_TRACE_METHOD();
     QVariantMap result;
     
     // 检查用户是否存在
@@ -2662,22 +4003,22 @@ QVariantMap DatabaseManager::getUserAbilityData(const QString &workId)
         int year = targetDate.year();
         int month = targetDate.month();
         
-        // 获取月份的第一天和最后一天
+        // 获取月份的第一天和下月第一天，构成半开区间[startDate, endDate)
         QDate firstDay(year, month, 1);
-        QDate lastDay = firstDay.addMonths(1).addDays(-1);
+        QDate nextMonthFirstDay = firstDay.addMonths(1);
         
         // 转换为ISO格式的字符串
         QString startDate = firstDay.toString(Qt::ISODate);
-        QString endDate = lastDay.toString(Qt::ISODate);
+        QString endDate = nextMonthFirstDay.toString(Qt::ISODate);
         
         // 基于该用户在指定月份的练习数据生成能力值
         // 这里使用一个简单算法生成模拟数据，实际应用中应根据实际需求实现
         QSqlQuery query(m_database);
-        query.prepare("SELECT COUNT(*), SUM(correctCount), SUM(totalQuestions) "
+        query.prepare("SELECT COUNT(*), SUM(correct_count), SUM(total_questions) "
                      "FROM user_answer_records "
-                     "WHERE workId = :workId "
-                     "AND date(createdAt) >= date(:startDate) "
-                     "AND date(createdAt) <= date(:endDate)");
+                     "WHERE work_id = :workId "
+                     "AND created_at >= :startDate "
+                     "AND created_at < :endDate");
         query.bindValue(":workId", workId);
         query.bindValue(":startDate", startDate);
         query.bindValue(":endDate", endDate);
@@ -2738,26 +4079,27 @@ QVariantMap DatabaseManager::getUserAbilityData(const QString &workId)
  */
 int DatabaseManager::getMaxMonthlyQuestionCount()
 {
+    PERF_TRACE_METHOD();
     // 获取当前日期
     QDate currentDate = QDate::currentDate();
     int year = currentDate.year();
     int month = currentDate.month();
     
-    // 获取当月第一天和最后一天
+    // 获取当月第一天和下月第一天，构成半开区间[startDate, endDate)
     QDate firstDay(year, month, 1);
-    QDate lastDay = firstDay.addMonths(1).addDays(-1);
+    QDate nextMonthFirstDay = firstDay.addMonths(1);
     
-    // 转换为ISO格式的字符串，适用于SQLite日期比较
+    // 转换为ISO格式的字符串，直接与created_at比较以使用索引
     QString startDate = firstDay.toString(Qt::ISODate);
-    QString endDate = lastDay.toString(Qt::ISODate);
+    QString endDate = nextMonthFirstDay.toString(Qt::ISODate);
     
     QSqlQuery query(m_database);
     
     // 查询当月每个用户的题目总数，并获取最大值
     query.prepare("SELECT work_id, SUM(total_questions) as total "
                  "FROM user_answer_records "
-                 "WHERE date(created_at) >= date(:startDate) "
-                 "AND date(created_at) <= date(:endDate) "
+                 "WHERE created_at >= :startDate "
+                 "AND created_at < :endDate "
                  "GROUP BY work_id "
                  "ORDER BY total DESC "
                  "LIMIT 1");
@@ -2871,9 +4213,389 @@ bool DatabaseManager::updateDatabaseSchema()
         }
     }
     
+    // 人脸识别登录记录尝试次数，用于统计首帧识别成功率
+    bool hasAttempts = false;
+    if (query.exec("PRAGMA table_info(access_logs)")) {
+        while (query.next()) {
+            if (query.value(1).toString() == "attempts") {
+                hasAttempts = true;
+            }
+        }
+    }
+    if (!hasAttempts) {
+        qDebug() << "添加attempts列到access_logs表";
+        if (!query.exec("ALTER TABLE access_logs ADD COLUMN attempts INTEGER")) {
+            qDebug() << "添加attempts列失败:" << query.lastError().text();
+        }
+    }
+    
+    // 人脸特征模板来源和提取特征的识别后端
+    bool hasSource = false;
+    bool hasBackend = false;
+    if (query.exec("PRAGMA table_info(face_features)")) {
+        while (query.next()) {
+            if (query.value(1).toString() == "source") {
+                hasSource = true;
+            } else if (query.value(1).toString() == "backend") {
+                hasBackend = true;
+            }
+        }
+    }
+    if (!hasSource) {
+        qDebug() << "添加source列到face_features表";
+        if (!query.exec("ALTER TABLE face_features ADD COLUMN source TEXT DEFAULT 'enrol'")) {
+            qDebug() << "添加source列失败:" << query.lastError().text();
+        }
+    }
+    if (!hasBackend) {
+        // 此前只有SeetaFace2后端
+        qDebug() << "添加backend列到face_features表";
+        if (!query.exec("ALTER TABLE face_features ADD COLUMN backend TEXT DEFAULT 'seeta'")) {
+            qDebug() << "添加backend列失败:" << query.lastError().text();
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * 创建热点查询使用的二级索引
+ * 使用CREATE INDEX IF NOT EXISTS，对已有数据库可重复执行，作为架构迁移的一部分
+ * @return 是否全部创建成功
+ */
+bool DatabaseManager::createIndexes()
+{
+    if (!m_database.isOpen()) {
+        qDebug() << "数据库未打开，无法创建索引";
+        return false;
+    }
+    
+    QStringList statements;
+    // 统计函数按work_id + created_at范围过滤，附带total_questions和correct_count使SUM查询可走覆盖索引
+    statements << "CREATE INDEX IF NOT EXISTS idx_answer_records_work_created "
+                  "ON user_answer_records(work_id, created_at, total_questions, correct_count)";
+    // getAllAnswerRecords按时间倒序分页、getMaxMonthlyQuestionCount按时间范围汇总所有用户
+    statements << "CREATE INDEX IF NOT EXISTS idx_answer_records_created "
+                  "ON user_answer_records(created_at)";
+    // 错题集按(work_id, bank_id)读取和删除，question_id放在末尾使查询可走覆盖索引
+    statements << "CREATE INDEX IF NOT EXISTS idx_wrong_questions_work_bank "
+                  "ON user_wrong_questions(work_id, bank_id, question_id)";
+    // getQuestionsByBankId、getRandomQuestions按题库过滤题目
+    statements << "CREATE INDEX IF NOT EXISTS idx_questions_bank "
+                  "ON questions(bank_id)";
+    // 选项按question_id关联并按option_index排序
+    statements << "CREATE INDEX IF NOT EXISTS idx_question_options_question "
+                  "ON question_options(question_id, option_index)";
+    // 访问日志按时间倒序分页及cleanupOldLogs按时间删除
+    statements << "CREATE INDEX IF NOT EXISTS idx_access_logs_time "
+                  "ON access_logs(access_time)";
+    // 按用户查询访问日志
+    statements << "CREATE INDEX IF NOT EXISTS idx_access_logs_work_time "
+                  "ON access_logs(work_id, access_time)";
+    // 人脸特征按用户读取、替换和删除
+    statements << "CREATE INDEX IF NOT EXISTS idx_face_features_work "
+                  "ON face_features(work_id)";
+    
+    QSqlQuery query(m_database);
+    bool allSucceeded = true;
+    
+    for (const QString &statement : statements) {
+        if (!query.exec(statement)) {
+            qDebug() << "创建索引失败:" << query.lastError().text() << "SQL:" << statement;
+            allSucceeded = false;
+            // 继续执行，尝试创建下一个索引
+        }
+    }
+    
+    return allSucceeded;
+}
+
+/**
+ * 将旧版本以JSON文本保存的答题数据转换为CBOR编码
+ * 只处理typeof为text的行，完成后写入answer_data_encoding设置，之后启动不再扫描
+ * @return 是否转换成功
+ */
+bool DatabaseManager::migrateAnswerDataEncoding()
+{
+    if (getSetting("answer_data_encoding") == "cbor") {
+        return true;
+    }
+    
+    struct EncodedColumn {
+        QString table;
+        QString keyColumn;
+        QString dataColumn;
+    };
+    const QList<EncodedColumn> columns = {
+        { "user_answer_records", "id", "answer_data" },
+        { "user_bank_progress", "id", "user_answers" }
+    };
+    
+    if (!m_database.transaction()) {
+        qDebug() << "开始答题数据转换事务失败:" << m_database.lastError().text();
+        return false;
+    }
+    
+    int convertedCount = 0;
+    for (const EncodedColumn &column : columns) {
+        QSqlQuery selectQuery(m_database);
+        QString selectSql = QString("SELECT %1, %2 FROM %3 WHERE typeof(%2) = 'text'")
+                                .arg(column.keyColumn, column.dataColumn, column.table);
+        if (!selectQuery.exec(selectSql)) {
+            qDebug() << "读取待转换答题数据失败:" << selectQuery.lastError().text();
+            m_database.rollback();
+            return false;
+        }
+        
+        QSqlQuery updateQuery(m_database);
+        updateQuery.prepare(QString("UPDATE %1 SET %2 = ? WHERE %3 = ?")
+                                .arg(column.table, column.dataColumn, column.keyColumn));
+        
+        while (selectQuery.next()) {
+            QByteArray encoded = AnswerDataCodec::encode(selectQuery.value(1).toString());
+            if (encoded.isEmpty()) {
+                // 无法解析的数据保持原样，读取时按文本返回
+                continue;
+            }
+            
+            updateQuery.addBindValue(encoded);
+            updateQuery.addBindValue(selectQuery.value(0));
+            if (!updateQuery.exec()) {
+                qDebug() << "转换答题数据失败:" << updateQuery.lastError().text();
+                m_database.rollback();
+                return false;
+            }
+            convertedCount++;
+        }
+    }
+    
+    if (!m_database.commit()) {
+        qDebug() << "提交答题数据转换失败:" << m_database.lastError().text();
+        m_database.rollback();
+        return false;
+    }
+    
+    setSetting("answer_data_encoding", "cbor");
+    qDebug() << "答题数据已转换为CBOR编码，共" << convertedCount << "条";
+    return true;
+}
+
+/**
+ * 将一条答题记录中答错的题目累加到user_record_wrong_questions
+ * 题库优先取答题数据中的bankId，其次取question_bank_info中的{题目ID: 题库ID}映射，都没有时按questions表查询
+ * 调用方负责事务
+ * @return 是否写入成功
+ */
+bool DatabaseManager::accumulateRecordWrongQuestions(const QString &workId,
+                                                     const QVariant &answerData,
+                                                     const QString &questionBankInfo)
+{
+    QList<AnswerDataCodec::Entry> wrongEntries;
+    const QList<AnswerDataCodec::Entry> entries = AnswerDataCodec::entries(answerData);
+    for (const AnswerDataCodec::Entry &entry : entries) {
+        if (!entry.correct) {
+            wrongEntries.append(entry);
+        }
+    }
+    
+    if (wrongEntries.isEmpty()) {
+        return true;
+    }
+    
+    // 顺序练习记录的题库信息为JSON对象，星火日课为统计文本（解析失败时忽略）
+    QJsonObject bankInfo = QJsonDocument::fromJson(questionBankInfo.toUtf8()).object();
+    
+    QSqlQuery upsertQuery(m_database);
+    upsertQuery.prepare(
+        "INSERT INTO user_record_wrong_questions (work_id, bank_id, question_id, wrong_count, last_wrong_at) "
+        "VALUES (?, ?, ?, 1, CURRENT_TIMESTAMP) "
+        "ON CONFLICT(work_id, bank_id, question_id) DO UPDATE SET "
+        "wrong_count = wrong_count + 1, last_wrong_at = CURRENT_TIMESTAMP"
+    );
+    
+    QSqlQuery lookupUpsertQuery(m_database);
+    lookupUpsertQuery.prepare(
+        "INSERT INTO user_record_wrong_questions (work_id, bank_id, question_id, wrong_count, last_wrong_at) "
+        "SELECT ?, bank_id, id, 1, CURRENT_TIMESTAMP FROM questions WHERE id = ? "
+        "ON CONFLICT(work_id, bank_id, question_id) DO UPDATE SET "
+        "wrong_count = wrong_count + 1, last_wrong_at = CURRENT_TIMESTAMP"
+    );
+    
+    for (const AnswerDataCodec::Entry &entry : wrongEntries) {
+        int bankId = entry.bankId;
+        if (bankId < 0) {
+            bool ok = false;
+            int mappedBankId = bankInfo.value(QString::number(entry.questionId)).toVariant().toInt(&ok);
+            if (ok) {
+                bankId = mappedBankId;
+            }
+        }
+        
+        QSqlQuery &query = bankId < 0 ? lookupUpsertQuery : upsertQuery;
+        query.addBindValue(workId);
+        if (bankId >= 0) {
+            query.addBindValue(bankId);
+        }
+        query.addBindValue(entry.questionId);
+        
+        if (!query.exec()) {
+            qDebug() << "更新答题记录错题汇总失败:" << query.lastError().text();
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * 清空并根据全部答题记录重建user_record_wrong_questions
+ * 仅在升级后首次启动时执行一次
+ * @return 是否重建成功
+ */
+bool DatabaseManager::rebuildRecordWrongQuestions()
+{
+    if (!m_database.transaction()) {
+        qDebug() << "开始错题汇总重建事务失败:" << m_database.lastError().text();
+        return false;
+    }
+    
+    QSqlQuery query(m_database);
+    if (!query.exec("DELETE FROM user_record_wrong_questions")) {
+        qDebug() << "清空答题记录错题汇总失败:" << query.lastError().text();
+        m_database.rollback();
+        return false;
+    }
+    
+    if (!query.exec("SELECT work_id, answer_data, question_bank_info FROM user_answer_records ORDER BY id")) {
+        qDebug() << "读取答题记录失败:" << query.lastError().text();
+        m_database.rollback();
+        return false;
+    }
+    
+    int recordCount = 0;
+    while (query.next()) {
+        if (!accumulateRecordWrongQuestions(query.value(0).toString(),
+                                            query.value(1),
+                                            query.value(2).toString())) {
+            m_database.rollback();
+            return false;
+        }
+        recordCount++;
+    }
+    
+    if (!m_database.commit()) {
+        qDebug() << "提交错题汇总重建失败:" << m_database.lastError().text();
+        m_database.rollback();
+        return false;
+    }
+    
+    qDebug() << "已根据" << recordCount << "条答题记录生成错题汇总";
     return true;
 }
 
+/**
+ * 对热点查询执行EXPLAIN QUERY PLAN，检查是否命中预期索引
+ * 用于防止查询改写（例如对列套用date()）导致索引失效的回归
+ * @return 每条查询的检查结果列表，包含name、expectedIndex、plan、usesIndex字段
+ */
+QVariantList DatabaseManager::checkHotQueryPlans()
+{
+    PERF_TRACE_METHOD();
+    QVariantList result;
+    
+    if (!m_database.isOpen()) {
+        qDebug() << "数据库未打开，无法检查查询计划";
+        return result;
+    }
+    
+    struct HotQuery {
+        QString name;
+        QString expectedIndex;
+        QString sql;
+        int paramCount;
+    };
+    
+    // 与各业务函数中的查询保持相同的WHERE/ORDER BY结构，参数值不影响查询计划
+    const QList<HotQuery> hotQueries = {
+        {"getUserCurrentMonthQuestionCount", "idx_answer_records_work_created",
+         "SELECT SUM(total_questions) FROM user_answer_records "
+         "WHERE work_id = ? AND created_at >= ? AND created_at < ?", 3},
+        {"getUserMonthlyPracticeData", "idx_answer_records_work_created",
+         "SELECT COUNT(*), SUM(correct_count), SUM(total_questions) FROM user_answer_records "
+         "WHERE work_id = ? AND created_at >= ? AND created_at < ?", 3},
+        {"getUserRollingYearQuestionData", "idx_answer_records_work_created",
+         "SELECT strftime('%Y-%m', created_at) as yearMonth, SUM(total_questions) FROM user_answer_records "
+         "WHERE work_id = ? AND created_at >= ? AND created_at < ? GROUP BY yearMonth ORDER BY yearMonth", 3},
+        {"getUserPentagonData", "idx_answer_records_work_created",
+         "SELECT pentagon_type FROM user_answer_records "
+         "WHERE work_id = ? AND created_at >= ? AND created_at < ?", 3},
+        {"getMaxMonthlyQuestionCount", "idx_answer_records_created",
+         "SELECT work_id, SUM(total_questions) as total FROM user_answer_records "
+         "WHERE created_at >= ? AND created_at < ? GROUP BY work_id ORDER BY total DESC LIMIT 1", 2},
+        {"getUserAnswerRecords", "idx_answer_records_work_created",
+         "SELECT * FROM user_answer_records WHERE work_id = ? "
+         "ORDER BY created_at DESC LIMIT ? OFFSET ?", 3},
+        {"getQuestionsByBankId", "idx_questions_bank",
+         "SELECT * FROM questions WHERE bank_id = ? ORDER BY id", 1},
+        {"getQuestionOptions", "idx_question_options_question",
+         "SELECT * FROM question_options WHERE question_id = ? ORDER BY option_index", 1},
+        {"getRandomQuestions", "idx_question_options_question",
+         "SELECT q.*, GROUP_CONCAT(o.option_text, '|') as options FROM questions q "
+         "LEFT JOIN question_options o ON q.id = o.question_id "
+         "WHERE q.bank_id = ? GROUP BY q.id ORDER BY RANDOM() LIMIT ?", 2},
+        {"getUserWrongQuestionIds", "idx_wrong_questions_work_bank",
+         "SELECT question_id FROM user_wrong_questions WHERE work_id = ? AND bank_id = ?", 2},
+        {"cleanupOldLogs", "idx_access_logs_time",
+         "DELETE FROM access_logs WHERE access_time < ?", 1},
+        {"getAccessLogs", "idx_access_logs_time",
+         "SELECT al.*, u.name FROM access_logs al LEFT JOIN users u ON al.work_id = u.work_id "
+         "ORDER BY al.access_time DESC LIMIT ? OFFSET ?", 2},
+        {"getAccessLogsByUser", "idx_access_logs_work_time",
+         "SELECT al.*, u.name FROM access_logs al LEFT JOIN users u ON al.work_id = u.work_id "
+         "WHERE al.work_id = ? ORDER BY al.access_time DESC LIMIT ? OFFSET ?", 3}
+    };
+    
+    int missCount = 0;
+    
+    for (const HotQuery &hotQuery : hotQueries) {
+        QSqlQuery query(m_database);
+        query.prepare("EXPLAIN QUERY PLAN " + hotQuery.sql);
+        for (int i = 0; i < hotQuery.paramCount; ++i) {
+            query.bindValue(i, QVariant());
+        }
+        
+        QStringList planLines;
+        if (query.exec()) {
+            while (query.next()) {
+                // EXPLAIN QUERY PLAN 的第4列(detail)为计划描述
+                planLines.append(query.value(3).toString());
+            }
+        } else {
+            planLines.append("EXPLAIN失败: " + query.lastError().text());
+        }
+        
+        QString plan = planLines.join(" | ");
+        bool usesIndex = plan.contains(hotQuery.expectedIndex);
+        
+        QVariantMap row;
+        row["name"] = hotQuery.name;
+        row["expectedIndex"] = hotQuery.expectedIndex;
+        row["plan"] = plan;
+        row["usesIndex"] = usesIndex;
+        result.append(row);
+        
+        if (!usesIndex) {
+            missCount++;
+            qWarning() << "热点查询未命中索引:" << hotQuery.name
+                       << "预期索引:" << hotQuery.expectedIndex << "实际计划:" << plan;
+        }
+    }
+    
+    qDebug() << "热点查询计划检查完成，共" << hotQueries.size() << "条，未命中索引" << missCount << "条";
+    PERF_TRACE_ROWS(result.size());
+    return result;
+}
+
 /**
  * 获取用户的五芒图数据（当月、上月、上上月）
  * @param workId 用户工号
@@ -2881,6 +4603,7 @@ bool DatabaseManager::updateDatabaseSchema()
  */
 QVariantMap DatabaseManager::getUserPentagonData(const QString &workId)
 {
+    PERF_TRACE_METHOD();
     QVariantMap result;
     
     // 初始化结果结构
@@ -2905,11 +4628,11 @@ QVariantMap DatabaseManager::getUserPentagonData(const QString &workId)
         int year = targetDate.year();
         int month = targetDate.month();
         
-        // 获取月份的第一天和最后一天
+        // 获取月份的第一天和下月第一天，构成半开区间
         QDate firstDay(year, month, 1);
-        QDate lastDay = firstDay.addMonths(1).addDays(-1);
+        QDate nextMonthFirstDay = firstDay.addMonths(1);
         
-        dateRanges.append(qMakePair(firstDay, lastDay));
+        dateRanges.append(qMakePair(firstDay, nextMonthFirstDay));
     }
     
     // 五芒图的维度类型列表
@@ -2934,19 +4657,19 @@ QVariantMap DatabaseManager::getUserPentagonData(const QString &workId)
     // 从数据库查询每个月的记录
     for (int i = 0; i < dateRanges.size(); ++i) {
         QDate firstDay = dateRanges[i].first;
-        QDate lastDay = dateRanges[i].second;
+        QDate nextMonthFirstDay = dateRanges[i].second;
         
         // 转换为ISO格式的字符串
         QString startDate = firstDay.toString(Qt::ISODate);
-        QString endDate = lastDay.toString(Qt::ISODate);
+        QString endDate = nextMonthFirstDay.toString(Qt::ISODate);
         
         QSqlQuery query(m_database);
         
         // 查询该用户在指定月份的所有答题记录
         query.prepare("SELECT pentagon_type FROM user_answer_records "
                      "WHERE work_id = :workId "
-                     "AND date(created_at) >= date(:startDate) "
-                     "AND date(created_at) <= date(:endDate)");
+                     "AND created_at >= :startDate "
+                     "AND created_at < :endDate");
         
         query.bindValue(":workId", workId);
         query.bindValue(":startDate", startDate);
@@ -3071,6 +4794,7 @@ bool DatabaseManager::saveUserBankProgress(const QString &workId, int bankId,
                                          int currentQuestionIndex, 
                                          const QString &userAnswersJson)
 {
+    PERF_TRACE_METHOD();
     if (!m_database.isOpen()) {
         qDebug() << "保存用户题库进度失败: 数据库未打开";
         return false;
@@ -3093,7 +4817,13 @@ bool DatabaseManager::saveUserBankProgress(const QString &workId, int bankId,
     query.bindValue(0, workId);
     query.bindValue(1, bankId);
     query.bindValue(2, currentQuestionIndex);
-    query.bindValue(3, userAnswersJson);
+    // 作答情况以CBOR编码存储，无法解析的JSON原样保存
+    QByteArray encodedAnswers = AnswerDataCodec::encode(userAnswersJson);
+    if (encodedAnswers.isEmpty()) {
+        query.bindValue(3, userAnswersJson);
+    } else {
+        query.bindValue(3, encodedAnswers);
+    }
     
     bool success = query.exec();
     
@@ -3109,6 +4839,7 @@ bool DatabaseManager::saveUserBankProgress(const QString &workId, int bankId,
 // 获取用户题库进度
 QVariantMap DatabaseManager::getUserBankProgress(const QString &workId, int bankId)
 {
+    PERF_TRACE_METHOD();
     QVariantMap result;
     
     if (!m_database.isOpen()) {
@@ -3136,7 +4867,9 @@ QVariantMap DatabaseManager::getUserBankProgress(const QString &workId, int bank
     
     if (query.next()) {
         result["currentQuestionIndex"] = query.value(0).toInt();
-        result["userAnswers"] = query.value(1).toString();
+        result["userAnswers"] = AnswerDataCodec::toJson(query.value(1));
+        result["answeredQuestionIds"] = AnswerDataCodec::answeredIds(query.value(1));
+        result["wrongQuestionIds"] = AnswerDataCodec::wrongIds(query.value(1));
         result["hasProgress"] = true;
     } else {
         // 没有找到进度记录
@@ -3147,17 +4880,36 @@ QVariantMap DatabaseManager::getUserBankProgress(const QString &workId, int bank
 }
 
 // 更新用户错题集
-bool DatabaseManager::updateUserWrongQuestions(const QString &workId, int bankId, 
-                                             const QVariantList &wrongQuestionIds)
+// 采用集合差分：只插入新增的错题、只删除已移除的错题，保存开销与变化量成正比
+QVariantMap DatabaseManager::updateUserWrongQuestions(const QString &workId, int bankId, 
+                                                    const QVariantList &wrongQuestionIds)
 {
+    PERF_TRACE_METHOD();
+    QVariantMap result;
+    result["success"] = false;
+    result["insertedCount"] = 0;
+    result["deletedCount"] = 0;
+    result["totalCount"] = 0;
+    
     if (!m_database.isOpen()) {
         qDebug() << "更新用户错题集失败: 数据库未打开";
-        return false;
+        return result;
     }
     
     if (workId.isEmpty()) {
         qDebug() << "更新用户错题集失败: 用户ID为空";
-        return false;
+        return result;
+    }
+    
+    // 目标错题集合，保持传入顺序以便按顺序插入
+    QList<int> targetIds;
+    QSet<int> targetSet;
+    for (const QVariant &questionIdVar : wrongQuestionIds) {
+        int questionId = questionIdVar.toInt();
+        if (!targetSet.contains(questionId)) {
+            targetSet.insert(questionId);
+            targetIds.append(questionId);
+        }
     }
     
     // 开始事务
@@ -3165,67 +4917,119 @@ bool DatabaseManager::updateUserWrongQuestions(const QString &workId, int bankId
     
     QSqlQuery query(m_database);
     
-    // 先删除该用户在该题库的所有错题记录
+    // 读取现有错题集（走idx_wrong_questions_work_bank覆盖索引）
     query.prepare(
-        "DELETE FROM user_wrong_questions "
+        "SELECT question_id "
+        "FROM user_wrong_questions "
         "WHERE work_id = ? AND bank_id = ?"
     );
     
     query.bindValue(0, workId);
     query.bindValue(1, bankId);
     
-    bool success = query.exec();
-    
-    if (!success) {
-        qDebug() << "删除旧错题记录失败:" << query.lastError().text();
+    if (!query.exec()) {
+        qDebug() << "读取现有错题记录失败:" << query.lastError().text();
         m_database.rollback();
-        return false;
+        return result;
+    }
+    
+    QSet<int> existingSet;
+    while (query.next()) {
+        existingSet.insert(query.value(0).toInt());
+    }
+    
+    // 计算需要删除和需要插入的题目ID
+    QList<int> idsToDelete;
+    for (int questionId : existingSet) {
+        if (!targetSet.contains(questionId)) {
+            idsToDelete.append(questionId);
+        }
+    }
+    
+    QList<int> idsToInsert;
+    for (int questionId : targetIds) {
+        if (!existingSet.contains(questionId)) {
+            idsToInsert.append(questionId);
+        }
+    }
+    
+    // 分批删除已移除的错题，每批使用一条 IN (...) 语句
+    const int deleteBatchSize = 500;
+    for (int start = 0; start < idsToDelete.size(); start += deleteBatchSize) {
+        QList<int> batch = idsToDelete.mid(start, deleteBatchSize);
+        
+        QStringList placeholders;
+        for (int i = 0; i < batch.size(); ++i) {
+            placeholders.append("?");
+        }
+        
+        query.prepare(
+            "DELETE FROM user_wrong_questions "
+            "WHERE work_id = ? AND bank_id = ? AND question_id IN (" + placeholders.join(", ") + ")"
+        );
+        query.addBindValue(workId);
+        query.addBindValue(bankId);
+        for (int questionId : batch) {
+            query.addBindValue(questionId);
+        }
+        
+        if (!query.exec()) {
+            qDebug() << "删除错题记录失败:" << query.lastError().text();
+            m_database.rollback();
+            return result;
+        }
     }
     
-    // 如果有新的错题记录，则插入
-    if (!wrongQuestionIds.isEmpty()) {
-        // 插入新的错题记录
+    // 分批插入新增的错题，每批使用一条多行 INSERT 语句（每行3个参数）
+    const int insertBatchSize = 300;
+    for (int start = 0; start < idsToInsert.size(); start += insertBatchSize) {
+        QList<int> batch = idsToInsert.mid(start, insertBatchSize);
+        
+        QStringList rows;
+        for (int i = 0; i < batch.size(); ++i) {
+            rows.append("(?, ?, ?)");
+        }
+        
         query.prepare(
             "INSERT INTO user_wrong_questions "
             "(work_id, bank_id, question_id) "
-            "VALUES (?, ?, ?)"
+            "VALUES " + rows.join(", ")
         );
-        
-        for (const QVariant &questionIdVar : wrongQuestionIds) {
-            int questionId = questionIdVar.toInt();
-            
-            query.bindValue(0, workId);
-            query.bindValue(1, bankId);
-            query.bindValue(2, questionId);
-            
-            success = query.exec();
-            
-            if (!success) {
-                qDebug() << "插入错题记录失败:" << query.lastError().text();
-                m_database.rollback();
-                return false;
-            }
+        for (int questionId : batch) {
+            query.addBindValue(workId);
+            query.addBindValue(bankId);
+            query.addBindValue(questionId);
         }
         
-        qDebug() << "成功更新用户" << workId << "题库" << bankId << "的错题集，共" << wrongQuestionIds.size() << "道题";
-    } else {
-        // 如果没有错题记录，表示清空错题集
-        qDebug() << "成功清空用户" << workId << "题库" << bankId << "的错题集";
+        if (!query.exec()) {
+            qDebug() << "插入错题记录失败:" << query.lastError().text();
+            m_database.rollback();
+            return result;
+        }
     }
     
     // 提交事务
     if (!m_database.commit()) {
         qDebug() << "提交事务失败:" << m_database.lastError().text();
         m_database.rollback();
-        return false;
+        return result;
     }
     
-    return true;
+    result["success"] = true;
+    result["insertedCount"] = idsToInsert.size();
+    result["deletedCount"] = idsToDelete.size();
+    result["totalCount"] = targetIds.size();
+    
+    qDebug() << "成功更新用户" << workId << "题库" << bankId << "的错题集，新增" << idsToInsert.size()
+             << "道，移除" << idsToDelete.size() << "道，现共" << targetIds.size() << "道题";
+    
+    return result;
 }
 
 // 获取用户错题ID列表
 QVariantList DatabaseManager::getUserWrongQuestionIds(const QString &workId, int bankId)
 {
+    PERF_TRACE_METHOD();
     QVariantList result;
     
     if (!m_database.isOpen()) {
@@ -3255,12 +5059,47 @@ QVariantList DatabaseManager::getUserWrongQuestionIds(const QString &workId, int
         result.append(query.value(0).toInt());
     }
     
+    PERF_TRACE_ROWS(result.size());
+    return result;
+}
+
+// 获取答题记录错题汇总中的错题ID
+QVariantList DatabaseManager::getRecordWrongQuestionIds(const QString &workId, int bankId)
+{
+    PERF_TRACE_METHOD();
+    QVariantList result;
+    
+    if (!m_database.isOpen()) {
+        qDebug() << "获取答题记录错题失败: 数据库未打开";
+        return result;
+    }
+    
+    QSqlQuery query(m_database);
+    query.prepare(
+        "SELECT question_id FROM user_record_wrong_questions "
+        "WHERE work_id = ? AND bank_id = ? "
+        "ORDER BY question_id"
+    );
+    query.addBindValue(workId);
+    query.addBindValue(bankId);
+    
+    if (!query.exec()) {
+        qDebug() << "查询答题记录错题失败:" << query.lastError().text();
+        return result;
+    }
+    
+    while (query.next()) {
+        result.append(query.value(0).toInt());
+    }
+    
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
 // 删除用户题库进度
 bool DatabaseManager::deleteUserBankProgress(const QString &workId, int bankId)
 {
+    PERF_TRACE_METHOD();
     if (!m_database.isOpen()) {
         qDebug() << "删除用户题库进度失败: 数据库未打开";
         return false;
@@ -3290,6 +5129,7 @@ bool DatabaseManager::deleteUserBankProgress(const QString &workId, int bankId)
 // 添加新账户
 bool DatabaseManager::addAccount(const QString &username, const QString &workId, const QString &password)
 {
+    PERF_TRACE_METHOD();
     QSqlQuery query(m_database);
     
     // 检查工号是否已存在
@@ -3323,6 +5163,7 @@ bool DatabaseManager::addAccount(const QString &username, const QString &workId,
 // 获取所有账户
 QVariantList DatabaseManager::getAllAccounts()
 {
+    PERF_TRACE_METHOD();
     QVariantList result;
     
     if (!m_database.isOpen()) {
@@ -3358,12 +5199,14 @@ QVariantList DatabaseManager::getAllAccounts()
         result.append(account);
     }
     
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
 // 删除账户
 bool DatabaseManager::deleteAccount(const QString &workId)
 {
+    PERF_TRACE_METHOD();
     if (!m_database.isOpen()) {
         qDebug() << "数据库未打开，尝试重新打开";
         if (!m_database.open()) {
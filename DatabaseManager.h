@@ -10,6 +10,18 @@
 #include <QString>
 #include <QDateTime>
 #include <QVariantList>
+#include <QHash>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QPair>
+#include <QPointer>
+#include <QCache>
+
+#include "FaceGallery.h"
+#include "HnswIndex.h"
+
+class FaceRecognizer;
+class QTimer;
 
 /**
  * @brief 数据库管理类
@@ -48,12 +60,66 @@ public:
 
     // 根据工号查询人脸数据
     Q_INVOKABLE QVariantMap getFaceDataByWorkId(const QString &workId);
+    
+    // 使用界面中的识别器（与人脸跟踪共用），识别时才能按跟踪编号复用已确认的身份；识别器由调用方管理
+    void setFaceRecognizer(FaceRecognizer *recognizer);
+    
+    // 获取所有用户的图像绝对路径，工号 -> {avatarPath, faceImagePath}
+    Q_INVOKABLE QVariantMap getUserImagePaths();
+    
+    // 用户图像的版本，每次录入、更新或删除后加一，附加在image://avatars的URL后使QML重新加载
+    Q_INVOKABLE int getUserImageVersion(const QString &workId) const;
 
     // 验证人脸（根据工号和人脸图像路径）
     Q_INVOKABLE bool verifyFace(const QString &workId, const QString &faceImagePath);
     
     // 识别人脸，在所有用户中查找匹配的人脸
+    // 同一张人脸的跟踪轨迹未中断时复用上次确认的身份（结果中cached为true），不再提取特征和比对
     Q_INVOKABLE QVariantMap recognizeFace(const QString &faceImagePath);
+    
+    /**
+     * @brief 识别一帧图像中的所有人脸（多人同时签到）
+     *
+     * 整幅图像只检测一次，各人脸的特征在推理线程上依次提取后一起与特征库比对，同一个人只分配给得分最高的人脸。
+     * 调用线程等待全部人脸提取完成，界面上逐帧签到时使用recognizeAllFacesAsync。
+     * @return faceCount、recognizedCount、imageWidth、imageHeight，以及faces：每张人脸的
+     *         x、y、width、height（原图坐标）、score、acceptable、qualityReason、qualityMessage、
+     *         recognized，识别成功时另有workId、name、similarity
+     */
+    Q_INVOKABLE QVariantMap recognizeAllFaces(const QString &frameImagePath);
+    
+    /**
+     * @brief 在推理线程上提取所有人脸的特征，回到界面线程比对后通过allFacesRecognized发出结果
+     *
+     * 推理线程正忙时丢弃本帧，界面线程不等待特征提取。
+     * @return 是否已提交
+     */
+    Q_INVOKABLE bool recognizeAllFacesAsync(const QString &frameImagePath);
+
+    /**
+     * @brief 录入前在已注册人员中查找与新人脸相似的人员，防止同一人以不同工号重复录入
+     *
+     * 只提取一次特征，随后addFaceData/mergeFaceImage保存同一图像时直接使用该特征。
+     * @param faceImagePath 新采集的人脸图像
+     * @param excludeWorkId 不参与比较的工号（更新已有人员时为其本人）
+     * @param maxResults 返回的最相似人员数量
+     * @return faceDetected、duplicate（最高相似度达到face_duplicate_threshold）、threshold、
+     *         matches（按相似度降序，每项包含workId、name、similarity）
+     */
+    Q_INVOKABLE QVariantMap findDuplicateFaces(const QString &faceImagePath,
+                                               const QString &excludeWorkId = QString(),
+                                               int maxResults = 3);
+
+    // 将新采集的人脸作为已有人员的一个特征模板，用于录入时发现重复的情况
+    Q_INVOKABLE bool mergeFaceImage(const QString &workId, const QString &faceImagePath);
+
+    /**
+     * @brief 根据访问日志统计人脸登录的尝试次数
+     * @param days 统计最近多少天
+     * @return logins（成功登录次数）、firstFrameSuccessRate（首帧即识别成功的比例）、
+     *         meanAttempts（每次登录的平均尝试次数）、maxAttempts、identities、templates（平均每人模板数）
+     */
+    Q_INVOKABLE QVariantMap getRecognitionStats(int days = 30);
 
     // 检查用户是否存在
     Q_INVOKABLE bool userExists(const QString &workId);
@@ -90,6 +156,15 @@ public:
     
     // 清除旧的访问日志（保留最近N天）
     Q_INVOKABLE bool cleanupOldLogs(int daysToKeep = 30);
+    
+    /**
+     * @brief 立即写入队列中的访问日志
+     *
+     * 验证和识别的访问日志先进入队列，每隔access_log_flush_ms（默认1000）毫秒或
+     * 积累access_log_flush_rows（默认32）条时在一个事务中写入，登录过程不等待磁盘同步。
+     * 写入失败时日志留在队列中，稍后重试。查询访问日志前和退出时自动调用。
+     */
+    void flushAccessLogs();
 
     Q_INVOKABLE QString getUserAvatarPath(const QString &workId);
     
@@ -133,6 +208,9 @@ public:
     // 获取题目详情
     Q_INVOKABLE QVariantMap getQuestionById(int questionId);
     
+    // 批量获取题目详情，结果按传入ID的顺序返回（重复ID只返回一次，不存在的ID跳过）
+    Q_INVOKABLE QVariantList getQuestionsByIds(const QVariantList &questionIds);
+    
     // 从题库中随机抽取指定数量的题目
     Q_INVOKABLE QVariantList getRandomQuestions(int bankId, int count);
     
@@ -144,6 +222,12 @@ public:
     // 获取所有智点
     Q_INVOKABLE QVariantList getAllKnowledgePoints();
     
+    // 获取所有智点ID（与getAllKnowledgePoints顺序一致）
+    Q_INVOKABLE QVariantList getKnowledgePointIds();
+    
+    // 按ID批量获取智点，结果按传入顺序返回
+    Q_INVOKABLE QVariantList getKnowledgePointsByIds(const QVariantList &pointIds);
+    
     // 添加单个智点
     Q_INVOKABLE bool addKnowledgePoint(const QString &title, const QString &content);
     
@@ -212,14 +296,17 @@ public:
     // 获取用户题库进度
     Q_INVOKABLE QVariantMap getUserBankProgress(const QString &workId, int bankId);
     
-    // 更新用户错题集
-    Q_INVOKABLE bool updateUserWrongQuestions(const QString &workId, 
-                                             int bankId,
-                                             const QVariantList &wrongQuestionIds);
+    // 更新用户错题集（按集合差分增删），返回success、insertedCount、deletedCount、totalCount
+    Q_INVOKABLE QVariantMap updateUserWrongQuestions(const QString &workId, 
+                                                    int bankId,
+                                                    const QVariantList &wrongQuestionIds);
     
     // 获取用户错题ID列表
     Q_INVOKABLE QVariantList getUserWrongQuestionIds(const QString &workId, int bankId);
     
+    // 获取从答题记录中汇总出的错题ID列表（保存答题记录时增量维护）
+    Q_INVOKABLE QVariantList getRecordWrongQuestionIds(const QString &workId, int bankId);
+    
     // 删除用户题库进度
     Q_INVOKABLE bool deleteUserBankProgress(const QString &workId, int bankId);
 
@@ -232,9 +319,173 @@ public:
     // 删除账户
     Q_INVOKABLE bool deleteAccount(const QString &workId);
 
+    // 数据库诊断相关方法
+    
+    // 检查热点查询的执行计划是否命中预期索引（在串口调试页面按需执行，不在启动时执行）
+    Q_INVOKABLE QVariantList checkHotQueryPlans();
+
+signals:
+    // 智点数据发生变化（添加、删除、导入、清空）
+    void knowledgePointsChanged();
+    
+    // 用户头像或人脸图像被录入、更新（参数为绝对路径）
+    void userImagesChanged(const QString &workId, const QString &avatarPath, const QString &faceImagePath);
+    
+    // 用户被删除
+    void userImagesRemoved(const QString &workId);
+    
+    // 异步多人识别的结果，字段与recognizeAllFaces相同
+    void allFacesRecognized(const QVariantMap &result);
+
 private:
     QSqlDatabase m_database;
     QString m_dbPath;
+    
+    // 工号 -> 图像版本
+    QHash<QString, int> m_userImageVersions;
+
+    // 人脸验证和识别共用的识别器，未注入时首次使用时创建
+    QPointer<FaceRecognizer> m_faceRecognizer;
+    FaceRecognizer *faceRecognizer();
+
+    // 1:N识别使用的特征库（只保存量化后的特征，全精度特征在face_features表中），首次识别时加载
+    // 注册人数较多时（face_index_type为hnsw，或为auto且人数达到阈值）改用HNSW索引
+    FaceGallery m_faceGallery;
+    HnswIndex m_faceIndex;
+    bool m_faceGalleryLoaded = false;
+    bool m_useFaceIndex = false;
+    bool m_faceIndexDirty = false;
+    
+    // 特征库加载时使用的后端名称，索引文件名和一致性标记都按它计算，保存索引时不再访问识别器
+    QString m_galleryBackend;
+    
+    // 加载特征库，并在后台为尚未提取特征的用户补充提取
+    bool ensureFaceGallery();
+    
+    // 补充提取：每次向推理线程提交一个用户，完成后再提交下一个，不阻塞界面，
+    // 也不长时间占用推理线程；提取完成前识别只使用已有的特征
+    QList<QPair<QString, QString>> m_pendingBackfill;   // 工号 -> 人脸图像路径
+    bool m_backfillRunning = false;
+    int m_backfillCount = 0;
+    void startFeatureBackfill();
+    void backfillNextFeature();
+    void finishFeatureBackfill(const QString &workId, const QVector<float> &feature);
+    
+    // 用录入图像重新生成用户的模板，替换已有模板（特征库未加载时只删除旧模板，加载时补充提取）
+    void refreshFaceFeature(const QString &workId, const QString &faceImagePath);
+    
+    // 一个人的一个特征模板（face_features表中的一行）
+    struct FaceTemplate {
+        qint64 id;
+        QString source;   // enrol：录入；merge：录入时合并；auto：高置信度登录后自动添加
+        QVector<float> feature;
+    };
+    
+    // 重排序用到的全精度模板（工号 -> 该人全部模板），只缓存被召回过的人，模板增删时移除该人的缓存
+    QCache<QString, QList<FaceTemplate>> m_templateCache;
+    
+    // 读取指定用户的模板，已缓存的不再查询数据库
+    QHash<QString, QList<FaceTemplate>> cachedFaceTemplates(const QStringList &workIds);
+    
+    // 特征库和索引中模板的标识：工号#模板id
+    static QString templateLabel(const QString &workId, qint64 templateId);
+    static QString templateOwner(const QString &label);
+    
+    // 召回候选模板并按人汇总全精度相似度，返回按得分降序排列的人员（workId为工号，score为综合得分）
+    QList<FaceGallery::Candidate> rankFaceCandidates(const QVector<float> &feature, int count);
+    
+    // 多个特征一起召回和重排序（一次读取所有候选人的模板），返回与features一一对应的结果，空特征对应空结果
+    QList<QList<FaceGallery::Candidate>> rankFaceCandidates(const QList<QVector<float>> &features, int count);
+    
+    // 一个人所有模板的综合得分：取最大值或平均值
+    float aggregateTemplateScore(const QVector<float> &feature, const QList<FaceTemplate> &templates, bool useMean);
+    
+    // 多人识别：检查图像并加载特征库
+    bool prepareGroupRecognition(const QString &frameImagePath);
+    
+    // 多人识别：所有人脸一起比对并分配身份，faces与probes一一对应
+    QVariantMap matchGroupFaces(QVariantList faces, const QList<QVector<float>> &probes);
+    
+    // 连续识别的尝试次数，两次尝试间隔过长时重新计数
+    int m_recognitionAttempts = 0;
+    QElapsedTimer m_lastRecognitionAttempt;
+    void countRecognitionAttempt();
+    
+    // 最近一次完整识别确认的身份及当时的跟踪轨迹
+    struct TrackedIdentity {
+        int trackId = 0;
+        float trackScore = 0.0f;
+        QString workId;
+        float similarity = 0.0f;
+        QElapsedTimer confirmed;
+    };
+    TrackedIdentity m_trackedIdentity;
+    
+    /**
+     * @brief 跟踪轨迹未中断、检测置信度稳定且未超时（face_identity_cache_ms，默认5000）时复用已确认的身份
+     * @return 是否复用，不复用时清除已记录的身份
+     */
+    bool reuseTrackedIdentity(QString &workId, float &similarity);
+    
+    // 待写入的访问日志
+    struct PendingAccessLog {
+        QString workId;
+        bool granted;
+        QVariant attempts;    // 为空时写入NULL
+        QString accessTime;
+    };
+    QList<PendingAccessLog> m_pendingAccessLogs;
+    QTimer *m_accessLogTimer = nullptr;
+    int m_accessLogFlushRows = 0;
+    int m_accessLogFlushMs = 0;
+    
+    // 写入失败时把日志放回队列前部，稍后重试
+    void retryAccessLogs(const QList<PendingAccessLog> &logs);
+    
+    // 把一条访问日志加入写入队列
+    void logAccess(const QString &workId, bool granted, const QVariant &attempts = QVariant());
+    
+    // 识别成功：记录访问日志并返回识别结果，probe不为空时用于更新登录模板
+    QVariantMap confirmRecognition(const QString &workId, float similarity, const QVector<float> &probe);
+    
+    // findDuplicateFaces提取的特征，保存同一图像时复用
+    QString m_pendingFeaturePath;
+    QDateTime m_pendingFeatureModified;
+    QVector<float> m_pendingFeature;
+    
+    // 在特征库或HNSW索引中召回候选
+    QList<QList<FaceGallery::Candidate>> searchFaceCandidates(const QList<QVector<float>> &features, int count) const;
+    
+    // 更新或移除特征库/HNSW索引中的模板
+    void setGalleryFeature(const QString &label, const QVector<float> &feature);
+    void removeGalleryFeature(const QString &label);
+    
+    // HNSW索引文件路径（与数据库文件同目录）
+    QString faceIndexPath() const;
+    
+    // face_features表当前状态的标识，用于判断索引文件是否过期
+    QString faceFeatureStamp();
+    
+    // 索引有改动时保存到文件
+    void saveFaceIndex();
+    
+    // 取出findDuplicateFaces为同一图像提取的特征，没有时重新提取
+    QVector<float> takePendingFeature(const QString &imagePath);
+    
+    // 保存一个模板并加入特征库，返回模板id，失败时返回-1
+    qint64 addFaceTemplate(const QString &workId, const QVector<float> &feature, const QString &source);
+    
+    // 删除用户的所有模板
+    void removeFaceTemplates(const QString &workId);
+    
+    // 模板数量超过上限时删除最早的非录入模板
+    void pruneFaceTemplates(const QString &workId, int maxCount);
+    
+    // 高置信度登录后，若登录图像与已有模板差异较大则作为新模板加入
+    void updateLoginTemplates(const QString &workId, const QVector<float> &feature, float similarity);
+    
+    // 读取指定用户的全部模板，为空时读取所有用户
+    QHash<QString, QList<FaceTemplate>> loadFaceTemplates(const QStringList &workIds = QStringList());
 
     // 创建表结构
     bool createTables();
@@ -244,6 +495,20 @@ private:
     
     // 更新数据库结构
     bool updateDatabaseSchema();
+    
+    // 创建热点查询使用的索引
+    bool createIndexes();
+    
+    // 将旧的JSON答题数据转换为CBOR编码
+    bool migrateAnswerDataEncoding();
+    
+    // 将一条答题记录中的错题累加到答题记录错题汇总表
+    bool accumulateRecordWrongQuestions(const QString &workId,
+                                        const QVariant &answerData,
+                                        const QString &questionBankInfo);
+    
+    // 根据已有答题记录重建答题记录错题汇总表
+    bool rebuildRecordWrongQuestions();
 };
 
 #endif // DATABASEMANAGER_H 
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "FaceBackend.h"
+#include "OpenCvDnnBackend.h"
+#include "SeetaFaceBackend.h"
+#include "SeetaModelRegistry.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWeakPointer>
+
+namespace {
+
+const char *kSeetaBackend = "seeta";
+const char *kOpenCvDnnBackend = "opencv_dnn";
+
+QMutex s_mutex;
+QString s_configuredName = kSeetaBackend;
+
+// 按线程共享的OpenCV DNN后端（SeetaFace2的模型由SeetaModelRegistry管理）
+QHash<QThread *, QWeakPointer<FaceBackend>> s_dnnContexts;
+
+} // namespace
+
+void FaceBackend::setConfiguredName(const QString &name)
+{
+    QString trimmed = name.trimmed();
+    if (!names().contains(trimmed)) {
+        qDebug() << "未知的人脸识别后端，使用" << kSeetaBackend << ":" << name;
+        trimmed = kSeetaBackend;
+    }
+    QMutexLocker locker(&s_mutex);
+    s_configuredName = trimmed;
+}
+
+QString FaceBackend::configuredName()
+{
+    QMutexLocker locker(&s_mutex);
+    return s_configuredName;
+}
+
+QStringList FaceBackend::names()
+{
+    return QStringList() << kSeetaBackend << kOpenCvDnnBackend;
+}
+
+QSharedPointer<FaceBackend> FaceBackend::acquireLoaded(const QString &name, QThread *owner)
+{
+    QThread *thread = owner ? owner : QThread::currentThread();
+
+    if (name == kOpenCvDnnBackend) {
+        QMutexLocker locker(&s_mutex);
+        return s_dnnContexts.value(thread).toStrongRef();
+    }
+
+    QSharedPointer<SeetaModelRegistry::ModelSet> models = SeetaModelRegistry::instance().acquireLoaded(thread);
+    return models ? QSharedPointer<FaceBackend>(new SeetaFaceBackend(models)) : QSharedPointer<FaceBackend>();
+}
+
+QSharedPointer<FaceBackend> FaceBackend::acquire(const QString &name, const QString &modelPath, QThread *owner)
+{
+    QThread *thread = owner ? owner : QThread::currentThread();
+
+    if (name == kOpenCvDnnBackend) {
+        // DNN模型加载较快，加载期间持有锁，同一线程的并发请求等待后直接共享
+        QMutexLocker locker(&s_mutex);
+        QSharedPointer<FaceBackend> backend = s_dnnContexts.value(thread).toStrongRef();
+        if (!backend) {
+            backend = OpenCvDnnBackend::load(modelPath);
+        }
+        if (backend) {
+            s_dnnContexts.insert(thread, backend);
+            for (auto it = s_dnnContexts.begin(); it != s_dnnContexts.end();) {
+                if (it.value().isNull()) {
+                    it = s_dnnContexts.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            return backend;
+        }
+        qDebug() << "OpenCV DNN后端加载失败，退回SeetaFace2";
+    }
+
+    QSharedPointer<SeetaModelRegistry::ModelSet> models = SeetaModelRegistry::instance().acquire(modelPath, thread);
+    return models ? QSharedPointer<FaceBackend>(new SeetaFaceBackend(models)) : QSharedPointer<FaceBackend>();
+}
+
+QSharedPointer<FaceBackend> FaceBackend::create(const QString &name, const QString &modelPath)
+{
+    if (name == kOpenCvDnnBackend) {
+        return OpenCvDnnBackend::load(modelPath);
+    }
+
+    QSharedPointer<SeetaModelRegistry::ModelSet> models = SeetaModelRegistry::load(modelPath);
+    return models ? QSharedPointer<FaceBackend>(new SeetaFaceBackend(models)) : QSharedPointer<FaceBackend>();
+}
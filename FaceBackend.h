@@ -0,0 +1,87 @@
+#ifndef FACEBACKEND_H
+#define FACEBACKEND_H
+
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <opencv2/core.hpp>
+#include <vector>
+
+class QThread;
+
+/**
+ * @brief 一个检测到的人脸
+ */
+struct FaceDetection {
+    cv::Rect box;
+    float score = 0.0f;
+    // 5点特征点：左眼、右眼、鼻尖、左嘴角、右嘴角（按图像中从左到右），为空时由align补充
+    std::vector<cv::Point2f> landmarks;
+};
+
+/**
+ * @brief 人脸识别后端（检测、对齐、特征提取）
+ *
+ * 目前有两种实现：
+ *   seeta       SeetaFace2（fd_2_00 + pd_2_00_pts5 + fr_2_10，1024维特征）
+ *   opencv_dnn  OpenCV DNN在CPU上运行YuNet检测和SFace识别（128维特征）
+ * 由设置项 face_backend 选择。不同后端的特征不能互相比较，数据库中的特征按后端分别保存。
+ * similarity() 返回的得分都校准到同一尺度，face_recognition_threshold 等阈值对两种后端含义相同。
+ *
+ * 后端对象不是线程安全的，与SeetaModelRegistry相同，按线程共享。
+ */
+class FaceBackend
+{
+public:
+    virtual ~FaceBackend() = default;
+
+    /**
+     * @brief 设置使用的后端（来自设置项 face_backend），未知的名称按seeta处理
+     */
+    static void setConfiguredName(const QString &name);
+    static QString configuredName();
+
+    // 所有可用的后端名称
+    static QStringList names();
+
+    /**
+     * @brief 获取指定线程已加载的后端
+     * @param owner 使用后端的线程，为空时为当前线程
+     * @return 后端，该线程尚未加载时返回空
+     */
+    static QSharedPointer<FaceBackend> acquireLoaded(const QString &name, QThread *owner = nullptr);
+
+    /**
+     * @brief 获取指定线程的后端，尚未加载时从模型目录加载
+     *
+     * 指定的后端加载失败时退回seeta，调用方应以返回对象的name()为准。
+     * @param owner 使用后端的线程，为空时为当前线程
+     * @return 后端，加载失败时返回空
+     */
+    static QSharedPointer<FaceBackend> acquire(const QString &name, const QString &modelPath, QThread *owner = nullptr);
+
+    /**
+     * @brief 加载一个不与其他对象共享的后端（用于基准测试）
+     */
+    static QSharedPointer<FaceBackend> create(const QString &name, const QString &modelPath);
+
+    virtual QString name() const = 0;
+    virtual QString modelPath() const = 0;
+
+    // 检测图像中的所有人脸（BGR或灰度图），坐标为整幅图像坐标
+    virtual std::vector<FaceDetection> detect(const cv::Mat &image) = 0;
+
+    // 补充人脸的5点特征点，已有特征点时直接返回
+    virtual bool align(const cv::Mat &image, FaceDetection &face) = 0;
+
+    // 提取已对齐人脸的特征向量，失败时为空
+    virtual QVector<float> embed(const cv::Mat &image, const FaceDetection &face) = 0;
+
+    // 两个特征向量的相似度，范围0-1
+    virtual float similarity(const QVector<float> &feature1, const QVector<float> &feature2) const = 0;
+
+    virtual int featureSize() const = 0;
+};
+
+#endif // FACEBACKEND_H
@@ -5,6 +5,7 @@ import QtMultimedia
 import QtQuick.Dialogs
 import Qt5Compat.GraphicalEffects
 import QtCore
+import PagedListModels 1.0
 
 Rectangle {
     color: "transparent" 
@@ -13,8 +14,8 @@ Rectangle {
     // 添加信号，用于通知主窗口用户列表已更新
     signal userListUpdated()
 
-    // 创建一个ListModel来存储采集的人脸数据
-    ListModel {
+    // 人脸数据分页模型，ListView滚动时按页从数据库读取
+    FaceDataListModel {
         id: faceCollectionModel
     }
 
@@ -262,33 +263,8 @@ Rectangle {
 
     // 从数据库加载人脸数据的函数
     function loadFaceDataFromDatabase() {
-        // 清空现有模型
-        faceCollectionModel.clear();
-        
-        // 从数据库获取所有人脸数据
-        var faceList = dbManager.getAllFaceData();
-        console.log("从数据库获取到 " + faceList.length + " 条人脸数据");
-        
-        // 将数据添加到模型中
-        for (var i = 0; i < faceList.length; i++) {
-            var face = faceList[i];
-            
-            // 处理头像和人脸图像路径
-            var processedFaceImage = face.faceImage;
-            var processedAvatarPath = face.avatarPath;
-            
-            console.log("原始人脸图像路径: " + processedFaceImage);
-            console.log("原始头像路径: " + processedAvatarPath);
-            
-            faceCollectionModel.append({
-                "name": face.name,
-                "gender": face.gender,
-                "workId": face.workId,
-                "faceImage": processedFaceImage,
-                "avatarPath": processedAvatarPath,
-                "isAdmin": face.isAdmin
-            });
-        }
+        // 清空已加载的数据，ListView会按需重新分页加载
+        faceCollectionModel.reload();
     }
 
     Button {
@@ -1161,7 +1137,8 @@ Rectangle {
                                 anchors.centerIn: parent
                                 width: 40
                                 height: 40
-                                source: faceImage ? processImagePath(faceImage) : ""
+                                source: faceImage ? "image://avatars/face/" + workId + "?v=" + dbManager.getUserImageVersion(workId) : ""
+                                sourceSize: Qt.size(80, 80)
                                 fillMode: Image.PreserveAspectFit
                                 
                                 onStatusChanged: {
@@ -1182,7 +1159,8 @@ Rectangle {
                                 anchors.centerIn: parent
                                 width: 40
                                 height: 40
-                                source: avatarPath ? processImagePath(avatarPath) : ""
+                                source: avatarPath ? "image://avatars/" + workId + "?v=" + dbManager.getUserImageVersion(workId) : ""
+                                sourceSize: Qt.size(80, 80)
                                 fillMode: Image.PreserveAspectFit
                                 
                                 onStatusChanged: {
@@ -1488,6 +1466,26 @@ Rectangle {
         var faceImagePath = facesDir + "/" + nameInput.text + "_" + workIdInput.text + ".jpg";
         captureCanvas.save(faceImagePath);
         
+        // 在已注册人员中查找相似人脸，避免同一人以不同工号重复录入
+        var duplicateResult = dbManager.findDuplicateFaces(faceImagePath);
+        if (!duplicateResult.faceDetected) {
+            messageText.text = "照片中未检测到人脸，请重新拍照";
+            messagePopup.open();
+            return;
+        }
+        if (duplicateResult.duplicate) {
+            duplicateDialog.show(duplicateResult.matches, faceImagePath);
+            return;
+        }
+        
+        commitFaceData(faceImagePath);
+    }
+    
+    // 保存头像并写入数据库
+    function commitFaceData(faceImagePath) {
+        var appDir = fileManager.getApplicationDir();
+        var avatarsDir = appDir + "/avatarimages";
+        
         // 复制头像图片
         var avatarImagePath = avatarsDir + "/" + nameInput.text + "_" + workIdInput.text + ".jpg";
         fileManager.copyFile(avatarPathInput.filePath, avatarImagePath);
@@ -1531,6 +1529,177 @@ Rectangle {
         userListUpdated();
     }
 
+    // 将新采集的人脸合并到已有人员
+    function mergeFaceData(workId, name, faceImagePath) {
+        if (!dbManager.mergeFaceImage(workId, faceImagePath)) {
+            messageText.text = "更新已有人员的人脸失败！";
+            messagePopup.open();
+            return;
+        }
+        
+        console.log("人脸已合并到已有人员: " + name + " (" + workId + ")");
+        loadFaceDataFromDatabase();
+        
+        messageText.text = "已更新 " + name + "（工号 " + workId + "）的人脸数据";
+        messagePopup.open();
+        
+        cameraPopup.close();
+        userListUpdated();
+    }
+
+    // 重复人脸对话框前的半透明遮罩层
+    Rectangle {
+        anchors.fill: parent
+        color: "#80000000"
+        visible: duplicateDialog.visible
+        z: 103
+
+        MouseArea {
+            anchors.fill: parent
+        }
+    }
+
+    // 录入时发现与已有人员相似的对话框：取消录入或合并到已有人员
+    Rectangle {
+        id: duplicateDialog
+        anchors.centerIn: parent
+        width: 460
+        height: 300
+        visible: false
+        z: 104
+
+        property var matches: []
+        property string faceImagePath: ""
+
+        function show(matchList, imagePath) {
+            matches = matchList
+            faceImagePath = imagePath
+            visible = true
+        }
+
+        function close() {
+            visible = false
+        }
+
+        Keys.onEscapePressed: {
+            duplicateDialog.close()
+        }
+
+        color: "#1e293b"
+        radius: 10
+        border.color: "#334155"
+        border.width: 2
+
+        Item {
+            anchors.fill: parent
+
+            Rectangle {
+                id: duplicateHeader
+                width: parent.width
+                height: 50
+                color: "#334155"
+                radius: 8
+                anchors.top: parent.top
+
+                Text {
+                    text: "疑似重复录入"
+                    font.family: "阿里妈妈数黑体"
+                    font.pixelSize: 20
+                    font.bold: true
+                    color: "white"
+                    anchors.centerIn: parent
+                }
+            }
+
+            Text {
+                width: parent.width - 40
+                anchors.top: duplicateHeader.bottom
+                anchors.topMargin: 20
+                anchors.horizontalCenter: parent.horizontalCenter
+                text: {
+                    var lines = ["该人脸与以下已录入人员相似："]
+                    for (var i = 0; i < duplicateDialog.matches.length; i++) {
+                        var match = duplicateDialog.matches[i]
+                        lines.push(match.name + "（工号 " + match.workId + "）相似度 "
+                                   + (match.similarity * 100).toFixed(1) + "%")
+                    }
+                    return lines.join("\n")
+                }
+                font.family: "阿里妈妈数黑体"
+                font.pixelSize: 16
+                color: "#f0f9ff"
+                wrapMode: Text.Wrap
+                horizontalAlignment: Text.AlignHCenter
+                lineHeight: 1.3
+            }
+
+            Rectangle {
+                width: parent.width
+                height: 70
+                color: "transparent"
+                anchors.bottom: parent.bottom
+
+                Row {
+                    anchors.centerIn: parent
+                    spacing: 30
+
+                    // 取消录入
+                    Button {
+                        width: 140
+                        height: 40
+                        background: Rectangle {
+                            radius: 6
+                            gradient: Gradient {
+                                GradientStop { position: 0.0; color: "#64748b" }
+                                GradientStop { position: 1.0; color: "#475569" }
+                            }
+                        }
+                        contentItem: Text {
+                            text: "取消录入"
+                            font.family: "阿里妈妈数黑体"
+                            font.pixelSize: 16
+                            color: "white"
+                            horizontalAlignment: Text.AlignHCenter
+                            verticalAlignment: Text.AlignVCenter
+                        }
+                        onClicked: {
+                            duplicateDialog.close()
+                            messageText.text = "该人员已录入，本次录入已取消"
+                            messagePopup.open()
+                        }
+                    }
+
+                    // 合并到最相似的已有人员
+                    Button {
+                        width: 160
+                        height: 40
+                        background: Rectangle {
+                            radius: 6
+                            gradient: Gradient {
+                                GradientStop { position: 0.0; color: "#0891b2" }
+                                GradientStop { position: 1.0; color: "#0e7490" }
+                            }
+                        }
+                        contentItem: Text {
+                            text: "合并到已有人员"
+                            font.family: "阿里妈妈数黑体"
+                            font.pixelSize: 16
+                            font.bold: true
+                            color: "white"
+                            horizontalAlignment: Text.AlignHCenter
+                            verticalAlignment: Text.AlignVCenter
+                        }
+                        onClicked: {
+                            var match = duplicateDialog.matches[0]
+                            duplicateDialog.close()
+                            mergeFaceData(match.workId, match.name, duplicateDialog.faceImagePath)
+                        }
+                    }
+                }
+            }
+        }
+    }
+
     // 确认对话框前的半透明遮罩层
     Rectangle {
         id: confirmModalOverlay
@@ -0,0 +1,408 @@
+#include "FaceGallery.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FACEGALLERY_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+FaceGallery::FaceGallery()
+    : m_quantization(Int8)
+    , m_dimension(0)
+{
+}
+
+FaceGallery::Quantization FaceGallery::quantizationFromString(const QString &name)
+{
+    QString lower = name.trimmed().toLower();
+    if (lower == "none" || lower == "float" || lower == "fp32") {
+        return NoQuantization;
+    }
+    if (lower == "fp16" || lower == "float16") {
+        return Float16;
+    }
+    return Int8;
+}
+
+QString FaceGallery::quantizationName(Quantization quantization)
+{
+    switch (quantization) {
+    case NoQuantization:
+        return "none";
+    case Float16:
+        return "fp16";
+    case Int8:
+    default:
+        return "int8";
+    }
+}
+
+void FaceGallery::setQuantization(Quantization quantization)
+{
+    m_quantization = quantization;
+    clear();
+}
+
+void FaceGallery::clear()
+{
+    m_dimension = 0;
+    m_workIds.clear();
+    m_rows.clear();
+    m_float.clear();
+    m_int8.clear();
+    m_int8Scales.clear();
+    m_float16.clear();
+}
+
+void FaceGallery::setFeature(const QString &workId, const QVector<float> &feature)
+{
+    if (feature.isEmpty()) {
+        return;
+    }
+
+    if (m_dimension == 0) {
+        m_dimension = feature.size();
+    } else if (feature.size() != m_dimension) {
+        qDebug() << "特征维度不一致，忽略:" << workId << feature.size() << "期望" << m_dimension;
+        return;
+    }
+
+    QVector<float> unit = normalized(feature);
+
+    int row = m_rows.value(workId, -1);
+    if (row < 0) {
+        row = m_workIds.size();
+        m_workIds.append(workId);
+        m_rows.insert(workId, row);
+
+        switch (m_quantization) {
+        case NoQuantization:
+            m_float.resize((row + 1) * m_dimension);
+            break;
+        case Int8:
+            m_int8.resize((row + 1) * m_dimension);
+            m_int8Scales.resize(row + 1);
+            break;
+        case Float16:
+            m_float16.resize((row + 1) * m_dimension);
+            break;
+        }
+    }
+
+    encodeRow(row, unit.constData());
+}
+
+void FaceGallery::removeFeature(const QString &workId)
+{
+    int row = m_rows.value(workId, -1);
+    if (row < 0) {
+        return;
+    }
+
+    // 用最后一行填补被删除的行
+    int last = m_workIds.size() - 1;
+    if (row != last) {
+        QString lastWorkId = m_workIds[last];
+        m_workIds[row] = lastWorkId;
+        m_rows[lastWorkId] = row;
+
+        switch (m_quantization) {
+        case NoQuantization:
+            std::memcpy(m_float.data() + row * m_dimension, m_float.constData() + last * m_dimension,
+                        m_dimension * sizeof(float));
+            break;
+        case Int8:
+            std::memcpy(m_int8.data() + row * m_dimension, m_int8.constData() + last * m_dimension, m_dimension);
+            m_int8Scales[row] = m_int8Scales[last];
+            break;
+        case Float16:
+            std::memcpy(m_float16.data() + row * m_dimension, m_float16.constData() + last * m_dimension,
+                        m_dimension * sizeof(qfloat16));
+            break;
+        }
+    }
+
+    m_workIds.removeLast();
+    m_rows.remove(workId);
+
+    switch (m_quantization) {
+    case NoQuantization:
+        m_float.resize(last * m_dimension);
+        break;
+    case Int8:
+        m_int8.resize(last * m_dimension);
+        m_int8Scales.resize(last);
+        break;
+    case Float16:
+        m_float16.resize(last * m_dimension);
+        break;
+    }
+}
+
+QList<FaceGallery::Candidate> FaceGallery::candidates(const QVector<float> &feature, int count) const
+{
+    QList<Candidate> result;
+    if (m_workIds.isEmpty() || feature.size() != m_dimension || count <= 0) {
+        return result;
+    }
+
+    QVector<float> query = normalized(feature);
+    QVector<qint8> queryInt8;
+    float queryScale = 0.0f;
+    if (m_quantization == Int8) {
+        queryInt8.resize(m_dimension);
+        queryScale = quantizeInt8(query.constData(), m_dimension, queryInt8.data());
+    }
+
+    QVector<Candidate> scored(m_workIds.size());
+    for (int row = 0; row < m_workIds.size(); ++row) {
+        scored[row].workId = m_workIds[row];
+        scored[row].score = rowScore(row, query.constData(), queryInt8.constData(), queryScale);
+    }
+
+    int keep = qMin(count, static_cast<int>(scored.size()));
+    std::partial_sort(scored.begin(), scored.begin() + keep, scored.end(),
+                      [](const Candidate &a, const Candidate &b) { return a.score > b.score; });
+
+    result.reserve(keep);
+    for (int i = 0; i < keep; ++i) {
+        result.append(scored[i]);
+    }
+    return result;
+}
+
+qint64 FaceGallery::memoryBytes() const
+{
+    return static_cast<qint64>(m_float.size()) * sizeof(float)
+            + static_cast<qint64>(m_int8.size()) * sizeof(qint8)
+            + static_cast<qint64>(m_int8Scales.size()) * sizeof(float)
+            + static_cast<qint64>(m_float16.size()) * sizeof(qfloat16);
+}
+
+QVariantMap FaceGallery::statistics() const
+{
+    QVariantMap stats;
+    stats["count"] = size();
+    stats["dimension"] = m_dimension;
+    stats["quantization"] = quantizationName(m_quantization);
+    stats["memoryBytes"] = memoryBytes();
+    stats["fullPrecisionBytes"] = static_cast<qint64>(size()) * m_dimension * sizeof(float);
+    return stats;
+}
+
+QByteArray FaceGallery::toBlob(const QVector<float> &feature)
+{
+    return QByteArray(reinterpret_cast<const char *>(feature.constData()),
+                      feature.size() * static_cast<int>(sizeof(float)));
+}
+
+QVector<float> FaceGallery::fromBlob(const QByteArray &blob)
+{
+    QVector<float> feature(blob.size() / static_cast<int>(sizeof(float)));
+    std::memcpy(feature.data(), blob.constData(), feature.size() * sizeof(float));
+    return feature;
+}
+
+QVector<float> FaceGallery::normalized(const QVector<float> &feature)
+{
+    double norm = 0.0;
+    for (float value : feature) {
+        norm += static_cast<double>(value) * value;
+    }
+    norm = std::sqrt(norm);
+
+    QVector<float> unit(feature.size());
+    if (norm <= 0.0) {
+        return unit;
+    }
+    float inverse = static_cast<float>(1.0 / norm);
+    for (int i = 0; i < feature.size(); ++i) {
+        unit[i] = feature[i] * inverse;
+    }
+    return unit;
+}
+
+qint32 FaceGallery::dotInt8(const qint8 *a, const qint8 *b, int n)
+{
+    int i = 0;
+    qint32 sum = 0;
+
+#if defined(__AVX2__)
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        __m256i aLow = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(va));
+        __m256i aHigh = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(va, 1));
+        __m256i bLow = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(vb));
+        __m256i bHigh = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(vb, 1));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(aLow, bLow));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(aHigh, bHigh));
+    }
+    __m128i acc128 = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    acc128 = _mm_add_epi32(acc128, _mm_shuffle_epi32(acc128, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc128 = _mm_add_epi32(acc128, _mm_shuffle_epi32(acc128, _MM_SHUFFLE(2, 3, 0, 1)));
+    sum = _mm_cvtsi128_si32(acc128);
+#elif defined(FACEGALLERY_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        // 符号扩展到16位
+        __m128i aSign = _mm_cmplt_epi8(va, zero);
+        __m128i bSign = _mm_cmplt_epi8(vb, zero);
+        __m128i aLow = _mm_unpacklo_epi8(va, aSign);
+        __m128i aHigh = _mm_unpackhi_epi8(va, aSign);
+        __m128i bLow = _mm_unpacklo_epi8(vb, bSign);
+        __m128i bHigh = _mm_unpackhi_epi8(vb, bSign);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(aLow, bLow));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(aHigh, bHigh));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    sum = _mm_cvtsi128_si32(acc);
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    int32x4_t acc = vdupq_n_s32(0);
+    for (; i + 16 <= n; i += 16) {
+        int8x16_t va = vld1q_s8(a + i);
+        int8x16_t vb = vld1q_s8(b + i);
+        acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+        acc = vpadalq_s16(acc, vmull_s8(vget_high_s8(va), vget_high_s8(vb)));
+    }
+    sum = vgetq_lane_s32(acc, 0) + vgetq_lane_s32(acc, 1) + vgetq_lane_s32(acc, 2) + vgetq_lane_s32(acc, 3);
+#endif
+
+    for (; i < n; ++i) {
+        sum += static_cast<qint32>(a[i]) * b[i];
+    }
+    return sum;
+}
+
+void FaceGallery::encodeRow(int row, const float *feature)
+{
+    switch (m_quantization) {
+    case NoQuantization:
+        std::memcpy(m_float.data() + row * m_dimension, feature, m_dimension * sizeof(float));
+        break;
+    case Int8:
+        m_int8Scales[row] = quantizeInt8(feature, m_dimension, m_int8.data() + row * m_dimension);
+        break;
+    case Float16:
+        qFloatToFloat16(m_float16.data() + row * m_dimension, feature, m_dimension);
+        break;
+    }
+}
+
+QList<QList<FaceGallery::Candidate>> FaceGallery::batchCandidates(const QList<QVector<float>> &features, int count) const
+{
+    QList<QList<Candidate>> result;
+    for (int i = 0; i < features.size(); ++i) {
+        result.append(QList<Candidate>());
+    }
+    if (m_workIds.isEmpty() || count <= 0) {
+        return result;
+    }
+
+    // 维度不符的查询不参与检索
+    QList<int> queryIndexes;
+    QList<QVector<float>> queries;
+    QList<QVector<qint8>> queriesInt8;
+    QVector<float> queryScales;
+    for (int i = 0; i < features.size(); ++i) {
+        if (features[i].size() != m_dimension) {
+            continue;
+        }
+        QVector<float> query = normalized(features[i]);
+        QVector<qint8> queryInt8;
+        float queryScale = 0.0f;
+        if (m_quantization == Int8) {
+            queryInt8.resize(m_dimension);
+            queryScale = quantizeInt8(query.constData(), m_dimension, queryInt8.data());
+        }
+        queryIndexes.append(i);
+        queries.append(query);
+        queriesInt8.append(queryInt8);
+        queryScales.append(queryScale);
+    }
+    if (queries.isEmpty()) {
+        return result;
+    }
+
+    // 逐行对所有查询计分，每行特征只从内存读取一次
+    QVector<QVector<Candidate>> scored(queries.size(), QVector<Candidate>(m_workIds.size()));
+    for (int row = 0; row < m_workIds.size(); ++row) {
+        for (int q = 0; q < queries.size(); ++q) {
+            scored[q][row].workId = m_workIds[row];
+            scored[q][row].score = rowScore(row, queries[q].constData(), queriesInt8[q].constData(), queryScales[q]);
+        }
+    }
+
+    int keep = qMin(count, static_cast<int>(m_workIds.size()));
+    for (int q = 0; q < queries.size(); ++q) {
+        QVector<Candidate> &rows = scored[q];
+        std::partial_sort(rows.begin(), rows.begin() + keep, rows.end(),
+                          [](const Candidate &a, const Candidate &b) { return a.score > b.score; });
+        QList<Candidate> &candidates = result[queryIndexes[q]];
+        candidates.reserve(keep);
+        for (int i = 0; i < keep; ++i) {
+            candidates.append(rows[i]);
+        }
+    }
+    return result;
+}
+
+float FaceGallery::rowScore(int row, const float *query, const qint8 *queryInt8, float queryScale) const
+{
+    switch (m_quantization) {
+    case Int8:
+        return dotInt8(queryInt8, m_int8.constData() + row * m_dimension, m_dimension)
+                * queryScale * m_int8Scales[row];
+    case Float16: {
+        const qfloat16 *values = m_float16.constData() + row * m_dimension;
+        float sum = 0.0f;
+        for (int i = 0; i < m_dimension; ++i) {
+            sum += query[i] * static_cast<float>(values[i]);
+        }
+        return sum;
+    }
+    case NoQuantization:
+    default: {
+        const float *values = m_float.constData() + row * m_dimension;
+        float sum = 0.0f;
+        for (int i = 0; i < m_dimension; ++i) {
+            sum += query[i] * values[i];
+        }
+        return sum;
+    }
+    }
+}
+
+float FaceGallery::quantizeInt8(const float *feature, int n, qint8 *out)
+{
+    // 对称量化：按最大绝对值映射到[-127, 127]
+    float maxAbs = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        maxAbs = qMax(maxAbs, std::fabs(feature[i]));
+    }
+    if (maxAbs <= 0.0f) {
+        std::memset(out, 0, n);
+        return 0.0f;
+    }
+
+    float scale = maxAbs / 127.0f;
+    float inverse = 127.0f / maxAbs;
+    for (int i = 0; i < n; ++i) {
+        int value = static_cast<int>(std::lround(feature[i] * inverse));
+        out[i] = static_cast<qint8>(qBound(-127, value, 127));
+    }
+    return scale;
+}
@@ -0,0 +1,110 @@
+#ifndef FACEGALLERY_H
+#define FACEGALLERY_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+#include <QtGlobal>
+#include <qfloat16.h>
+
+/**
+ * @brief 人脸特征库（1:N检索的候选召回）
+ *
+ * 内存中只保存归一化后的特征，可选int8或fp16量化以降低内存占用：
+ *   none  每人 4×维度 字节（1024维为4KB）
+ *   fp16  每人 2×维度 字节
+ *   int8  每人 维度+4 字节（每个特征一个缩放系数），点积使用SIMD整数运算
+ * 检索时先用（量化后的）余弦相似度召回候选，再由调用方用全精度特征和
+ * FaceRecognizer的相似度计算重新排序，最终得分与逐一比对一致。
+ */
+class FaceGallery
+{
+public:
+    enum Quantization {
+        NoQuantization,
+        Int8,
+        Float16
+    };
+
+    struct Candidate {
+        QString workId;    // 添加特征时使用的标识
+        float score;   // 召回阶段的近似余弦相似度
+    };
+
+    FaceGallery();
+
+    static Quantization quantizationFromString(const QString &name);
+    static QString quantizationName(Quantization quantization);
+
+    // 切换量化方式并清空特征库（量化后无法还原全精度特征，需要由调用方重新加载）
+    void setQuantization(Quantization quantization);
+    Quantization quantization() const { return m_quantization; }
+
+    void clear();
+
+    // 添加或替换一个人的特征（原始特征，内部归一化）
+    void setFeature(const QString &workId, const QVector<float> &feature);
+
+    void removeFeature(const QString &workId);
+
+    bool contains(const QString &workId) const { return m_rows.contains(workId); }
+    int size() const { return m_workIds.size(); }
+    int dimension() const { return m_dimension; }
+
+    /**
+     * @brief 召回与查询特征最相似的候选
+     * @param feature 查询特征（原始特征，内部归一化）
+     * @param count 候选数量
+     * @return 按近似相似度降序排列的候选
+     */
+    QList<Candidate> candidates(const QVector<float> &feature, int count) const;
+
+    /**
+     * @brief 同时召回多个查询特征的候选，只遍历一次特征库
+     * @return 与features一一对应的候选列表
+     */
+    QList<QList<Candidate>> batchCandidates(const QList<QVector<float>> &features, int count) const;
+
+    // 特征库占用的内存（字节）
+    qint64 memoryBytes() const;
+
+    // 统计信息：数量、维度、量化方式、内存占用
+    QVariantMap statistics() const;
+
+    // 特征与BLOB之间的转换（float32数组）
+    static QByteArray toBlob(const QVector<float> &feature);
+    static QVector<float> fromBlob(const QByteArray &blob);
+
+    // L2归一化
+    static QVector<float> normalized(const QVector<float> &feature);
+
+    // int8点积（SIMD实现）
+    static qint32 dotInt8(const qint8 *a, const qint8 *b, int n);
+
+    // 按int8对称量化一个向量，返回缩放系数
+    static float quantizeInt8(const float *feature, int n, qint8 *out);
+
+private:
+    // 将归一化特征编码到第row行
+    void encodeRow(int row, const float *feature);
+
+    // 查询与第row行的近似余弦相似度
+    float rowScore(int row, const float *query, const qint8 *queryInt8, float queryScale) const;
+
+    Quantization m_quantization;
+    int m_dimension;
+
+    QStringList m_workIds;
+    QHash<QString, int> m_rows;
+
+    QVector<float> m_float;        // 未量化时：行优先存储
+    QVector<qint8> m_int8;         // int8量化时
+    QVector<float> m_int8Scales;
+    QVector<qfloat16> m_float16;   // fp16量化时
+};
+
+#endif // FACEGALLERY_H
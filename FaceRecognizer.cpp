@@ -1,5 +1,9 @@
 #include "FaceRecognizer.h"
+#include "InferenceExecutor.h"
+#include "PerfTrace.h"
 #include <opencv2/imgproc.hpp>
+#include <cmath>
+#include <algorithm>
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
@@ -8,19 +12,110 @@
 #include <QUrl>
 #include <QTimer>
 #include <QCoreApplication>
+#include <QPointer>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QImageReader>
+#include <QMutexLocker>
+#include "ModelLocator.h"
+#include "SeetaModelRegistry.h"
+
+namespace {
+
+// 跟踪时人脸框每侧向外扩展的比例
+const double kTrackingPadding = 0.5;
+
+// 低于该置信度的检测结果视为误检
+const float kMinFaceScore = 0.3f;
+
+// 人脸框平滑系数，越小越平稳
+const double kSmoothingFactor = 0.5;
+
+// 新检测结果与跟踪框重叠度低于该值时认为人脸发生跳变，不做平滑
+const double kResetIoU = 0.3;
+
+// 人脸质量门限：低于这些值的帧不进行特征提取
+const float kQualityMinScore = 0.75f;      // 检测置信度
+const int kQualityMinFaceSize = 100;       // 人脸框边长（像素）
+const double kQualityMinSharpness = 40.0;  // 人脸区域缩放到固定尺寸后的拉普拉斯方差
+const double kQualityMaxRoll = 20.0;       // 平面内旋转（度）
+const double kQualityMaxYaw = 0.25;        // 鼻尖相对两眼中点的水平偏移 / 两眼间距
+const double kQualityMinPitch = 0.25;      // 鼻尖在眼线到嘴线之间的相对位置
+const double kQualityMaxPitch = 0.80;
+
+// 多人签到时的人脸框最小边长：多人同框时每张人脸较小，单人门限会把站在后排的人全部拒绝
+const int kGroupQualityMinFaceSize = 60;
+
+// 计算清晰度时人脸区域缩放到的尺寸，使不同大小的人脸可比
+const int kSharpnessSize = 112;
+
+// 检测和特征提取使用的工作分辨率（长边），更大的图像在解码时直接缩小
+const int kWorkingMaxSide = 1280;
+
+double rectArea(const QRectF &rect)
+{
+    return rect.width() * rect.height();
+}
+
+// 把结果中的人脸框从工作分辨率换算回原图坐标
+void scaleFaceBox(QVariantMap &result, const QSize &workingSize, const QSize &originalSize)
+{
+    if (workingSize == originalSize || workingSize.isEmpty() || !result.contains("x")) {
+        return;
+    }
+    double scaleX = static_cast<double>(originalSize.width()) / workingSize.width();
+    double scaleY = static_cast<double>(originalSize.height()) / workingSize.height();
+    result["x"] = qRound(result["x"].toDouble() * scaleX);
+    result["y"] = qRound(result["y"].toDouble() * scaleY);
+    result["width"] = qRound(result["width"].toDouble() * scaleX);
+    result["height"] = qRound(result["height"].toDouble() * scaleY);
+}
+
+// 置信度最高且不低于kMinFaceScore的人脸，没有时返回-1
+int bestFace(const std::vector<FaceDetection> &faces)
+{
+    int best = -1;
+    for (int i = 0; i < static_cast<int>(faces.size()); ++i) {
+        if (best < 0 || faces[i].score > faces[best].score) {
+            best = i;
+        }
+    }
+    return best >= 0 && faces[best].score >= kMinFaceScore ? best : -1;
+}
+
+// 在推理线程上调用并返回结果
+template <typename Func>
+auto runOnInferenceThread(Func func) -> decltype(func())
+{
+    decltype(func()) result{};
+    InferenceExecutor::getInstance().run([&]() { result = func(); });
+    return result;
+}
+
+bool isInferenceThread()
+{
+    return InferenceExecutor::getInstance().isWorkerThread();
+}
+
+} // namespace
 
 FaceRecognizer::FaceRecognizer(QObject *parent) : QObject(parent),
-    m_faceDetector(nullptr),
-    m_faceLandmarker(nullptr),
-    m_faceRecognizer(nullptr),
     m_initialized(false),
+    m_loading(false),
     m_rotationAngle(0.0f),
     m_rotationSpeed(2.0f),
-    m_rotationTimer(nullptr)
+    m_rotationTimer(nullptr),
+    m_trackingActive(false),
+    m_framesSinceKeyframe(0),
+    m_keyframeInterval(10),
+    m_trackId(0),
+    m_trackScore(0.0f),
+    m_trackingResets(0)
 {
     // 设置模型路径为当前应用程序目录下的model文件夹
     m_modelPath = QApplication::applicationDirPath() + "/model";
-    qDebug() << "SeetaFace2 model path:" << m_modelPath;
+    qDebug() << "Face model path:" << m_modelPath;
     
     // 初始化旋转定时器
     m_rotationTimer = new QTimer(this);
@@ -29,21 +124,8 @@ FaceRecognizer::FaceRecognizer(QObject *parent) : QObject(parent),
 
 FaceRecognizer::~FaceRecognizer()
 {
-    // 释放资源
-    if (m_faceDetector) {
-        delete m_faceDetector;
-        m_faceDetector = nullptr;
-    }
-    
-    if (m_faceLandmarker) {
-        delete m_faceLandmarker;
-        m_faceLandmarker = nullptr;
-    }
-    
-    if (m_faceRecognizer) {
-        delete m_faceRecognizer;
-        m_faceRecognizer = nullptr;
-    }
+    // 释放对共享模型的引用，最后一个使用者释放时模型才会卸载
+    releaseModels();
     
     // 停止并清理定时器
     if (m_rotationTimer) {
@@ -53,407 +135,121 @@ FaceRecognizer::~FaceRecognizer()
 
 bool FaceRecognizer::initialize()
 {
+    PERF_TRACE_METHOD();
     if (m_initialized) {
         return true; // 已经初始化过了
     }
 
-    try {
-        qDebug() << "\n\n========== 人脸识别初始化 ==========";
-        qDebug() << "应用程序目录:" << QApplication::applicationDirPath();
-        qDebug() << "当前工作目录:" << QDir::currentPath();
-        qDebug() << "当前设置的模型路径:" << m_modelPath;
-        
-        // 显式列出所有可能的模型路径
-        QStringList possiblePaths;
-        possiblePaths << m_modelPath; // 默认路径 (applicationDirPath + "/model")
-        possiblePaths << QApplication::applicationDirPath(); // 应用程序根目录
-        possiblePaths << QDir::currentPath(); // 当前工作目录
-        possiblePaths << QDir::currentPath() + "/model"; // 当前工作目录的model子目录
-        possiblePaths << QApplication::applicationDirPath() + "/../model"; // 上一级目录
-        possiblePaths << QApplication::applicationDirPath() + "/../../model"; // 上两级目录
-        possiblePaths << QApplication::applicationDirPath() + "/../../../model"; // 上三级目录
-        possiblePaths << "model"; // 相对路径model
-        possiblePaths << "../model"; // 相对上级目录
-        possiblePaths << QCoreApplication::applicationDirPath() + "/data/model"; // data子目录
-        possiblePaths << QCoreApplication::applicationDirPath() + "/assets/model"; // assets子目录
-        possiblePaths << "E:/SparkExamAI/SparkExamAI/SparkExamAI/model"; // 固定开发路径
-        possiblePaths << "C:/Program Files/SparkExamAI/model"; // 可能的安装路径
-        possiblePaths << "C:/Program Files (x86)/SparkExamAI/model"; // 可能的安装路径
-        
-        // 检查每个可能的路径
-        qDebug() << "检查所有可能的模型路径:";
-        QString modelPathFound;
-        
-        for (const QString &path : possiblePaths) {
-            QDir dir(path);
-            if (dir.exists()) {
-                // 检查是否有模型文件
-                QFileInfo detectorFile(path + "/fd_2_00.dat");
-                QFileInfo landmarkerFile(path + "/pd_2_00_pts5.dat");
-                QFileInfo recognizerFile(path + "/fr_2_10.dat");
-                
-                bool hasDetector = detectorFile.exists();
-                bool hasLandmarker = landmarkerFile.exists();
-                bool hasRecognizer = recognizerFile.exists();
-                
-                qDebug() << "路径:" << path 
-                         << "\n  - 目录存在:" << dir.exists()
-                         << "\n  - 检测器模型:" << (hasDetector ? "存在" : "不存在")
-                         << "\n  - 特征点模型:" << (hasLandmarker ? "存在" : "不存在")
-                         << "\n  - 识别模型:" << (hasRecognizer ? "存在" : "不存在");
-                
-                if (hasDetector && hasLandmarker && hasRecognizer) {
-                    modelPathFound = path;
-                    qDebug() << "找到完整的模型文件目录:" << modelPathFound;
-                    break;
-                }
-            } else {
-                qDebug() << "路径不存在:" << path;
-            }
-        }
-        
-        // 如果找到有效的模型路径，使用它
-        if (!modelPathFound.isEmpty()) {
-            m_modelPath = modelPathFound;
-            qDebug() << "将使用模型路径:" << m_modelPath;
-        } else {
-            // 如果找不到预定义路径中的模型，尝试搜索整个应用程序目录树
-            qDebug() << "在预定义路径中未找到模型文件，尝试搜索整个应用程序目录...";
-            QDir appDir(QApplication::applicationDirPath());
-            QStringList modelFiles = findModelFiles(appDir);
-            
-            if (!modelFiles.isEmpty()) {
-                // 找到模型文件，获取其路径
-                QString detectorFilePath;
-                QString landmarkerFilePath;
-                QString recognizerFilePath;
-                
-                for (const QString &file : modelFiles) {
-                    if (file.endsWith("fd_2_00.dat")) detectorFilePath = file;
-                    else if (file.endsWith("pd_2_00_pts5.dat")) landmarkerFilePath = file;
-                    else if (file.endsWith("fr_2_10.dat")) recognizerFilePath = file;
-                }
-                
-                if (!detectorFilePath.isEmpty() && !landmarkerFilePath.isEmpty() && !recognizerFilePath.isEmpty()) {
-                    // 确保所有模型文件都在同一目录
-                    QFileInfo detectorInfo(detectorFilePath);
-                    QFileInfo landmarkerInfo(landmarkerFilePath);
-                    QFileInfo recognizerInfo(recognizerFilePath);
-                    
-                    if (detectorInfo.absolutePath() == landmarkerInfo.absolutePath() && 
-                        landmarkerInfo.absolutePath() == recognizerInfo.absolutePath()) {
-                        m_modelPath = detectorInfo.absolutePath();
-                        qDebug() << "通过搜索找到模型目录:" << m_modelPath;
-                    } else {
-                        qDebug() << "模型文件存在但不在同一目录中:";
-                        qDebug() << " - 检测器:" << detectorFilePath;
-                        qDebug() << " - 特征点:" << landmarkerFilePath;
-                        qDebug() << " - 识别器:" << recognizerFilePath;
-                        
-                        // 使用检测器的目录作为模型路径
-                        m_modelPath = detectorInfo.absolutePath();
-                        qDebug() << "将使用检测器所在目录:" << m_modelPath;
-                    }
-                } else {
-                    qDebug() << "搜索中找到的模型文件不完整:";
-                    qDebug() << " - 检测器:" << (detectorFilePath.isEmpty() ? "未找到" : detectorFilePath);
-                    qDebug() << " - 特征点:" << (landmarkerFilePath.isEmpty() ? "未找到" : landmarkerFilePath);
-                    qDebug() << " - 识别器:" << (recognizerFilePath.isEmpty() ? "未找到" : recognizerFilePath);
-                    
-                    // 尝试紧急初始化
-                    qDebug() << "尝试紧急初始化...";
-                    return emergency_initialize();
-                }
-            } else {
-                qDebug() << "在应用程序目录中未找到任何模型文件";
-                // 尝试紧急初始化
-                qDebug() << "尝试紧急初始化...";
-                return emergency_initialize();
-            }
-        }
-        
-        // 到这里，我们应该已经设置了正确的m_modelPath
-        qDebug() << "最终使用的模型路径:" << m_modelPath;
-        
-        // 再次检查模型文件是否存在
-        QFileInfo detectorFile(m_modelPath + "/fd_2_00.dat");
-        QFileInfo landmarkerFile(m_modelPath + "/pd_2_00_pts5.dat");
-        QFileInfo recognizerFile(m_modelPath + "/fr_2_10.dat");
-        
-        qDebug() << "模型文件最终检查:";
-        qDebug() << " - 检测器 (" << detectorFile.absoluteFilePath() << "): " << (detectorFile.exists() ? "存在" : "不存在");
-        qDebug() << " - 特征点 (" << landmarkerFile.absoluteFilePath() << "): " << (landmarkerFile.exists() ? "存在" : "不存在");
-        qDebug() << " - 识别器 (" << recognizerFile.absoluteFilePath() << "): " << (recognizerFile.exists() ? "存在" : "不存在");
-        
-        if (!detectorFile.exists() || !landmarkerFile.exists() || !recognizerFile.exists()) {
-            qDebug() << "最终路径中缺少必需的模型文件";
-            // 尝试紧急初始化
-            qDebug() << "尝试紧急初始化...";
-            return emergency_initialize();
-        }
-        
-        // 配置人脸检测器
-        seeta::ModelSetting::Device device = seeta::ModelSetting::CPU;
-        int id = 0;
-        
-        qDebug() << "创建人脸检测器...";
-        QString detectorPath = m_modelPath + "/fd_2_00.dat";
-        qDebug() << "检测器路径:" << detectorPath << "存在:" << QFileInfo(detectorPath).exists();
-        
-        try {
-            seeta::ModelSetting FD_model(detectorPath.toStdString(), device, id);
-            m_faceDetector = new seeta::FaceDetector(FD_model);
-            // 使用正确的方法设置参数
-            m_faceDetector->set(seeta::FaceDetector::PROPERTY_MIN_FACE_SIZE, 80);
-            qDebug() << "人脸检测器创建成功";
-        } catch (const std::exception &e) {
-            qDebug() << "创建人脸检测器失败:" << e.what();
-            // 尝试紧急初始化
-            qDebug() << "尝试紧急初始化...";
-            return emergency_initialize();
-        }
-        
-        // 配置人脸特征点定位器
-        qDebug() << "创建人脸特征点定位器...";
-        QString landmarkerPath = m_modelPath + "/pd_2_00_pts5.dat";
-        qDebug() << "特征点定位器路径:" << landmarkerPath << "存在:" << QFileInfo(landmarkerPath).exists();
-        
-        try {
-            seeta::ModelSetting PD_model(landmarkerPath.toStdString(), device, id);
-            m_faceLandmarker = new seeta::FaceLandmarker(PD_model);
-            qDebug() << "人脸特征点定位器创建成功";
-        } catch (const std::exception &e) {
-            qDebug() << "创建人脸特征点定位器失败:" << e.what();
-            // 清理资源
-            if (m_faceDetector) {
-                delete m_faceDetector;
-                m_faceDetector = nullptr;
-            }
-            // 尝试紧急初始化
-            qDebug() << "尝试紧急初始化...";
-            return emergency_initialize();
-        }
-        
-        // 配置人脸特征提取器
-        qDebug() << "创建人脸特征提取器...";
-        QString recognizerPath = m_modelPath + "/fr_2_10.dat";
-        qDebug() << "特征提取器路径:" << recognizerPath << "存在:" << QFileInfo(recognizerPath).exists();
-        
-        try {
-            seeta::ModelSetting FR_model(recognizerPath.toStdString(), device, id);
-            m_faceRecognizer = new seeta::FaceRecognizer(FR_model);
-            qDebug() << "人脸特征提取器创建成功";
-        } catch (const std::exception &e) {
-            qDebug() << "创建人脸特征提取器失败:" << e.what();
-            // 清理资源
-            if (m_faceDetector) {
-                delete m_faceDetector;
-                m_faceDetector = nullptr;
-            }
-            if (m_faceLandmarker) {
-                delete m_faceLandmarker;
-                m_faceLandmarker = nullptr;
-            }
-            // 尝试紧急初始化
-            qDebug() << "尝试紧急初始化...";
-            return emergency_initialize();
-        }
-        
-        m_initialized = true;
-        qDebug() << "人脸识别模型初始化成功";
-        qDebug() << "========== 人脸识别初始化完成 ==========\n";
+    // 模型由推理线程使用，推理线程已加载过模型时直接共享，无需重新查找和加载模型文件
+    QThread *owner = InferenceExecutor::getInstance().workerThread();
+    QString backendName = FaceBackend::configuredName();
+    if (attachBackend(FaceBackend::acquireLoaded(backendName, owner))) {
+        qDebug() << "复用已加载的人脸识别模型:" << backendName << m_modelPath;
         return true;
     }
-    catch (const std::exception &e) {
-        qDebug() << "初始化人脸识别模型时发生错误: " << e.what();
-        qDebug() << "尝试紧急初始化...";
-        return emergency_initialize();
-    }
-}
-
-// 紧急初始化方法 - 使用硬编码的路径尝试加载模型文件
-bool FaceRecognizer::emergency_initialize() {
-    qDebug() << "\n===== 紧急初始化 - 使用硬编码路径 =====";
     
-    // 清理任何可能已经分配的资源
-    if (m_faceDetector) {
-        delete m_faceDetector;
-        m_faceDetector = nullptr;
+    // 其他线程已找到模型目录时直接使用该目录
+    QString modelPath = SeetaModelRegistry::instance().modelPath();
+    if (modelPath.isEmpty()) {
+        modelPath = ModelLocator::locate();
+    }
+    if (modelPath.isEmpty()) {
+        qDebug() << "人脸识别器初始化失败：未找到模型目录";
+        return false;
     }
     
-    if (m_faceLandmarker) {
-        delete m_faceLandmarker;
-        m_faceLandmarker = nullptr;
+    // 所有实例共享推理线程上的一份模型
+    if (!attachBackend(FaceBackend::acquire(backendName, modelPath, owner))) {
+        qDebug() << "人脸识别器初始化失败：无法从目录加载模型:" << modelPath;
+        return false;
     }
     
-    if (m_faceRecognizer) {
-        delete m_faceRecognizer;
-        m_faceRecognizer = nullptr;
+    qDebug() << "人脸识别模型初始化成功:" << m_backend->name() << m_modelPath;
+    return true;
+}
+
+void FaceRecognizer::initializeAsync()
+{
+    PERF_TRACE_METHOD();
+    if (m_initialized || m_loading) {
+        return;
     }
+    m_loading = true;
     
-    try {
-        // 设备类型和ID
-        seeta::ModelSetting::Device device = seeta::ModelSetting::CPU;
-        int id = 0;
-        
-        // 尝试一系列硬编码的绝对路径
-        const QString appDir = QApplication::applicationDirPath();
-        
-        // 使用应用程序目录下的model目录
-        QString detectorPath = appDir + "/model/fd_2_00.dat";
-        QString landmarkerPath = appDir + "/model/pd_2_00_pts5.dat";
-        QString recognizerPath = appDir + "/model/fr_2_10.dat";
-        
-        // 检查路径是否存在
-        bool detectorExists = QFileInfo(detectorPath).exists();
-        bool landmarkerExists = QFileInfo(landmarkerPath).exists();
-        bool recognizerExists = QFileInfo(recognizerPath).exists();
-        
-        qDebug() << "检查应用程序目录下的model文件夹:";
-        qDebug() << " - 检测器:" << detectorPath << (detectorExists ? "存在" : "不存在");
-        qDebug() << " - 特征点:" << landmarkerPath << (landmarkerExists ? "存在" : "不存在");
-        qDebug() << " - 识别器:" << recognizerPath << (recognizerExists ? "存在" : "不存在");
-        
-        // 如果应用程序目录的model子目录中找不到文件，尝试根目录
-        if (!detectorExists || !landmarkerExists || !recognizerExists) {
-            qDebug() << "尝试从应用程序根目录加载...";
-            detectorPath = appDir + "/fd_2_00.dat";
-            landmarkerPath = appDir + "/pd_2_00_pts5.dat";
-            recognizerPath = appDir + "/fr_2_10.dat";
-            
-            detectorExists = QFileInfo(detectorPath).exists();
-            landmarkerExists = QFileInfo(landmarkerPath).exists();
-            recognizerExists = QFileInfo(recognizerPath).exists();
-            
-            qDebug() << " - 检测器:" << detectorPath << (detectorExists ? "存在" : "不存在");
-            qDebug() << " - 特征点:" << landmarkerPath << (landmarkerExists ? "存在" : "不存在");
-            qDebug() << " - 识别器:" << recognizerPath << (recognizerExists ? "存在" : "不存在");
-        }
-        
-        // 如果还是找不到，尝试固定的开发路径
-        if (!detectorExists || !landmarkerExists || !recognizerExists) {
-            qDebug() << "尝试从固定开发路径加载...";
-            detectorPath = "E:/SparkExamAI/SparkExamAI/SparkExamAI/model/fd_2_00.dat";
-            landmarkerPath = "E:/SparkExamAI/SparkExamAI/SparkExamAI/model/pd_2_00_pts5.dat";
-            recognizerPath = "E:/SparkExamAI/SparkExamAI/SparkExamAI/model/fr_2_10.dat";
-            
-            detectorExists = QFileInfo(detectorPath).exists();
-            landmarkerExists = QFileInfo(landmarkerPath).exists();
-            recognizerExists = QFileInfo(recognizerPath).exists();
-            
-            qDebug() << " - 检测器:" << detectorPath << (detectorExists ? "存在" : "不存在");
-            qDebug() << " - 特征点:" << landmarkerPath << (landmarkerExists ? "存在" : "不存在");
-            qDebug() << " - 识别器:" << recognizerPath << (recognizerExists ? "存在" : "不存在");
-        }
-        
-        // 如果所有尝试都失败，返回失败
-        if (!detectorExists || !landmarkerExists || !recognizerExists) {
-            qDebug() << "紧急初始化失败：无法找到所有必需的模型文件";
-            qDebug() << "===== 紧急初始化失败 =====\n";
-            return false;
+    // 在后台线程中定位并加载模型，加载结果登记到推理线程
+    QThread *owner = InferenceExecutor::getInstance().workerThread();
+    QPointer<FaceRecognizer> self(this);
+    QString backendName = FaceBackend::configuredName();
+    QThreadPool::globalInstance()->start([self, owner, backendName]() {
+        QString modelPath = SeetaModelRegistry::instance().modelPath();
+        if (modelPath.isEmpty()) {
+            modelPath = ModelLocator::locate();
         }
         
-        // 创建模型
-        qDebug() << "使用找到的模型文件创建模型...";
-        
-        // 人脸检测器
-        try {
-            qDebug() << "创建人脸检测器...";
-            seeta::ModelSetting FD_model(detectorPath.toStdString(), device, id);
-            m_faceDetector = new seeta::FaceDetector(FD_model);
-            m_faceDetector->set(seeta::FaceDetector::PROPERTY_MIN_FACE_SIZE, 80);
-            qDebug() << "人脸检测器创建成功";
-        } catch (const std::exception &e) {
-            qDebug() << "创建人脸检测器失败:" << e.what();
-            qDebug() << "===== 紧急初始化失败 =====\n";
-            return false;
+        QSharedPointer<FaceBackend> backend;
+        if (!modelPath.isEmpty()) {
+            backend = FaceBackend::acquire(backendName, modelPath, owner);
         }
         
-        // 人脸特征点定位器
-        try {
-            qDebug() << "创建人脸特征点定位器...";
-            seeta::ModelSetting PD_model(landmarkerPath.toStdString(), device, id);
-            m_faceLandmarker = new seeta::FaceLandmarker(PD_model);
-            qDebug() << "人脸特征点定位器创建成功";
-        } catch (const std::exception &e) {
-            qDebug() << "创建人脸特征点定位器失败:" << e.what();
-            if (m_faceDetector) {
-                delete m_faceDetector;
-                m_faceDetector = nullptr;
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [self, backend]() {
+            if (!self) {
+                return;
             }
-            qDebug() << "===== 紧急初始化失败 =====\n";
-            return false;
-        }
-        
-        // 人脸特征提取器
-        try {
-            qDebug() << "创建人脸特征提取器...";
-            seeta::ModelSetting FR_model(recognizerPath.toStdString(), device, id);
-            m_faceRecognizer = new seeta::FaceRecognizer(FR_model);
-            qDebug() << "人脸特征提取器创建成功";
-        } catch (const std::exception &e) {
-            qDebug() << "创建人脸特征提取器失败:" << e.what();
-            if (m_faceDetector) {
-                delete m_faceDetector;
-                m_faceDetector = nullptr;
+            self->m_loading = false;
+            if (self->m_initialized) {
+                return;
             }
-            if (m_faceLandmarker) {
-                delete m_faceLandmarker;
-                m_faceLandmarker = nullptr;
+            if (self->attachBackend(backend)) {
+                qDebug() << "人脸识别模型后台加载完成:" << backend->name() << self->m_modelPath;
+            } else {
+                qDebug() << "人脸识别模型后台加载失败";
+                emit self->initializationFailed();
             }
-            qDebug() << "===== 紧急初始化失败 =====\n";
-            return false;
-        }
-        
-        // 保存成功的模型路径
-        QFileInfo info(detectorPath);
-        m_modelPath = info.absolutePath();
-        
-        m_initialized = true;
-        qDebug() << "紧急初始化成功，使用路径:" << m_modelPath;
-        qDebug() << "===== 紧急初始化完成 =====\n";
-        return true;
-    } catch (const std::exception &e) {
-        qDebug() << "紧急初始化时发生异常:" << e.what();
-        qDebug() << "===== 紧急初始化失败 =====\n";
-        return false;
-    }
+        }, Qt::QueuedConnection);
+    });
 }
 
-// 递归搜索模型文件
-QStringList FaceRecognizer::findModelFiles(const QDir &dir) {
-    QStringList results;
-    QStringList modelFileNames;
-    modelFileNames << "fd_2_00.dat" << "pd_2_00_pts5.dat" << "fr_2_10.dat";
-    
-    // 检查目录中的所有文件
-    QStringList files = dir.entryList(QDir::Files);
-    for (const QString &file : files) {
-        if (modelFileNames.contains(file)) {
-            results.append(dir.absoluteFilePath(file));
-        }
-    }
-    
-    // 递归搜索所有子目录
-    QStringList subdirs = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-    for (const QString &subdir : subdirs) {
-        QDir subdirObj(dir.absoluteFilePath(subdir));
-        results.append(findModelFiles(subdirObj));
+// 使用共享的识别后端
+bool FaceRecognizer::attachBackend(const QSharedPointer<FaceBackend> &backend)
+{
+    if (!backend) {
+        return false;
     }
     
-    return results;
+    m_backend = backend;
+    m_modelPath = backend->modelPath();
+    m_initialized = true;
+    emit initializedChanged();
+    return true;
+}
+
+// 释放对共享模型的引用
+void FaceRecognizer::releaseModels()
+{
+    m_backend.reset();
+    m_initialized = false;
+}
+
+QString FaceRecognizer::backendName() const
+{
+    return m_backend ? m_backend->name() : FaceBackend::configuredName();
 }
 
 bool FaceRecognizer::detectFace(const QString &imagePath)
 {
-    if (!m_initialized && !initialize()) {
+    if (!isInferenceThread()) {
+        initialize();
+        return runOnInferenceThread([&]() { return detectFace(imagePath); });
+    }
+    PERF_TRACE_METHOD();
+    if (!m_initialized) {
         qDebug() << "Face detection models not initialized.";
         return false;
     }
     
     try {
-        // 加载图像
-        QImage image = loadImage(imagePath);
+        // 按工作分辨率加载图像
+        QImage image = loadWorkingImage(imagePath);
         if (image.isNull()) {
             qDebug() << "Failed to load image for face detection.";
             return false;
@@ -466,18 +262,8 @@ bool FaceRecognizer::detectFace(const QString &imagePath)
             return false;
         }
         
-        // 直接使用原始图像，不再调用cvtColor
-        cv::Mat gray = mat.clone();
-        
-        // 创建SeetaFace的图像对象
-        seeta::ImageData imageData(gray.cols, gray.rows, gray.channels());
-        imageData.data = gray.data;
-        
-        // 检测人脸
-        auto faces = m_faceDetector->detect(imageData);
-        
-        // 如果检测到人脸，返回true
-        return faces.size > 0;
+        // 检测人脸，检测到时返回true
+        return !m_backend->detect(mat).empty();
     }
     catch (const std::exception &e) {
         qDebug() << "Error detecting face: " << e.what();
@@ -487,7 +273,12 @@ bool FaceRecognizer::detectFace(const QString &imagePath)
 
 bool FaceRecognizer::extractFeature(const QImage &image)
 {
-    if (!m_initialized && !initialize()) {
+    if (!isInferenceThread()) {
+        initialize();
+        return runOnInferenceThread([&]() { return extractFeature(image); });
+    }
+    PERF_TRACE_METHOD();
+    if (!m_initialized) {
         qDebug() << "Face recognition models not initialized.";
         return false;
     }
@@ -500,25 +291,15 @@ bool FaceRecognizer::extractFeature(const QImage &image)
             return false;
         }
         
-        // 创建SeetaFace的图像对象
-        seeta::ImageData imageData(mat.cols, mat.rows, mat.channels());
-        imageData.data = mat.data;
-        
         // 检测人脸
-        auto faces = m_faceDetector->detect(imageData);
-        if (faces.size == 0) {
+        std::vector<FaceDetection> faces = m_backend->detect(mat);
+        if (faces.empty()) {
             qDebug() << "No face detected in the image.";
             return false;
         }
         
-        // 获取第一个人脸
-        auto &face = faces.data[0];
-        
-        // 提取特征点
-        auto points = m_faceLandmarker->mark(imageData, face.pos);
-        
-        // 检查特征点是否有效
-        return points.size() > 0;
+        // 提取第一个人脸的特征点，检查是否有效
+        return m_backend->align(mat, faces[0]);
     }
     catch (const std::exception &e) {
         qDebug() << "Error extracting face features: " << e.what();
@@ -528,6 +309,7 @@ bool FaceRecognizer::extractFeature(const QImage &image)
 
 float FaceRecognizer::compareFaces(const QString &image1Path, const QString &image2Path)
 {
+    PERF_TRACE_METHOD();
     qDebug() << "Comparing faces:" << image1Path << "and" << image2Path;
     
     if (!m_initialized && !initialize()) {
@@ -535,88 +317,66 @@ float FaceRecognizer::compareFaces(const QString &image1Path, const QString &ima
         return 0.0f;
     }
     
-    try {
-        // 加载两张图像
-        QImage image1 = loadImage(image1Path);
-        QImage image2 = loadImage(image2Path);
-        
-        if (image1.isNull() || image2.isNull()) {
-            qDebug() << "Failed to load images.";
-            return 0.0f;
-        }
-        
-        qDebug() << "Images loaded successfully. Image1 size:" << image1.size() << "Image2 size:" << image2.size();
-        
-        // 转换为OpenCV Mat
-        cv::Mat mat1 = qImageToMat(image1);
-        cv::Mat mat2 = qImageToMat(image2);
-        
-        if (mat1.empty() || mat2.empty()) {
-            qDebug() << "Failed to convert images to Mat";
-            return 0.0f;
-        }
-        
-        qDebug() << "Images converted to Mat. Mat1 size: width=" << mat1.cols << ", height=" << mat1.rows 
-                 << ", channels=" << mat1.channels()
-                 << ". Mat2 size: width=" << mat2.cols << ", height=" << mat2.rows  
-                 << ", channels=" << mat2.channels();
-        
-        // 创建SeetaFace的图像对象
-        seeta::ImageData imageData1(mat1.cols, mat1.rows, mat1.channels());
-        imageData1.data = mat1.data;
-        
-        seeta::ImageData imageData2(mat2.cols, mat2.rows, mat2.channels());
-        imageData2.data = mat2.data;
-        
-        // 检测人脸
-        auto faces1 = m_faceDetector->detect(imageData1);
-        auto faces2 = m_faceDetector->detect(imageData2);
-        
-        qDebug() << "Face detection results - Image1:" << faces1.size << "faces, Image2:" << faces2.size << "faces";
-        
-        if (faces1.size == 0 || faces2.size == 0) {
-            qDebug() << "No face detected in one or both images.";
-            return 0.0f;
-        }
-        
-        // 获取第一个人脸
-        auto &face1 = faces1.data[0];
-        auto &face2 = faces2.data[0];
-        
-        // 提取特征点
-        auto points1 = m_faceLandmarker->mark(imageData1, face1.pos);
-        auto points2 = m_faceLandmarker->mark(imageData2, face2.pos);
-        
-        qDebug() << "Landmarks extracted - Image1:" << points1.size() << "points, Image2:" << points2.size() << "points";
-        
-        // 准备特征向量存储空间
-        float feature1[1024] = {0};
-        float feature2[1024] = {0};
-        
-        // 提取人脸特征
-        #ifdef _WIN64
-        // 64位系统上，保持原样
-        m_faceRecognizer->Extract(imageData1, static_cast<const SeetaPointF*>(points1.data()), feature1);
-        m_faceRecognizer->Extract(imageData2, static_cast<const SeetaPointF*>(points2.data()), feature2);
-        #else
-        // 32位系统上，先使用static_cast确保指针类型转换安全
-        m_faceRecognizer->Extract(imageData1, reinterpret_cast<const SeetaPointF*>(points1.data()), feature1);
-        m_faceRecognizer->Extract(imageData2, reinterpret_cast<const SeetaPointF*>(points2.data()), feature2);
-        #endif
-        
-        // 计算相似度
-        float similarity = m_faceRecognizer->CalculateSimilarity(feature1, feature2);
-        
-        qDebug() << "Face similarity score:" << similarity;
-        return similarity;
-    }
-    catch (const std::exception &e) {
-        qDebug() << "Error comparing faces: " << e.what();
+    // 两张图像分别取置信度最高的人脸提取特征
+    QVector<float> feature1 = extractFeatureVector(image1Path);
+    QVector<float> feature2 = extractFeatureVector(image2Path);
+    if (feature1.isEmpty() || feature2.isEmpty()) {
+        qDebug() << "No face detected in one or both images.";
         return 0.0f;
     }
+    
+    // 计算相似度
+    float similarity = calculateSimilarity(feature1, feature2);
+    
+    qDebug() << "Face similarity score:" << similarity;
+    return similarity;
 }
 
 QImage FaceRecognizer::loadImage(const QString &imagePath)
+{
+    PERF_TRACE_METHOD();
+    QString filePath = resolveImagePath(imagePath);
+    
+    QImage image(filePath);
+    if (image.isNull()) {
+        qDebug() << "无法加载图像:" << filePath << "原始路径:" << imagePath;
+    } else {
+        qDebug() << "成功加载图像:" << filePath << "尺寸:" << image.size();
+    }
+    return image;
+}
+
+QImage FaceRecognizer::loadWorkingImage(const QString &imagePath, QSize *originalSize)
+{
+    PERF_TRACE_METHOD();
+    QString filePath = resolveImagePath(imagePath);
+    
+    // 先只读取文件头获得原图尺寸，超过工作分辨率时让解码器直接输出缩小后的图像
+    // （JPEG在DCT域按1/2、1/4、1/8缩小，不解码全分辨率像素）
+    QImageReader reader(filePath);
+    QSize size = reader.size();
+    if (size.isValid() && qMax(size.width(), size.height()) > kWorkingMaxSide) {
+        reader.setScaledSize(size.scaled(kWorkingMaxSide, kWorkingMaxSide, Qt::KeepAspectRatio));
+    }
+    
+    QImage image = reader.read();
+    if (image.isNull()) {
+        qDebug() << "无法加载图像:" << filePath << "原始路径:" << imagePath << reader.errorString();
+        return image;
+    }
+    
+    // 部分格式无法预先读取尺寸，此时按原分辨率解码
+    if (!size.isValid()) {
+        size = image.size();
+    }
+    if (originalSize) {
+        *originalSize = size;
+    }
+    qDebug() << "成功加载图像:" << filePath << "原始尺寸:" << size << "工作尺寸:" << image.size();
+    return image;
+}
+
+QString FaceRecognizer::resolveImagePath(const QString &imagePath) const
 {
     // 处理URL格式的路径（file:///开头）
     QString filePath = imagePath;
@@ -645,18 +405,12 @@ QImage FaceRecognizer::loadImage(const QString &imagePath)
             }
         }
     }
-    
-    QImage image(filePath);
-    if (image.isNull()) {
-        qDebug() << "无法加载图像:" << filePath << "原始路径:" << imagePath;
-    } else {
-        qDebug() << "成功加载图像:" << filePath << "尺寸:" << image.size();
-    }
-    return image;
+    return filePath;
 }
 
 QImage FaceRecognizer::matToQImage(const cv::Mat &mat)
 {
+    PERF_TRACE_METHOD();
     if (mat.empty()) {
         qDebug() << "Empty Mat cannot be converted to QImage";
         return QImage();
@@ -681,6 +435,7 @@ QImage FaceRecognizer::matToQImage(const cv::Mat &mat)
 
 cv::Mat FaceRecognizer::qImageToMat(const QImage &image)
 {
+    PERF_TRACE_METHOD();
     if (image.isNull()) {
         qDebug() << "Cannot convert null QImage to Mat";
         return cv::Mat();
@@ -746,6 +501,13 @@ cv::Mat FaceRecognizer::qImageToMat(const QImage &image)
 // 人脸位置检测方法，返回人脸位置信息
 QVariantMap FaceRecognizer::detectFacePosition(const QString &imagePath)
 {
+    if (!isInferenceThread()) {
+        initialize();
+        QVariantMap result = runOnInferenceThread([&]() { return detectFacePosition(imagePath); });
+        fillRotationAngle(result);
+        return result;
+    }
+    PERF_TRACE_METHOD();
     QVariantMap result;
     result["faceDetected"] = false;
     
@@ -772,30 +534,28 @@ QVariantMap FaceRecognizer::detectFacePosition(const QString &imagePath)
         }
     }
     
-    // 确保模型已初始化
+    // 模型由调用线程加载，推理线程上不加载
     if (!m_initialized) {
-        qDebug() << "人脸检测模型未初始化，尝试初始化...";
-        if (!initialize()) {
-            qDebug() << "人脸检测模型初始化失败.";
-            qDebug() << "----- 人脸检测失败：模型初始化失败 -----";
-            return result;
-        }
+        qDebug() << "----- 人脸检测失败：模型未初始化 -----";
+        return result;
     }
     
     try {
         // 加载图像
         qDebug() << "加载图像:" << fileInfo.absoluteFilePath();
-        QImage image = loadImage(fileInfo.absoluteFilePath());
+        QSize originalSize;
+        QImage image = loadWorkingImage(fileInfo.absoluteFilePath(), &originalSize);
         if (image.isNull()) {
             qDebug() << "无法加载人脸跟踪图像:" << fileInfo.absoluteFilePath();
             qDebug() << "----- 人脸检测失败：无法加载图像 -----";
             return result;
         }
         
-        // 记录图像尺寸
-        result["imageWidth"] = image.width();
-        result["imageHeight"] = image.height();
-        qDebug() << "人脸跟踪图像尺寸:" << image.width() << "x" << image.height();
+        // 记录原图尺寸，返回的人脸框为原图坐标
+        result["imageWidth"] = originalSize.width();
+        result["imageHeight"] = originalSize.height();
+        qDebug() << "人脸跟踪图像尺寸:" << originalSize.width() << "x" << originalSize.height()
+                 << "工作尺寸:" << image.width() << "x" << image.height();
         
         // 将QImage转换为OpenCV Mat
         cv::Mat mat = qImageToMat(image);
@@ -808,53 +568,32 @@ QVariantMap FaceRecognizer::detectFacePosition(const QString &imagePath)
         qDebug() << "图像已转换为Mat格式. 尺寸:" << mat.cols << "x" << mat.rows 
                  << ", 通道数:" << mat.channels();
         
-        // 创建SeetaFace的图像对象
-        if (!m_faceDetector) {
-            qDebug() << "人脸检测器为空，重新尝试初始化";
-            if (!initialize()) {
-                qDebug() << "重新初始化失败";
-                qDebug() << "----- 人脸检测失败：检测器初始化失败 -----";
-                return result;
-            }
-            
-            if (!m_faceDetector) {
-                qDebug() << "即使初始化成功，人脸检测器仍然为空";
-                qDebug() << "----- 人脸检测失败：检测器为空 -----";
-                return result;
-            }
-        }
-        
-        seeta::ImageData imageData(mat.cols, mat.rows, mat.channels());
-        imageData.data = mat.data;
-        
         // 检测人脸
-        qDebug() << "开始SeetaFace人脸检测...";
+        qDebug() << "开始人脸检测，后端:" << m_backend->name();
         
-        std::vector<SeetaFaceInfo> faceInfos;
         try {
-            auto faces = m_faceDetector->detect(imageData);
-            qDebug() << "SeetaFace检测到" << faces.size << "个人脸";
+            std::vector<FaceDetection> faces = m_backend->detect(mat);
+            qDebug() << "检测到" << faces.size() << "个人脸";
             
             // 如果检测到人脸
-            if (faces.size > 0) {
+            if (!faces.empty()) {
                 // 获取第一个人脸
-                auto &face = faces.data[0];
+                const FaceDetection &face = faces[0];
                 
                 // 设置人脸位置信息
                 result["faceDetected"] = true;
-                result["x"] = face.pos.x;
-                result["y"] = face.pos.y;
-                result["width"] = face.pos.width;
-                result["height"] = face.pos.height;
+                result["x"] = face.box.x;
+                result["y"] = face.box.y;
+                result["width"] = face.box.width;
+                result["height"] = face.box.height;
                 result["score"] = face.score;
                 
-                // 添加旋转角度信息
-                result["rotationAngle"] = m_rotationAngle;
+                // 人脸框换算回原图坐标
+                scaleFaceBox(result, image.size(), originalSize);
                 
-                qDebug() << "人脸检测成功: 位置(" << face.pos.x << "," << face.pos.y 
-                         << ") 尺寸(" << face.pos.width << "x" << face.pos.height
-                         << ") 置信度:" << face.score
-                         << " 旋转角度:" << m_rotationAngle;
+                qDebug() << "人脸检测成功: 位置(" << face.box.x << "," << face.box.y 
+                         << ") 尺寸(" << face.box.width << "x" << face.box.height
+                         << ") 置信度:" << face.score;
                 
                 // 如果面部置信度太低，可能是误检，标记为未检测到
                 if (face.score < 0.3) {
@@ -880,9 +619,547 @@ QVariantMap FaceRecognizer::detectFacePosition(const QString &imagePath)
     }
 }
 
+QVariantMap FaceRecognizer::trackFacePosition(const QString &imagePath)
+{
+    if (!isInferenceThread()) {
+        initialize();
+        QVariantMap result = runOnInferenceThread([&]() { return trackFacePosition(imagePath); });
+        fillRotationAngle(result);
+        return result;
+    }
+    PERF_TRACE_METHOD();
+    QVariantMap result;
+    result["faceDetected"] = false;
+    
+    if (!m_initialized) {
+        qDebug() << "人脸跟踪失败：模型未初始化";
+        return result;
+    }
+    
+    // 跟踪状态使用工作分辨率坐标，返回前换算回原图坐标
+    QSize originalSize;
+    QImage image = loadWorkingImage(imagePath, &originalSize);
+    if (image.isNull()) {
+        qDebug() << "人脸跟踪失败：无法加载图像" << imagePath;
+        return result;
+    }
+    
+    cv::Mat mat = qImageToMat(image);
+    if (mat.empty()) {
+        qDebug() << "人脸跟踪失败：图像转换失败";
+        return result;
+    }
+    
+    result["imageWidth"] = originalSize.width();
+    result["imageHeight"] = originalSize.height();
+    
+    // 跟踪状态在推理线程上更新，resetTracking和trackId可能在界面线程上同时调用，
+    // 只在读取和更新跟踪状态时加锁，解码和检测期间不持有锁
+    QSize frameSize(mat.cols, mat.rows);
+    bool keyframe = true;
+    QRectF trackedBox;
+    int resets = 0;
+    {
+        QMutexLocker locker(&m_trackingMutex);
+        // 分辨率变化时重新开始跟踪
+        if (frameSize != m_trackingFrameSize) {
+            clearTracking();
+            m_trackingFrameSize = frameSize;
+        }
+        keyframe = !m_trackingActive || m_framesSinceKeyframe >= m_keyframeInterval;
+        trackedBox = m_trackedBox;
+        resets = m_trackingResets;
+    }
+    
+    cv::Rect frameRect(0, 0, mat.cols, mat.rows);
+    bool found = false;
+    cv::Rect face;
+    float score = 0.0f;
+    
+    try {
+        if (!keyframe) {
+            // 只在上一帧人脸框周围扩展的区域内检测
+            double padX = trackedBox.width() * kTrackingPadding;
+            double padY = trackedBox.height() * kTrackingPadding;
+            cv::Rect region(cvFloor(trackedBox.x() - padX), cvFloor(trackedBox.y() - padY),
+                            cvCeil(trackedBox.width() + 2 * padX), cvCeil(trackedBox.height() + 2 * padY));
+            region &= frameRect;
+            if (region.area() > 0) {
+                found = detectFaceInRegion(mat, region, face, score);
+            }
+            
+            // 区域内跟丢时立即全图检测
+            if (!found) {
+                keyframe = true;
+            }
+        }
+        
+        if (keyframe) {
+            found = detectFaceInRegion(mat, frameRect, face, score);
+        }
+    } catch (const std::exception &e) {
+        qDebug() << "人脸跟踪过程中发生异常:" << e.what();
+        QMutexLocker locker(&m_trackingMutex);
+        clearTracking();
+        return result;
+    }
+    
+    result["keyframe"] = keyframe;
+    
+    QMutexLocker locker(&m_trackingMutex);
+    // 检测期间被resetTracking重置时丢弃本帧结果
+    if (m_trackingResets != resets) {
+        return result;
+    }
+    
+    if (!found) {
+        if (m_trackingActive) {
+            qDebug() << "人脸跟踪丢失";
+        }
+        clearTracking();
+        return result;
+    }
+    
+    updateTrackedBox(face);
+    m_framesSinceKeyframe = keyframe ? 0 : m_framesSinceKeyframe + 1;
+    m_trackScore = score;
+    
+    result["faceDetected"] = true;
+    result["trackId"] = m_trackId;
+    result["x"] = qRound(m_trackedBox.x());
+    result["y"] = qRound(m_trackedBox.y());
+    result["width"] = qRound(m_trackedBox.width());
+    result["height"] = qRound(m_trackedBox.height());
+    result["score"] = score;
+    scaleFaceBox(result, image.size(), originalSize);
+    return result;
+}
+
+bool FaceRecognizer::trackFacePositionAsync(const QString &imagePath)
+{
+    PERF_TRACE_METHOD();
+    // 模型加载完成后再提交，加载期间丢弃帧，界面线程不等待加载
+    if (!m_initialized) {
+        initializeAsync();
+        return false;
+    }
+    
+    QPointer<FaceRecognizer> self(this);
+    return InferenceExecutor::getInstance().tryPost([self, imagePath]() {
+        if (!self) {
+            return;
+        }
+        QVariantMap result = self->trackFacePosition(imagePath);
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [self, result]() mutable {
+            if (self) {
+                self->fillRotationAngle(result);
+                emit self->faceTracked(result);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void FaceRecognizer::fillRotationAngle(QVariantMap &result) const
+{
+    if (result["faceDetected"].toBool()) {
+        result["rotationAngle"] = m_rotationAngle;
+    }
+}
+
+void FaceRecognizer::resetTracking()
+{
+    PERF_TRACE_METHOD();
+    QMutexLocker locker(&m_trackingMutex);
+    clearTracking();
+    ++m_trackingResets;
+}
+
+int FaceRecognizer::trackId(float *score) const
+{
+    QMutexLocker locker(&m_trackingMutex);
+    if (score) {
+        *score = m_trackingActive ? m_trackScore : 0.0f;
+    }
+    return m_trackingActive ? m_trackId : 0;
+}
+
+void FaceRecognizer::clearTracking()
+{
+    m_trackingActive = false;
+    m_framesSinceKeyframe = 0;
+    m_trackedBox = QRectF();
+}
+
+void FaceRecognizer::setKeyframeInterval(int interval)
+{
+    interval = qMax(1, interval);
+    if (m_keyframeInterval == interval) {
+        return;
+    }
+    {
+        QMutexLocker locker(&m_trackingMutex);
+        m_keyframeInterval = interval;
+    }
+    emit keyframeIntervalChanged();
+}
+
+bool FaceRecognizer::detectFaceInRegion(const cv::Mat &mat, const cv::Rect &region, cv::Rect &face, float &score)
+{
+    std::vector<FaceDetection> faces = m_backend->detect(mat(region));
+    int best = bestFace(faces);
+    if (best < 0) {
+        return false;
+    }
+    
+    face = faces[best].box + region.tl();
+    score = faces[best].score;
+    return true;
+}
+
+void FaceRecognizer::updateTrackedBox(const cv::Rect &face)
+{
+    QRectF detected(face.x, face.y, face.width, face.height);
+    
+    // 开始跟踪或人脸框跳变时视为新的一条轨迹
+    if (!m_trackingActive) {
+        m_trackedBox = detected;
+        m_trackingActive = true;
+        ++m_trackId;
+        return;
+    }
+    
+    // 人脸框跳变（例如换了一个人）时直接采用新结果，否则做指数平滑减少抖动
+    double intersection = rectArea(detected.intersected(m_trackedBox));
+    double iou = intersection / (rectArea(detected) + rectArea(m_trackedBox) - intersection);
+    if (iou < kResetIoU) {
+        m_trackedBox = detected;
+        ++m_trackId;
+        return;
+    }
+    
+    m_trackedBox = QRectF(
+        m_trackedBox.x() + kSmoothingFactor * (detected.x() - m_trackedBox.x()),
+        m_trackedBox.y() + kSmoothingFactor * (detected.y() - m_trackedBox.y()),
+        m_trackedBox.width() + kSmoothingFactor * (detected.width() - m_trackedBox.width()),
+        m_trackedBox.height() + kSmoothingFactor * (detected.height() - m_trackedBox.height()));
+}
+
+QVariantMap FaceRecognizer::assessFaceQuality(const QString &imagePath)
+{
+    if (!isInferenceThread()) {
+        initialize();
+        return runOnInferenceThread([&]() { return assessFaceQuality(imagePath); });
+    }
+    PERF_TRACE_METHOD();
+    QVariantMap result;
+    result["faceDetected"] = false;
+    result["acceptable"] = false;
+    result["reason"] = "no_face";
+    result["message"] = "未检测到人脸，请正对摄像头";
+    
+    if (!m_initialized) {
+        qDebug() << "人脸质量评估失败：模型未初始化";
+        return result;
+    }
+    
+    QSize originalSize;
+    QImage image = loadWorkingImage(imagePath, &originalSize);
+    if (image.isNull()) {
+        qDebug() << "人脸质量评估失败：无法加载图像" << imagePath;
+        return result;
+    }
+    
+    cv::Mat mat = qImageToMat(image);
+    if (mat.empty()) {
+        qDebug() << "人脸质量评估失败：图像转换失败";
+        return result;
+    }
+    
+    result["imageWidth"] = originalSize.width();
+    result["imageHeight"] = originalSize.height();
+    
+    try {
+        // 取置信度最高的人脸
+        std::vector<FaceDetection> faces = m_backend->detect(mat);
+        int best = bestFace(faces);
+        if (best < 0) {
+            return result;
+        }
+        
+        evaluateFaceQuality(m_backend.data(), mat, faces[best], kQualityMinFaceSize, result);
+        scaleFaceBox(result, image.size(), originalSize);
+    } catch (const std::exception &e) {
+        qDebug() << "人脸质量评估过程中发生异常:" << e.what();
+        return result;
+    }
+    
+    qDebug() << "人脸质量:" << result["reason"].toString()
+             << "置信度" << result["score"].toFloat()
+             << "尺寸" << result["faceSize"].toInt()
+             << "清晰度" << result["sharpness"].toDouble()
+             << "姿态(roll/yaw/pitch)" << result["roll"].toDouble() << result["yaw"].toDouble() << result["pitch"].toDouble();
+    return result;
+}
+
+QVector<float> FaceRecognizer::extractFeatureVector(const QString &imagePath, QVariantMap *quality)
+{
+    if (!isInferenceThread()) {
+        initialize();
+        return runOnInferenceThread([&]() { return extractFeatureVector(imagePath, quality); });
+    }
+    
+    QVector<float> feature;
+    if (quality) {
+        (*quality)["faceDetected"] = false;
+        (*quality)["acceptable"] = false;
+        (*quality)["reason"] = "no_face";
+        (*quality)["message"] = "未检测到人脸，请正对摄像头";
+    }
+    
+    if (!m_initialized) {
+        qDebug() << "提取人脸特征失败：模型未初始化";
+        return feature;
+    }
+    
+    QSize originalSize;
+    QImage image = loadWorkingImage(imagePath, &originalSize);
+    if (image.isNull()) {
+        qDebug() << "提取人脸特征失败：无法加载图像" << imagePath;
+        return feature;
+    }
+    
+    cv::Mat mat = qImageToMat(image);
+    if (mat.empty()) {
+        qDebug() << "提取人脸特征失败：图像转换失败";
+        return feature;
+    }
+    
+    try {
+        // 取置信度最高的人脸，质量评估和特征提取共用同一次检测和特征点定位
+        std::vector<FaceDetection> faces = m_backend->detect(mat);
+        int best = bestFace(faces);
+        if (best < 0) {
+            qDebug() << "提取人脸特征失败：未检测到人脸" << imagePath;
+            return feature;
+        }
+        FaceDetection &face = faces[best];
+        
+        if (quality) {
+            (*quality)["imageWidth"] = originalSize.width();
+            (*quality)["imageHeight"] = originalSize.height();
+            evaluateFaceQuality(m_backend.data(), mat, face, kQualityMinFaceSize, *quality);
+            scaleFaceBox(*quality, image.size(), originalSize);
+            if (!(*quality)["acceptable"].toBool()) {
+                return feature;
+            }
+        }
+        
+        if (!m_backend->align(mat, face)) {
+            qDebug() << "提取人脸特征失败：特征点定位失败";
+            return feature;
+        }
+        
+        feature = m_backend->embed(mat, face);
+        if (feature.isEmpty()) {
+            qDebug() << "提取人脸特征失败：特征提取失败";
+        }
+    } catch (const std::exception &e) {
+        qDebug() << "提取人脸特征过程中发生异常:" << e.what();
+        feature.clear();
+    }
+    
+    return feature;
+}
+
+float FaceRecognizer::calculateSimilarity(const QVector<float> &feature1, const QVector<float> &feature2)
+{
+    if (!m_initialized) {
+        return 0.0f;
+    }
+    return m_backend->similarity(feature1, feature2);
+}
+
+int FaceRecognizer::featureSize() const
+{
+    return m_initialized ? m_backend->featureSize() : 0;
+}
+
+QList<FaceRecognizer::FaceFeature> FaceRecognizer::extractAllFeatureVectors(const QString &imagePath, QSize *imageSize)
+{
+    if (!isInferenceThread()) {
+        initialize();
+        return runOnInferenceThread([&]() { return extractAllFeatureVectors(imagePath, imageSize); });
+    }
+    PERF_TRACE_METHOD();
+    QList<FaceFeature> results;
+    
+    if (!m_initialized) {
+        qDebug() << "批量提取人脸特征失败：模型未初始化";
+        return results;
+    }
+    
+    QSize originalSize;
+    QImage image = loadWorkingImage(imagePath, &originalSize);
+    if (image.isNull()) {
+        qDebug() << "批量提取人脸特征失败：无法加载图像" << imagePath;
+        return results;
+    }
+    if (imageSize) {
+        *imageSize = originalSize;
+    }
+    
+    cv::Mat mat = qImageToMat(image);
+    if (mat.empty()) {
+        qDebug() << "批量提取人脸特征失败：图像转换失败";
+        return results;
+    }
+    
+    // 整幅图像只检测一次
+    std::vector<FaceDetection> faces;
+    try {
+        faces = m_backend->detect(mat);
+    } catch (const std::exception &e) {
+        qDebug() << "批量提取人脸特征时检测异常:" << e.what();
+        return results;
+    }
+    faces.erase(std::remove_if(faces.begin(), faces.end(), [](const FaceDetection &face) {
+        return face.score < kMinFaceScore;
+    }), faces.end());
+    if (faces.empty()) {
+        return results;
+    }
+    
+    // 在推理线程上逐个做质量评估、特征点定位和特征提取，只使用一份模型；
+    // 界面上逐帧签到时由DatabaseManager::recognizeAllFacesAsync提交，界面线程不等待
+    int faceCount = static_cast<int>(faces.size());
+    for (FaceDetection &face : faces) {
+        FaceFeature result;
+        result.score = face.score;
+        try {
+            evaluateFaceQuality(m_backend.data(), mat, face, kGroupQualityMinFaceSize, result.quality);
+            scaleFaceBox(result.quality, image.size(), originalSize);
+            if (result.quality["acceptable"].toBool() && m_backend->align(mat, face)) {
+                result.feature = m_backend->embed(mat, face);
+            }
+        } catch (const std::exception &e) {
+            qDebug() << "批量提取人脸特征过程中发生异常:" << e.what();
+            result.feature.clear();
+        }
+        result.box = QRect(result.quality["x"].toInt(), result.quality["y"].toInt(),
+                           result.quality["width"].toInt(), result.quality["height"].toInt());
+        results.append(result);
+    }
+    
+    qDebug() << "批量提取人脸特征: 人脸" << faceCount;
+    PERF_TRACE_ROWS(faceCount);
+    return results;
+}
+
+void FaceRecognizer::evaluateFaceQuality(FaceBackend *backend, const cv::Mat &mat, FaceDetection &face, int minFaceSize, QVariantMap &result)
+{
+    const cv::Rect &box = face.box;
+    int faceSize = qMin(box.width, box.height);
+    
+    result["faceDetected"] = true;
+    result["x"] = box.x;
+    result["y"] = box.y;
+    result["width"] = box.width;
+    result["height"] = box.height;
+    result["score"] = face.score;
+    result["faceSize"] = faceSize;
+    
+    // 按开销从小到大依次检查，前面不合格时不再计算后面的指标
+    if (face.score < kQualityMinScore) {
+        result["reason"] = "low_score";
+        result["message"] = "人脸不够清楚，请正对摄像头";
+        return;
+    }
+    
+    if (faceSize < minFaceSize) {
+        result["reason"] = "too_small";
+        result["message"] = "请靠近摄像头一些";
+        return;
+    }
+    
+    // 清晰度：人脸区域灰度图缩放到固定尺寸后的拉普拉斯方差
+    cv::Rect faceRect = box & cv::Rect(0, 0, mat.cols, mat.rows);
+    if (faceRect.area() <= 0) {
+        result["reason"] = "too_small";
+        result["message"] = "请将面部移到画面中央";
+        return;
+    }
+    cv::Mat gray;
+    if (mat.channels() == 1) {
+        gray = mat(faceRect);
+    } else {
+        cv::cvtColor(mat(faceRect), gray, cv::COLOR_BGR2GRAY);
+    }
+    cv::resize(gray, gray, cv::Size(kSharpnessSize, kSharpnessSize), 0, 0, cv::INTER_AREA);
+    cv::Mat laplacian;
+    cv::Laplacian(gray, laplacian, CV_64F);
+    cv::Scalar mean, stddev;
+    cv::meanStdDev(laplacian, mean, stddev);
+    double sharpness = stddev[0] * stddev[0];
+    result["sharpness"] = sharpness;
+    
+    if (sharpness < kQualityMinSharpness) {
+        result["reason"] = "blurry";
+        result["message"] = "画面模糊，请保持不动";
+        return;
+    }
+    
+    // 姿态：由5点特征点（左眼、右眼、鼻尖、左嘴角、右嘴角）估计
+    if (!backend->align(mat, face)) {
+        result["reason"] = "no_landmarks";
+        result["message"] = "请正对摄像头";
+        return;
+    }
+    const std::vector<cv::Point2f> &points = face.landmarks;
+    
+    double eyeDx = points[1].x - points[0].x;
+    double eyeDy = points[1].y - points[0].y;
+    double eyeDistance = std::sqrt(eyeDx * eyeDx + eyeDy * eyeDy);
+    if (eyeDistance < 1.0) {
+        result["reason"] = "off_angle";
+        result["message"] = "请正对摄像头";
+        return;
+    }
+    double roll = std::atan2(eyeDy, eyeDx) * 180.0 / CV_PI;
+    
+    // 先按roll转正，再计算鼻尖相对眼睛和嘴巴的位置
+    double cosRoll = eyeDx / eyeDistance;
+    double sinRoll = eyeDy / eyeDistance;
+    double eyeMidX = (points[0].x + points[1].x) / 2.0;
+    double eyeMidY = (points[0].y + points[1].y) / 2.0;
+    auto alignedX = [&](const cv::Point2f &p) { return (p.x - eyeMidX) * cosRoll + (p.y - eyeMidY) * sinRoll; };
+    auto alignedY = [&](const cv::Point2f &p) { return -(p.x - eyeMidX) * sinRoll + (p.y - eyeMidY) * cosRoll; };
+    
+    double noseX = alignedX(points[2]);
+    double noseY = alignedY(points[2]);
+    double mouthY = (alignedY(points[3]) + alignedY(points[4])) / 2.0;
+    
+    double yaw = noseX / eyeDistance;
+    double pitch = mouthY > 1.0 ? noseY / mouthY : 0.0;
+    result["roll"] = roll;
+    result["yaw"] = yaw;
+    result["pitch"] = pitch;
+    
+    if (std::abs(roll) > kQualityMaxRoll || std::abs(yaw) > kQualityMaxYaw
+            || pitch < kQualityMinPitch || pitch > kQualityMaxPitch) {
+        result["reason"] = "off_angle";
+        result["message"] = "请正对摄像头，不要侧脸或低头";
+        return;
+    }
+    
+    result["acceptable"] = true;
+    result["reason"] = "ok";
+    result["message"] = "";
+}
+
 // 开始人脸追踪框的逆时针旋转
 void FaceRecognizer::startRotation(int interval, float speed)
 {
+    PERF_TRACE_METHOD();
     m_rotationSpeed = speed;
     
     // 如果定时器已经运行，先停止
@@ -900,6 +1177,7 @@ void FaceRecognizer::startRotation(int interval, float speed)
 // 停止人脸追踪框的旋转
 void FaceRecognizer::stopRotation()
 {
+    PERF_TRACE_METHOD();
     if (m_rotationTimer->isActive()) {
         m_rotationTimer->stop();
         qDebug() << "停止人脸追踪框旋转";
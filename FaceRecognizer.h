@@ -9,21 +9,30 @@
 #include <QVariantMap>
 #include <QTimer>
 #include <QDir>
+#include <QSharedPointer>
+#include <QRect>
+#include <QRectF>
+#include <QSize>
+#include <QVector>
+#include <QVariantList>
+#include <QMutex>
 
-// SeetaFace2 include files
-#include <seeta/FaceDetector.h>
-#include <seeta/FaceRecognizer.h>
-#include <seeta/FaceLandmarker.h>
+#include "FaceBackend.h"
 
 /**
  * @brief 人脸识别器类
  * 
- * 使用OpenCV和SeetaFace2进行人脸检测和识别
+ * 人脸检测、对齐和特征提取由FaceBackend完成（SeetaFace2或OpenCV DNN，由设置项 face_backend 选择），
+ * 推理在InferenceExecutor的推理线程上执行，从其他线程调用时先在调用线程上加载模型，再等待推理线程完成，
+ * 推理线程上模型未加载时直接返回失败
  */
 class FaceRecognizer : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(float rotationAngle READ rotationAngle NOTIFY rotationAngleChanged)
+    Q_PROPERTY(bool initialized READ isInitialized NOTIFY initializedChanged)
+    Q_PROPERTY(int keyframeInterval READ keyframeInterval WRITE setKeyframeInterval NOTIFY keyframeIntervalChanged)
+    Q_PROPERTY(QString backend READ backendName NOTIFY initializedChanged)
 
 public:
     explicit FaceRecognizer(QObject *parent = nullptr);
@@ -35,6 +44,19 @@ public:
      */
     Q_INVOKABLE bool initialize();
 
+    /**
+     * @brief 在后台线程中定位并加载模型，完成后发出initializedChanged
+     *
+     * 界面显示后调用，避免模型加载阻塞启动。加载完成前调用initialize()会等待后台加载结束。
+     */
+    Q_INVOKABLE void initializeAsync();
+
+    // 模型是否已加载
+    bool isInitialized() const { return m_initialized; }
+
+    // 使用的后端名称，加载前为配置的后端，加载后为实际加载的后端
+    QString backendName() const;
+
     /**
      * @brief 从图像中检测人脸
      * @param imagePath 图像路径
@@ -64,6 +86,16 @@ public:
      */
     Q_INVOKABLE QImage loadImage(const QString &imagePath);
 
+    /**
+     * @brief 按工作分辨率加载图像，用于检测和特征提取
+     *
+     * 先读取文件头获得原图尺寸，长边超过工作分辨率时通过QImageReader::setScaledSize直接解码为缩小后的图像，
+     * JPEG由libjpeg在DCT域缩小，不解码全分辨率像素。
+     * @param originalSize 不为空时返回原图尺寸，用于把人脸框换算回原图坐标
+     * @return 图像，加载失败时为空
+     */
+    QImage loadWorkingImage(const QString &imagePath, QSize *originalSize = nullptr);
+
     /**
      * @brief 转换OpenCV Mat到QImage
      * @param mat OpenCV Mat图像
@@ -78,9 +110,86 @@ public:
      */
     Q_INVOKABLE cv::Mat qImageToMat(const QImage &image);
 
-    // 用于人脸跟踪的方法，返回人脸位置信息
+    // 用于人脸跟踪的方法，返回人脸位置信息（原图坐标）
     Q_INVOKABLE QVariantMap detectFacePosition(const QString &imagePath);
 
+    /**
+     * @brief 连续帧人脸跟踪
+     *
+     * 每隔keyframeInterval帧（或跟踪丢失时）在整幅图像上检测人脸，
+     * 其余帧只在上一帧人脸框周围扩展的区域内检测，结果经过平滑后返回。
+     * @param imagePath 当前帧图像路径
+     * @return 与detectFacePosition相同的字段，另有keyframe表示本帧是否为全图检测，trackId为轨迹编号
+     */
+    Q_INVOKABLE QVariantMap trackFacePosition(const QString &imagePath);
+
+    /**
+     * @brief 在推理线程上异步跟踪一帧，结果通过faceTracked发出
+     *
+     * 推理线程正忙或模型尚未加载完成时丢弃本帧（未加载时在后台开始加载），界面线程不等待推理。
+     * @return 是否已提交
+     */
+    Q_INVOKABLE bool trackFacePositionAsync(const QString &imagePath);
+
+    /**
+     * @brief 当前跟踪的人脸轨迹
+     *
+     * 跟踪中断（丢失、分辨率变化、resetTracking）或人脸框跳变后编号改变，编号不变即为同一张人脸。
+     * @param score 不为空时返回最近一帧的检测置信度
+     * @return 轨迹编号，未在跟踪时为0
+     */
+    int trackId(float *score = nullptr) const;
+
+    // 清除跟踪状态，下一帧重新全图检测（开始或结束跟踪时调用）
+    Q_INVOKABLE void resetTracking();
+
+    /**
+     * @brief 评估图像中人脸的质量，判断是否值得提取特征进行识别
+     *
+     * 依次检查检测置信度、人脸框大小、清晰度（人脸区域拉普拉斯方差）和姿态（由5点特征点估计），
+     * 只做检测和特征点定位，不提取特征。
+     * @param imagePath 图像路径
+     * @return faceDetected、acceptable、reason（不合格原因代码）、message（提示语）、
+     *         score、faceSize、sharpness、roll（度）、yaw、pitch（归一化偏移）以及人脸框位置，
+     *         人脸框和imageWidth、imageHeight为原图坐标，faceSize和sharpness按工作分辨率计算
+     */
+    Q_INVOKABLE QVariantMap assessFaceQuality(const QString &imagePath);
+
+    /**
+     * @brief 提取图像中置信度最高的人脸的特征向量
+     * @param imagePath 图像路径
+     * @param quality 不为空时先评估人脸质量（字段同assessFaceQuality），不合格则不提取特征
+     * @return 特征向量，未检测到人脸、质量不合格或提取失败时为空
+     */
+    QVector<float> extractFeatureVector(const QString &imagePath, QVariantMap *quality = nullptr);
+
+    // 两个特征向量的相似度，与compareFaces的得分一致
+    float calculateSimilarity(const QVector<float> &feature1, const QVector<float> &feature2);
+
+    // 特征向量维度，模型未加载时为0
+    int featureSize() const;
+
+    // 图像中的一张人脸及其特征
+    struct FaceFeature {
+        QRect box;                // 原图坐标
+        float score = 0.0f;       // 检测置信度
+        QVariantMap quality;      // 字段同assessFaceQuality
+        QVector<float> feature;   // 质量不合格或提取失败时为空
+    };
+
+    /**
+     * @brief 提取图像中所有人脸的特征（多人同时签到）
+     *
+     * 整幅图像只检测一次，各人脸的质量评估、特征点定位和特征提取在推理线程上依次执行，
+     * 人脸尺寸门限低于assessFaceQuality（多人同框时每张人脸较小）。从其他线程调用时等待全部人脸完成。
+     * @param imageSize 不为空时返回原图尺寸
+     * @return 每张人脸一项，按检测顺序排列
+     */
+    QList<FaceFeature> extractAllFeatureVectors(const QString &imagePath, QSize *imageSize = nullptr);
+
+    int keyframeInterval() const { return m_keyframeInterval; }
+    void setKeyframeInterval(int interval);
+
     // 获取当前旋转角度
     float rotationAngle() const { return m_rotationAngle; }
 
@@ -100,19 +209,31 @@ signals:
     // 当旋转角度改变时发出信号
     void rotationAngleChanged();
 
+    // 模型加载完成
+    void initializedChanged();
+
+    // 后台加载模型失败
+    void initializationFailed();
+
+    void keyframeIntervalChanged();
+
+    // 异步跟踪的结果，字段与trackFacePosition相同
+    void faceTracked(const QVariantMap &faceInfo);
+
 private slots:
     // 更新旋转角度
     void updateRotation();
 
 private:
-    // SeetaFace2 models
-    seeta::FaceDetector *m_faceDetector;
-    seeta::FaceLandmarker *m_faceLandmarker;
-    seeta::FaceRecognizer *m_faceRecognizer;
-
+    // 共享的识别后端（按线程管理）
+    QSharedPointer<FaceBackend> m_backend;
+    
     // 模型是否已初始化
     bool m_initialized;
 
+    // 是否正在后台加载模型
+    bool m_loading;
+
     // 模型路径
     QString m_modelPath;
 
@@ -125,11 +246,41 @@ private:
     // 用于控制旋转的定时器
     QTimer *m_rotationTimer;
     
-    // 递归搜索模型文件的辅助方法
-    QStringList findModelFiles(const QDir &dir);
+    // 人脸跟踪状态
+    bool m_trackingActive;
+    int m_framesSinceKeyframe;
+    int m_keyframeInterval;
+    QRectF m_trackedBox;       // 平滑后的人脸框
+    QSize m_trackingFrameSize;
+    int m_trackId;             // 轨迹编号，每开始一条新轨迹加一
+    float m_trackScore;        // 最近一帧的检测置信度
+    int m_trackingResets;      // resetTracking的调用次数，检测期间变化时丢弃本帧结果
+    mutable QMutex m_trackingMutex;    // 保护以上跟踪状态
+    
+    // 在图像的指定区域内检测置信度最高的人脸，返回整幅图像坐标
+    bool detectFaceInRegion(const cv::Mat &mat, const cv::Rect &region, cv::Rect &face, float &score);
+    
+    // 处理file:// URL和相对于程序目录的路径
+    QString resolveImagePath(const QString &imagePath) const;
+    
+    // 清除跟踪状态，调用方持有m_trackingMutex
+    void clearTracking();
+    
+    // 用新检测到的人脸框更新平滑后的跟踪框
+    void updateTrackedBox(const cv::Rect &face);
+    
+    // 根据检测结果和特征点评估人脸质量，结果写入result，需要时用backend补充face的特征点
+    // minFaceSize为人脸框最小边长，多人签到时低于单人门限
+    void evaluateFaceQuality(FaceBackend *backend, const cv::Mat &mat, FaceDetection &face, int minFaceSize, QVariantMap &result);
+    
+    // 检测到人脸时填入当前旋转角度，旋转角度只在界面线程上读写，不在推理线程上调用
+    void fillRotationAngle(QVariantMap &result) const;
+    
+    // 使用共享的识别后端
+    bool attachBackend(const QSharedPointer<FaceBackend> &backend);
     
-    // 紧急初始化方法 - 使用硬编码路径
-    bool emergency_initialize();
+    // 释放对共享模型的引用
+    void releaseModels();
 };
 
 #endif // FACERECOGNIZER_H 
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "FileManager.h"
+#include "PerfTrace.h"
 #include <QDebug>
 #include <QDir>
 #include <QFile>
@@ -16,6 +17,7 @@ FileManager::FileManager(QObject *parent) : QObject(parent) {}
 
 bool FileManager::copyFile(const QString &sourcePath, const QString &destinationPath)
 {
+    PERF_TRACE_METHOD();
     QFile sourceFile(sourcePath);
     if (!sourceFile.exists())
     {
@@ -40,6 +42,7 @@ bool FileManager::copyFile(const QString &sourcePath, const QString &destination
 
 bool FileManager::moveFile(const QString &sourcePath, const QString &destinationPath)
 {
+    PERF_TRACE_METHOD();
     QFile sourceFile(sourcePath);
     if (!sourceFile.exists())
     {
@@ -64,11 +67,13 @@ bool FileManager::moveFile(const QString &sourcePath, const QString &destination
 
 QString FileManager::getApplicationDir()
 {
+    PERF_TRACE_METHOD();
     return QCoreApplication::applicationDirPath();
 }
 
 bool FileManager::createDirectory(const QString &dirPath)
 {
+    PERF_TRACE_METHOD();
     QDir dir;
     if (!dir.exists(dirPath)) {
         return dir.mkpath(dirPath);
@@ -78,12 +83,14 @@ bool FileManager::createDirectory(const QString &dirPath)
 
 bool FileManager::directoryExists(const QString &dirPath)
 {
+    PERF_TRACE_METHOD();
     QDir dir(dirPath);
     return dir.exists();
 }
 
 QString FileManager::getFolderPath(const QString &title)
 {
+    PERF_TRACE_METHOD();
     QString dir = QFileDialog::getExistingDirectory(
         nullptr, 
         title,
@@ -101,6 +108,7 @@ QString FileManager::getFolderPath(const QString &title)
 
 QVariantList FileManager::readExcelFile(const QString &filePath)
 {
+    PERF_TRACE_METHOD();
     QVariantList result;
     
     // 检查文件是否存在
@@ -172,11 +180,13 @@ QVariantList FileManager::readExcelFile(const QString &filePath)
     }
     
     qDebug() << "成功读取" << result.size() << "条记录";
+    PERF_TRACE_ROWS(result.size());
     return result;
 }
 
 QStringList FileManager::getExcelHeaders(const QString &filePath)
 {
+    PERF_TRACE_METHOD();
     QStringList headers;
     
     // 检查文件是否存在
@@ -210,11 +220,13 @@ QStringList FileManager::getExcelHeaders(const QString &filePath)
         headers.append(header);
     }
     
+    PERF_TRACE_ROWS(headers.size());
     return headers;
 }
 
 bool FileManager::validateExcelStructure(const QString &filePath)
 {
+    PERF_TRACE_METHOD();
     // 获取表头
     QStringList headers = getExcelHeaders(filePath);
     
@@ -267,6 +279,7 @@ bool FileManager::validateExcelStructure(const QString &filePath)
 
 bool FileManager::validateKnowledgePointExcelStructure(const QString &filePath)
 {
+    PERF_TRACE_METHOD();
     // 获取表头
     QStringList headers = getExcelHeaders(filePath);
     
@@ -303,6 +316,7 @@ bool FileManager::validateKnowledgePointExcelStructure(const QString &filePath)
 
 QString FileManager::getOpenFilePath(const QString &title, const QString &filter)
 {
+    PERF_TRACE_METHOD();
     QString filePath = QFileDialog::getOpenFileName(
         nullptr, 
         title,
@@ -0,0 +1,498 @@
+#include "HnswIndex.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+namespace {
+
+// 索引文件标识和格式版本
+const quint32 kIndexMagic = 0x57534E48;   // "HNSW"
+const quint32 kIndexVersion = 1;
+
+// 文件中每个节点除特征编码外至少占用的字节数：标识长度、删除标记、缩放系数、层数、第0层邻居数
+const qint64 kMinNodeBytes = 4 + 1 + 4 + 4 + 4;
+
+// 层数上限，随机层数超过该值的概率可以忽略
+const int kMaxLevel = 32;
+
+struct ByWorse {
+    template <typename T>
+    bool operator()(const T &a, const T &b) const { return a.similarity > b.similarity; }
+};
+
+struct ByBetter {
+    template <typename T>
+    bool operator()(const T &a, const T &b) const { return a.similarity < b.similarity; }
+};
+
+} // namespace
+
+HnswIndex::HnswIndex(int m, int efConstruction, int efSearch)
+    : m_m(qMax(2, m))
+    , m_efConstruction(qMax(efConstruction, m))
+    , m_efSearch(efSearch)
+    , m_levelMultiplier(1.0 / std::log(static_cast<double>(qMax(2, m))))
+    , m_dimension(0)
+    , m_entryPoint(-1)
+    , m_maxLevel(-1)
+    , m_deletedCount(0)
+    , m_random(42)
+    , m_visitTag(0)
+{
+}
+
+void HnswIndex::clear()
+{
+    m_dimension = 0;
+    m_entryPoint = -1;
+    m_maxLevel = -1;
+    m_deletedCount = 0;
+    m_nodes.clear();
+    m_codes.clear();
+    m_labels.clear();
+    m_visited.clear();
+    m_visitTag = 0;
+}
+
+void HnswIndex::setFeature(const QString &workId, const QVector<float> &feature)
+{
+    if (feature.isEmpty()) {
+        return;
+    }
+
+    if (m_dimension == 0) {
+        m_dimension = feature.size();
+    } else if (feature.size() != m_dimension) {
+        qDebug() << "特征维度不一致，忽略:" << workId << feature.size() << "期望" << m_dimension;
+        return;
+    }
+
+    removeFeature(workId);
+
+    QVector<float> unit = FaceGallery::normalized(feature);
+    QVector<qint8> quantized(m_dimension);
+    float scale = FaceGallery::quantizeInt8(unit.constData(), m_dimension, quantized.data());
+    insertCode(workId, quantized.constData(), scale);
+}
+
+void HnswIndex::removeFeature(const QString &workId)
+{
+    int id = m_labels.value(workId, -1);
+    if (id < 0) {
+        return;
+    }
+    m_labels.remove(workId);
+    m_nodes[id].deleted = true;
+    ++m_deletedCount;
+}
+
+double HnswIndex::deletedRatio() const
+{
+    return m_nodes.isEmpty() ? 0.0 : static_cast<double>(m_deletedCount) / m_nodes.size();
+}
+
+void HnswIndex::compact()
+{
+    if (m_deletedCount == 0) {
+        return;
+    }
+
+    QVector<Node> nodes = m_nodes;
+    QVector<qint8> codes = m_codes;
+    int dimension = m_dimension;
+
+    clear();
+    m_dimension = dimension;
+    for (int id = 0; id < nodes.size(); ++id) {
+        if (!nodes[id].deleted) {
+            insertCode(nodes[id].workId, codes.constData() + static_cast<qint64>(id) * dimension, nodes[id].scale);
+        }
+    }
+}
+
+QList<FaceGallery::Candidate> HnswIndex::candidates(const QVector<float> &feature, int count) const
+{
+    QList<FaceGallery::Candidate> result;
+    if (m_labels.isEmpty() || feature.size() != m_dimension || count <= 0) {
+        return result;
+    }
+
+    QVector<float> unit = FaceGallery::normalized(feature);
+    QVector<qint8> query(m_dimension);
+    float queryScale = FaceGallery::quantizeInt8(unit.constData(), m_dimension, query.data());
+
+    // 在上层贪心下降到离查询最近的入口
+    int entry = m_entryPoint;
+    float entrySimilarity = similarity(query.constData(), queryScale, entry);
+    for (int level = m_maxLevel; level > 0; --level) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int neighbor : m_nodes[entry].links[level]) {
+                float value = similarity(query.constData(), queryScale, neighbor);
+                if (value > entrySimilarity) {
+                    entrySimilarity = value;
+                    entry = neighbor;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // 被删除的节点会占用队列位置，按删除数量放宽队列长度
+    int ef = qMax(m_efSearch, count) + qMin(m_deletedCount, count);
+    QVector<Neighbor> found = searchLayer(query.constData(), queryScale, entry, ef, 0);
+    for (const Neighbor &neighbor : found) {
+        if (m_nodes[neighbor.id].deleted) {
+            continue;
+        }
+        FaceGallery::Candidate candidate;
+        candidate.workId = m_nodes[neighbor.id].workId;
+        candidate.score = neighbor.similarity;
+        result.append(candidate);
+        if (result.size() >= count) {
+            break;
+        }
+    }
+    return result;
+}
+
+qint64 HnswIndex::memoryBytes() const
+{
+    qint64 bytes = static_cast<qint64>(m_codes.size()) * sizeof(qint8)
+            + static_cast<qint64>(m_nodes.size()) * sizeof(Node)
+            + static_cast<qint64>(m_visited.size()) * sizeof(quint32);
+    for (const Node &node : m_nodes) {
+        for (const QVector<int> &links : node.links) {
+            bytes += links.capacity() * sizeof(int);
+        }
+    }
+    return bytes;
+}
+
+QVariantMap HnswIndex::statistics() const
+{
+    QVariantMap stats;
+    stats["count"] = size();
+    stats["nodes"] = m_nodes.size();
+    stats["deleted"] = m_deletedCount;
+    stats["dimension"] = m_dimension;
+    stats["levels"] = m_maxLevel + 1;
+    stats["m"] = m_m;
+    stats["efConstruction"] = m_efConstruction;
+    stats["efSearch"] = m_efSearch;
+    stats["memoryBytes"] = memoryBytes();
+    stats["fullPrecisionBytes"] = static_cast<qint64>(size()) * m_dimension * sizeof(float);
+    return stats;
+}
+
+bool HnswIndex::save(const QString &filePath, const QString &stamp) const
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "无法写入人脸索引文件:" << filePath;
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_15);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    out << kIndexMagic << kIndexVersion << stamp
+        << qint32(m_m) << qint32(m_efConstruction) << qint32(m_dimension)
+        << qint32(m_entryPoint) << qint32(m_maxLevel) << qint32(m_nodes.size());
+    for (const Node &node : m_nodes) {
+        out << node.workId << node.deleted << node.scale << node.links;
+    }
+    out << QByteArray::fromRawData(reinterpret_cast<const char *>(m_codes.constData()), m_codes.size());
+
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        qDebug() << "保存人脸索引失败:" << filePath;
+        return false;
+    }
+    return true;
+}
+
+bool HnswIndex::load(const QString &filePath, const QString &stamp)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_15);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString fileStamp;
+    in >> magic >> version >> fileStamp;
+    if (magic != kIndexMagic || version != kIndexVersion) {
+        qDebug() << "人脸索引文件格式不匹配:" << filePath;
+        return false;
+    }
+    if (fileStamp != stamp) {
+        qDebug() << "人脸索引文件已过期:" << fileStamp << "当前" << stamp;
+        return false;
+    }
+
+    qint32 m = 0, efConstruction = 0, dimension = 0, entryPoint = -1, maxLevel = -1, nodeCount = 0;
+    in >> m >> efConstruction >> dimension >> entryPoint >> maxLevel >> nodeCount;
+
+    // 每个节点至少占用特征编码和几个定长字段，节点数不可能超过文件大小允许的范围
+    qint64 minNodeBytes = static_cast<qint64>(qMax(0, dimension)) + kMinNodeBytes;
+    if (in.status() != QDataStream::Ok || m <= 0 || efConstruction <= 0 || dimension <= 0
+            || maxLevel < -1 || maxLevel > kMaxLevel
+            || nodeCount < 0 || static_cast<qint64>(nodeCount) * minNodeBytes > file.size()
+            || (nodeCount == 0 ? entryPoint != -1 || maxLevel != -1 : entryPoint < 0 || entryPoint >= nodeCount)) {
+        qDebug() << "人脸索引文件损坏:" << filePath;
+        return false;
+    }
+
+    // 邻居逐层读取并检查，避免损坏的长度字段导致过量分配
+    int linkLimit = m * 2;
+    QVector<Node> nodes(nodeCount);
+    for (Node &node : nodes) {
+        in >> node.workId >> node.deleted >> node.scale;
+        quint32 levels = 0;
+        in >> levels;
+        if (in.status() != QDataStream::Ok || levels == 0 || levels > quint32(maxLevel + 1)) {
+            qDebug() << "人脸索引文件损坏:" << filePath;
+            return false;
+        }
+        node.links.resize(levels);
+        for (QVector<int> &links : node.links) {
+            quint32 count = 0;
+            in >> count;
+            if (in.status() != QDataStream::Ok || count > quint32(linkLimit)) {
+                qDebug() << "人脸索引文件损坏:" << filePath;
+                return false;
+            }
+            links.resize(count);
+            for (int &link : links) {
+                qint32 value = -1;
+                in >> value;
+                link = value;
+            }
+        }
+    }
+    QByteArray codes;
+    in >> codes;
+    if (in.status() != QDataStream::Ok || codes.size() != static_cast<qint64>(nodeCount) * dimension) {
+        qDebug() << "人脸索引文件损坏:" << filePath;
+        return false;
+    }
+
+    // 入口节点必须位于最高层，每个邻居都必须存在且至少有该层
+    if (nodeCount > 0 && nodes[entryPoint].links.size() != maxLevel + 1) {
+        qDebug() << "人脸索引文件损坏:" << filePath;
+        return false;
+    }
+    for (const Node &node : nodes) {
+        for (int level = 0; level < node.links.size(); ++level) {
+            for (int link : node.links[level]) {
+                if (link < 0 || link >= nodeCount || nodes[link].links.size() <= level) {
+                    qDebug() << "人脸索引文件损坏:" << filePath;
+                    return false;
+                }
+            }
+        }
+    }
+
+    clear();
+    m_m = m;
+    m_efConstruction = efConstruction;
+    m_levelMultiplier = 1.0 / std::log(static_cast<double>(qMax(2, m)));
+    m_dimension = dimension;
+    m_entryPoint = entryPoint;
+    m_maxLevel = maxLevel;
+    m_nodes = nodes;
+    m_codes.resize(codes.size());
+    std::copy(codes.constBegin(), codes.constEnd(), reinterpret_cast<char *>(m_codes.data()));
+    for (int id = 0; id < m_nodes.size(); ++id) {
+        if (m_nodes[id].deleted) {
+            ++m_deletedCount;
+        } else {
+            m_labels.insert(m_nodes[id].workId, id);
+        }
+    }
+    m_visited.resize(m_nodes.size());
+    return true;
+}
+
+void HnswIndex::insertCode(const QString &workId, const qint8 *featureCode, float scale)
+{
+    int id = m_nodes.size();
+    int level = randomLevel();
+
+    m_codes.resize(m_codes.size() + m_dimension);
+    std::copy(featureCode, featureCode + m_dimension, m_codes.data() + static_cast<qint64>(id) * m_dimension);
+
+    Node node;
+    node.workId = workId;
+    node.scale = scale;
+    node.deleted = false;
+    node.links.resize(level + 1);
+    m_nodes.append(node);
+    m_labels.insert(workId, id);
+    m_visited.resize(m_nodes.size());
+
+    if (m_entryPoint < 0) {
+        m_entryPoint = id;
+        m_maxLevel = level;
+        return;
+    }
+
+    const qint8 *query = code(id);
+    int entry = m_entryPoint;
+    float entrySimilarity = similarity(query, scale, entry);
+    for (int l = m_maxLevel; l > level; --l) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int neighbor : m_nodes[entry].links[l]) {
+                float value = similarity(query, scale, neighbor);
+                if (value > entrySimilarity) {
+                    entrySimilarity = value;
+                    entry = neighbor;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    for (int l = qMin(level, m_maxLevel); l >= 0; --l) {
+        QVector<Neighbor> found = searchLayer(query, scale, entry, m_efConstruction, l);
+        QVector<int> neighbors = selectNeighbors(found, m_m);
+        m_nodes[id].links[l] = neighbors;
+        for (int neighbor : neighbors) {
+            m_nodes[neighbor].links[l].append(id);
+            if (m_nodes[neighbor].links[l].size() > maxLinks(l)) {
+                shrinkLinks(neighbor, l, maxLinks(l));
+            }
+        }
+        entry = found.first().id;
+    }
+
+    if (level > m_maxLevel) {
+        m_maxLevel = level;
+        m_entryPoint = id;
+    }
+}
+
+QVector<HnswIndex::Neighbor> HnswIndex::searchLayer(const qint8 *query, float queryScale, int entry, int ef, int level) const
+{
+    if (++m_visitTag == 0) {
+        std::fill(m_visited.begin(), m_visited.end(), 0);
+        m_visitTag = 1;
+    }
+
+    // candidates按相似度从高到低扩展，results保留最相似的ef个（堆顶为其中最差的）
+    std::priority_queue<Neighbor, std::vector<Neighbor>, ByBetter> candidates;
+    std::priority_queue<Neighbor, std::vector<Neighbor>, ByWorse> results;
+
+    Neighbor start = { similarity(query, queryScale, entry), entry };
+    m_visited[entry] = m_visitTag;
+    candidates.push(start);
+    results.push(start);
+
+    while (!candidates.empty()) {
+        Neighbor current = candidates.top();
+        if (current.similarity < results.top().similarity && static_cast<int>(results.size()) >= ef) {
+            break;
+        }
+        candidates.pop();
+
+        for (int neighbor : m_nodes[current.id].links[level]) {
+            if (m_visited[neighbor] == m_visitTag) {
+                continue;
+            }
+            m_visited[neighbor] = m_visitTag;
+
+            float value = similarity(query, queryScale, neighbor);
+            if (static_cast<int>(results.size()) < ef || value > results.top().similarity) {
+                Neighbor next = { value, neighbor };
+                candidates.push(next);
+                results.push(next);
+                if (static_cast<int>(results.size()) > ef) {
+                    results.pop();
+                }
+            }
+        }
+    }
+
+    QVector<Neighbor> found(static_cast<int>(results.size()));
+    for (int i = found.size() - 1; i >= 0; --i) {
+        found[i] = results.top();
+        results.pop();
+    }
+    return found;
+}
+
+QVector<int> HnswIndex::selectNeighbors(const QVector<Neighbor> &candidates, int maxCount) const
+{
+    QVector<int> selected;
+    QVector<int> pruned;
+    for (const Neighbor &candidate : candidates) {
+        if (selected.size() >= maxCount) {
+            break;
+        }
+        bool diverse = true;
+        for (int id : selected) {
+            if (similarity(candidate.id, id) > candidate.similarity) {
+                diverse = false;
+                break;
+            }
+        }
+        if (diverse) {
+            selected.append(candidate.id);
+        } else {
+            pruned.append(candidate.id);
+        }
+    }
+
+    // 连接数不足时用被剪掉的节点补足，避免稀疏区域连通性变差
+    for (int i = 0; i < pruned.size() && selected.size() < maxCount; ++i) {
+        selected.append(pruned[i]);
+    }
+    return selected;
+}
+
+void HnswIndex::shrinkLinks(int id, int level, int maxCount)
+{
+    const QVector<int> &links = m_nodes[id].links[level];
+    QVector<Neighbor> candidates;
+    candidates.reserve(links.size());
+    for (int neighbor : links) {
+        Neighbor candidate = { similarity(id, neighbor), neighbor };
+        candidates.append(candidate);
+    }
+    std::sort(candidates.begin(), candidates.end(), ByWorse());
+    m_nodes[id].links[level] = selectNeighbors(candidates, maxCount);
+}
+
+float HnswIndex::similarity(const qint8 *query, float queryScale, int id) const
+{
+    return FaceGallery::dotInt8(query, code(id), m_dimension) * queryScale * m_nodes[id].scale;
+}
+
+float HnswIndex::similarity(int a, int b) const
+{
+    return FaceGallery::dotInt8(code(a), code(b), m_dimension) * m_nodes[a].scale * m_nodes[b].scale;
+}
+
+int HnswIndex::randomLevel()
+{
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    double value = distribution(m_random);
+    if (value <= 0.0) {
+        value = 1e-12;
+    }
+    return qMin(kMaxLevel, static_cast<int>(-std::log(value) * m_levelMultiplier));
+}
@@ -0,0 +1,130 @@
+#ifndef HNSWINDEX_H
+#define HNSWINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+#include <QtGlobal>
+#include <random>
+
+#include "FaceGallery.h"
+
+/**
+ * @brief 人脸特征的HNSW近似最近邻索引
+ *
+ * 分层可导航小世界图（Malkov & Yashunin），节点保存int8量化后的归一化特征，
+ * 相似度为近似余弦相似度。检索复杂度约为O(log N)，用于注册人数较多时代替FaceGallery的逐一召回，
+ * 返回的候选仍由调用方用全精度特征重新排序。
+ *
+ * 删除只做标记，被删除的节点继续参与图的遍历但不出现在结果中，
+ * 删除比例过高时由compact()重建。索引可保存到文件，加载时用stamp判断是否与数据库一致。
+ */
+class HnswIndex
+{
+public:
+    /**
+     * @param m 每层每个节点的最大连接数（第0层为2m）
+     * @param efConstruction 插入时的候选队列长度
+     * @param efSearch 检索时的最小候选队列长度
+     */
+    explicit HnswIndex(int m = 16, int efConstruction = 100, int efSearch = 64);
+
+    void clear();
+
+    // 添加或替换一个人的特征（原始特征，内部归一化）
+    void setFeature(const QString &workId, const QVector<float> &feature);
+
+    void removeFeature(const QString &workId);
+
+    bool contains(const QString &workId) const { return m_labels.contains(workId); }
+    int size() const { return m_labels.size(); }
+    int dimension() const { return m_dimension; }
+
+    // 已删除但仍在图中的节点比例
+    double deletedRatio() const;
+
+    // 去掉已删除的节点，重新建图
+    void compact();
+
+    /**
+     * @brief 检索与查询特征最相似的候选
+     * @param feature 查询特征（原始特征，内部归一化）
+     * @param count 候选数量
+     * @return 按近似相似度降序排列的候选
+     */
+    QList<FaceGallery::Candidate> candidates(const QVector<float> &feature, int count) const;
+
+    qint64 memoryBytes() const;
+
+    // 统计信息：数量、维度、节点数、层数、内存占用
+    QVariantMap statistics() const;
+
+    /**
+     * @brief 保存到文件（先写临时文件再替换）
+     * @param stamp 与索引内容对应的数据库状态标识
+     */
+    bool save(const QString &filePath, const QString &stamp) const;
+
+    /**
+     * @brief 从文件加载
+     * @param stamp 期望的数据库状态标识，不一致时视为过期，不加载
+     * @return 是否加载成功
+     */
+    bool load(const QString &filePath, const QString &stamp);
+
+private:
+    struct Node {
+        QString workId;
+        float scale;
+        bool deleted;
+        QVector<QVector<int>> links;   // 每层的邻居
+    };
+
+    struct Neighbor {
+        float similarity;
+        int id;
+    };
+
+    // 插入已量化的特征
+    void insertCode(const QString &workId, const qint8 *code, float scale);
+
+    // 在一层中从entry出发做贪心搜索，返回按相似度降序排列的最多ef个节点
+    QVector<Neighbor> searchLayer(const qint8 *query, float queryScale, int entry, int ef, int level) const;
+
+    // 启发式选择邻居：优先保留彼此不相似的节点，使图在各个方向上都有连接
+    QVector<int> selectNeighbors(const QVector<Neighbor> &candidates, int maxCount) const;
+
+    // 将节点的邻居裁剪到maxCount个
+    void shrinkLinks(int id, int level, int maxCount);
+
+    float similarity(const qint8 *query, float queryScale, int id) const;
+    float similarity(int a, int b) const;
+
+    const qint8 *code(int id) const { return m_codes.constData() + static_cast<qint64>(id) * m_dimension; }
+    int maxLinks(int level) const { return level == 0 ? m_m * 2 : m_m; }
+    int randomLevel();
+
+    int m_m;
+    int m_efConstruction;
+    int m_efSearch;
+    double m_levelMultiplier;
+
+    int m_dimension;
+    int m_entryPoint;
+    int m_maxLevel;
+    int m_deletedCount;
+
+    QVector<Node> m_nodes;
+    QVector<qint8> m_codes;        // 每个节点的int8特征，行优先
+    QHash<QString, int> m_labels;  // 工号 -> 未删除的节点
+
+    std::mt19937 m_random;
+
+    // 搜索时的访问标记，用递增的轮次代替每次清零
+    mutable QVector<quint32> m_visited;
+    mutable quint32 m_visitTag;
+};
+
+#endif // HNSWINDEX_H
@@ -0,0 +1,335 @@
+#include "InferenceExecutor.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QQuickWindow>
+#include <QScreen>
+#include <opencv2/core.hpp>
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#elif defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+const char *kLatencyProfile = "latency";
+const char *kBalancedProfile = "balanced";
+const char *kSmoothProfile = "smooth";
+
+// 推理结束后这段时间内的帧计入掉帧统计
+const qint64 kInferenceWindowMs = 1000;
+
+// 超过该间隔视为界面空闲（没有重绘），不计入掉帧
+const qint64 kIdleFrameGapMs = 1000;
+
+} // namespace
+
+InferenceExecutor& InferenceExecutor::getInstance()
+{
+    static InferenceExecutor executor;
+    return executor;
+}
+
+InferenceExecutor::InferenceExecutor(QObject *parent)
+    : QObject(parent)
+    , m_worker(new QObject)
+    , m_profile(kBalancedProfile)
+    , m_threads(0)
+    , m_busy(false)
+    , m_frameIntervalMs(1000.0 / 60.0)
+    , m_lastFrameMs(-1)
+    , m_lastInferenceMs(-1)
+{
+    m_clock.start();
+
+    m_thread.setObjectName("FaceInference");
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    m_thread.start();
+    applyProfile();
+
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this]() {
+            m_thread.quit();
+            m_thread.wait();
+        });
+    }
+}
+
+InferenceExecutor::~InferenceExecutor()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void InferenceExecutor::configure(const QString &profile, int threads, const QString &cores)
+{
+    QList<int> coreList;
+    for (const QString &part : cores.split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        int core = part.trimmed().toInt(&ok);
+        if (ok && core >= 0 && core < QThread::idealThreadCount()) {
+            coreList.append(core);
+        } else {
+            qDebug() << "忽略无效的推理线程绑定核:" << part;
+        }
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_threads = qMax(0, threads);
+        m_cores = coreList;
+    }
+
+    setProfile(profile);
+    QMetaObject::invokeMethod(m_worker, [this]() { applyAffinity(); }, Qt::QueuedConnection);
+}
+
+QString InferenceExecutor::profile() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_profile;
+}
+
+void InferenceExecutor::setProfile(const QString &profile)
+{
+    QString name = profile.trimmed();
+    if (!profiles().contains(name)) {
+        qDebug() << "未知的推理配置，使用" << kBalancedProfile << ":" << profile;
+        name = kBalancedProfile;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_profile == name && m_stats.contains(name)) {
+            return;
+        }
+        m_profile = name;
+        m_stats[name];
+    }
+
+    applyProfile();
+    emit profileChanged();
+}
+
+QStringList InferenceExecutor::profiles() const
+{
+    return QStringList() << kLatencyProfile << kBalancedProfile << kSmoothProfile;
+}
+
+int InferenceExecutor::openCvThreads() const
+{
+    if (m_threads > 0) {
+        return m_threads;
+    }
+
+    int cores = qMax(1, QThread::idealThreadCount());
+    if (m_profile == kLatencyProfile) {
+        return cores;
+    }
+    if (m_profile == kSmoothProfile) {
+        return 1;
+    }
+    return qMax(1, cores - 1);
+}
+
+void InferenceExecutor::applyProfile()
+{
+    QThread::Priority priority = QThread::LowPriority;
+    int threads = 1;
+    QString name;
+    {
+        QMutexLocker locker(&m_mutex);
+        name = m_profile;
+        threads = openCvThreads();
+        if (name == kLatencyProfile) {
+            priority = QThread::NormalPriority;
+        } else if (name == kSmoothProfile) {
+            priority = QThread::LowestPriority;
+        }
+    }
+
+    // cv::setNumThreads作用于调用线程提交的并行任务，需要在推理线程上设置
+    QMetaObject::invokeMethod(m_worker, [threads]() { cv::setNumThreads(threads); }, Qt::QueuedConnection);
+    m_thread.setPriority(priority);
+
+    qDebug() << "人脸推理配置:" << name << "OpenCV线程数:" << threads;
+}
+
+void InferenceExecutor::applyAffinity()
+{
+    QList<int> cores;
+    {
+        QMutexLocker locker(&m_mutex);
+        cores = m_cores;
+    }
+    if (cores.isEmpty()) {
+        return;
+    }
+
+    // OpenCV的工作线程池不继承这里的绑定，只约束推理线程本身（SeetaFace2在该线程上单线程推理）
+#ifdef Q_OS_WIN
+    DWORD_PTR mask = 0;
+    for (int core : cores) {
+        mask |= DWORD_PTR(1) << core;
+    }
+    if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0) {
+        qDebug() << "推理线程绑定核失败:" << GetLastError();
+        return;
+    }
+#elif defined(Q_OS_LINUX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int core : cores) {
+        CPU_SET(core, &set);
+    }
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (error != 0) {
+        qDebug() << "推理线程绑定核失败:" << error;
+        return;
+    }
+#else
+    qDebug() << "当前平台不支持推理线程绑定核";
+    return;
+#endif
+
+    qDebug() << "推理线程已绑定到核:" << cores;
+}
+
+void InferenceExecutor::execute(const std::function<void()> &task)
+{
+    QElapsedTimer timer;
+    timer.start();
+    task();
+    double elapsedMs = timer.nsecsElapsed() / 1000000.0;
+
+    QMutexLocker locker(&m_mutex);
+    ProfileStats &stats = m_stats[m_profile];
+    stats.inferences++;
+    stats.totalInferenceMs += elapsedMs;
+    stats.maxInferenceMs = qMax(stats.maxInferenceMs, elapsedMs);
+    m_lastInferenceMs = m_clock.elapsed();
+}
+
+void InferenceExecutor::run(const std::function<void()> &task)
+{
+    if (isWorkerThread()) {
+        task();
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_lastInferenceMs = m_clock.elapsed();
+    }
+    QMetaObject::invokeMethod(m_worker, [this, &task]() { execute(task); }, Qt::BlockingQueuedConnection);
+}
+
+bool InferenceExecutor::tryPost(const std::function<void()> &task)
+{
+    bool expected = false;
+    if (!m_busy.compare_exchange_strong(expected, true)) {
+        QMutexLocker locker(&m_mutex);
+        m_stats[m_profile].skippedFrames++;
+        return false;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_lastInferenceMs = m_clock.elapsed();
+    }
+    QMetaObject::invokeMethod(m_worker, [this, task]() {
+        execute(task);
+        m_busy = false;
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+void InferenceExecutor::post(const std::function<void()> &task)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_lastInferenceMs = m_clock.elapsed();
+    }
+    QMetaObject::invokeMethod(m_worker, [this, task]() { execute(task); }, Qt::QueuedConnection);
+}
+
+void InferenceExecutor::attachWindow(QQuickWindow *window)
+{
+    if (!window || m_window == window) {
+        return;
+    }
+
+    m_window = window;
+    if (window->screen() && window->screen()->refreshRate() > 1.0) {
+        m_frameIntervalMs = 1000.0 / window->screen()->refreshRate();
+    }
+
+    // frameSwapped在渲染线程上发出，直接连接，统计数据由互斥锁保护
+    connect(window, &QQuickWindow::frameSwapped, this, [this]() { onFrameSwapped(); }, Qt::DirectConnection);
+}
+
+void InferenceExecutor::onFrameSwapped()
+{
+    QMutexLocker locker(&m_mutex);
+    qint64 now = m_clock.elapsed();
+    qint64 last = m_lastFrameMs;
+    m_lastFrameMs = now;
+
+    if (last < 0 || m_lastInferenceMs < 0 || now - m_lastInferenceMs > kInferenceWindowMs) {
+        return;
+    }
+    qint64 gap = now - last;
+    if (gap > kIdleFrameGapMs) {
+        return;
+    }
+
+    ProfileStats &stats = m_stats[m_profile];
+    stats.frames++;
+    if (gap > m_frameIntervalMs * 1.5) {
+        stats.droppedFrames += qMax<qint64>(1, qRound(gap / m_frameIntervalMs) - 1);
+    }
+}
+
+QVariantList InferenceExecutor::getProfileStats() const
+{
+    QVariantList result;
+    QMutexLocker locker(&m_mutex);
+
+    for (const QString &name : profiles()) {
+        if (!m_stats.contains(name)) {
+            continue;
+        }
+        const ProfileStats &stats = m_stats.value(name);
+        qint64 expectedFrames = stats.frames + stats.droppedFrames;
+
+        QVariantMap item;
+        item["profile"] = name;
+        item["current"] = name == m_profile;
+        item["frames"] = stats.frames;
+        item["droppedFrames"] = stats.droppedFrames;
+        item["dropRate"] = expectedFrames > 0 ? double(stats.droppedFrames) / expectedFrames : 0.0;
+        item["inferences"] = stats.inferences;
+        item["skippedFrames"] = stats.skippedFrames;
+        item["meanInferenceMs"] = stats.inferences > 0 ? stats.totalInferenceMs / stats.inferences : 0.0;
+        item["maxInferenceMs"] = stats.maxInferenceMs;
+        result.append(item);
+    }
+
+    return result;
+}
+
+void InferenceExecutor::resetStats()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats.clear();
+    m_stats[m_profile];
+    m_lastFrameMs = -1;
+    m_lastInferenceMs = -1;
+}
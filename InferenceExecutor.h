@@ -0,0 +1,139 @@
+#ifndef INFERENCEEXECUTOR_H
+#define INFERENCEEXECUTOR_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QVariantList>
+#include <atomic>
+#include <functional>
+
+class QQuickWindow;
+
+/**
+ * @brief 人脸推理线程
+ *
+ * 所有FaceRecognizer的检测、特征点定位和特征提取都在这一个线程上执行，模型只加载一份，
+ * 也不会与界面线程争用同一个非线程安全的模型对象。
+ *
+ * 由设置项 face_inference_profile 选择配置：
+ *   latency   OpenCV使用全部核，推理线程普通优先级，识别最快
+ *   balanced  OpenCV少用一个核留给界面渲染，推理线程低优先级（默认）
+ *   smooth    OpenCV单线程，推理线程最低优先级，界面最流畅
+ * face_inference_threads 大于0时覆盖配置中的OpenCV线程数，
+ * face_inference_cores（例如 "2,3"）把推理线程绑定到指定的核上，为空时不绑定。
+ *
+ * 连接主窗口后，按当前配置分别统计推理活跃期间界面的掉帧，通过上下文属性 inferenceExecutor 查看。
+ */
+class InferenceExecutor : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QString profile READ profile WRITE setProfile NOTIFY profileChanged)
+
+public:
+    static InferenceExecutor &getInstance();
+
+    /**
+     * @brief 按设置项配置推理线程
+     * @param profile 配置名称，未知时使用balanced
+     * @param threads OpenCV线程数，0表示由配置决定
+     * @param cores 绑定的核，逗号分隔，为空时不绑定
+     */
+    void configure(const QString &profile, int threads, const QString &cores);
+
+    QString profile() const;
+    void setProfile(const QString &profile);
+
+    // 可用的配置名称
+    Q_INVOKABLE QStringList profiles() const;
+
+    // 推理线程
+    QThread *workerThread() { return &m_thread; }
+    bool isWorkerThread() const { return QThread::currentThread() == &m_thread; }
+
+    /**
+     * @brief 在推理线程上执行并等待完成，已在推理线程上时直接执行
+     */
+    void run(const std::function<void()> &task);
+
+    /**
+     * @brief 推理线程空闲时异步执行，正在执行其他任务时丢弃
+     * @return 是否已提交
+     */
+    bool tryPost(const std::function<void()> &task);
+
+    /**
+     * @brief 在推理线程上异步执行，不丢弃（用于后台补充提取等不能跳过的任务）
+     */
+    void post(const std::function<void()> &task);
+
+    /**
+     * @brief 统计主窗口的掉帧（帧间隔超过刷新间隔1.5倍时按缺少的帧数计）
+     */
+    void attachWindow(QQuickWindow *window);
+
+    /**
+     * @brief 获取各配置下的统计
+     * @return 每项包含 profile、current、frames、droppedFrames、dropRate、inferences、
+     *         skippedFrames（推理忙时丢弃的跟踪帧）、meanInferenceMs、maxInferenceMs
+     */
+    Q_INVOKABLE QVariantList getProfileStats() const;
+
+    Q_INVOKABLE void resetStats();
+
+signals:
+    void profileChanged();
+
+private:
+    explicit InferenceExecutor(QObject *parent = nullptr);
+    ~InferenceExecutor();
+
+    struct ProfileStats {
+        qint64 frames = 0;
+        qint64 droppedFrames = 0;
+        qint64 inferences = 0;
+        qint64 skippedFrames = 0;
+        double totalInferenceMs = 0.0;
+        double maxInferenceMs = 0.0;
+    };
+
+    // 在推理线程上执行一个任务并记录耗时
+    void execute(const std::function<void()> &task);
+
+    // 应用当前配置的线程数和优先级
+    void applyProfile();
+
+    // 在推理线程上绑定核
+    void applyAffinity();
+
+    // 渲染线程每交换一帧调用一次
+    void onFrameSwapped();
+
+    int openCvThreads() const;
+
+    QThread m_thread;
+    QObject *m_worker;
+
+    mutable QMutex m_mutex;
+    QString m_profile;
+    int m_threads;
+    QList<int> m_cores;
+    QHash<QString, ProfileStats> m_stats;
+
+    std::atomic<bool> m_busy;
+
+    // 掉帧统计
+    QElapsedTimer m_clock;
+    QPointer<QQuickWindow> m_window;
+    double m_frameIntervalMs;
+    qint64 m_lastFrameMs;
+    qint64 m_lastInferenceMs;
+};
+
+#endif // INFERENCEEXECUTOR_H
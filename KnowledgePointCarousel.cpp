@@ -0,0 +1,178 @@
+#include "KnowledgePointCarousel.h"
+#include "DatabaseManager.h"
+
+#include <QDebug>
+#include <QSet>
+
+KnowledgePointCarousel::KnowledgePointCarousel(DatabaseManager *dbManager, QObject *parent)
+    : QObject(parent)
+    , m_dbManager(dbManager)
+    , m_index(0)
+    , m_prefetchCount(5)
+    , m_dirty(true)
+    , m_currentId(-1)
+{
+    if (m_dbManager) {
+        connect(m_dbManager, &DatabaseManager::knowledgePointsChanged,
+                this, &KnowledgePointCarousel::invalidate);
+    }
+}
+
+void KnowledgePointCarousel::setPrefetchCount(int prefetchCount)
+{
+    if (prefetchCount < 1) {
+        prefetchCount = 1;
+    }
+    if (m_prefetchCount == prefetchCount) {
+        return;
+    }
+    m_prefetchCount = prefetchCount;
+    emit prefetchCountChanged();
+}
+
+void KnowledgePointCarousel::reload()
+{
+    m_currentId = -1;
+    m_cache.clear();
+    refreshIds();
+    m_index = 0;
+    showCurrent();
+}
+
+void KnowledgePointCarousel::next()
+{
+    if (m_dirty) {
+        refreshIds();
+    }
+
+    if (m_ids.isEmpty()) {
+        showCurrent();
+        return;
+    }
+
+    m_index = (m_index + 1) % m_ids.size();
+    showCurrent();
+}
+
+void KnowledgePointCarousel::invalidate()
+{
+    m_dirty = true;
+    m_cache.clear();
+
+    // 当前没有可显示的智点时立即刷新，使新导入的智点尽快出现
+    if (m_ids.isEmpty()) {
+        reload();
+    }
+}
+
+void KnowledgePointCarousel::refreshIds()
+{
+    if (!m_dbManager) {
+        return;
+    }
+
+    const QVariantList ids = m_dbManager->getKnowledgePointIds();
+    int oldCount = m_ids.size();
+
+    m_ids.clear();
+    m_ids.reserve(ids.size());
+    for (const QVariant &id : ids) {
+        m_ids.append(id.toInt());
+    }
+    m_dirty = false;
+
+    // 保持当前智点的位置；当前智点已被删除时，定位到它之前的位置，下一次切换显示其后的智点
+    m_index = -1;
+    if (m_currentId >= 0) {
+        for (int i = 0; i < m_ids.size(); ++i) {
+            if (m_ids.at(i) == m_currentId) {
+                m_index = i;
+                break;
+            }
+            if (m_ids.at(i) < m_currentId) {
+                m_index = i - 1;
+                break;
+            }
+        }
+    }
+
+    if (oldCount != m_ids.size()) {
+        emit countChanged();
+    }
+
+    qDebug() << "智点轮播刷新ID列表，共" << m_ids.size() << "个智点";
+}
+
+void KnowledgePointCarousel::prefetch()
+{
+    if (!m_dbManager || m_ids.isEmpty()) {
+        return;
+    }
+
+    int windowSize = qMin(m_prefetchCount, m_ids.size());
+    QSet<int> window;
+    QVariantList missingIds;
+    for (int i = 0; i < windowSize; ++i) {
+        int id = m_ids.at((m_index + i) % m_ids.size());
+        window.insert(id);
+        if (!m_cache.contains(id)) {
+            missingIds.append(id);
+        }
+    }
+
+    // 淘汰窗口外的缓存
+    for (auto it = m_cache.begin(); it != m_cache.end();) {
+        if (window.contains(it.key())) {
+            ++it;
+        } else {
+            it = m_cache.erase(it);
+        }
+    }
+
+    if (missingIds.isEmpty()) {
+        return;
+    }
+
+    const QVariantList points = m_dbManager->getKnowledgePointsByIds(missingIds);
+    for (const QVariant &pointVar : points) {
+        QVariantMap pointMap = pointVar.toMap();
+        Point point;
+        point.title = pointMap.value("title").toString();
+        point.content = pointMap.value("content").toString();
+        m_cache.insert(pointMap.value("id").toInt(), point);
+    }
+}
+
+void KnowledgePointCarousel::showCurrent()
+{
+    if (m_ids.isEmpty()) {
+        m_index = 0;
+        if (m_currentId != -1 || !m_title.isEmpty() || !m_content.isEmpty()) {
+            m_currentId = -1;
+            m_title.clear();
+            m_content.clear();
+            emit currentChanged();
+        }
+        return;
+    }
+
+    if (m_index < 0 || m_index >= m_ids.size()) {
+        m_index = 0;
+    }
+
+    prefetch();
+
+    // ID列表刷新前被删除的智点不在缓存中，标记失效后由下次切换刷新
+    int id = m_ids.at(m_index);
+    auto it = m_cache.constFind(id);
+    if (it == m_cache.constEnd()) {
+        qDebug() << "智点" << id << "已不存在，等待刷新ID列表";
+        m_dirty = true;
+        return;
+    }
+
+    m_currentId = id;
+    m_title = it.value().title;
+    m_content = it.value().content;
+    emit currentChanged();
+}
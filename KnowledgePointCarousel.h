@@ -0,0 +1,89 @@
+#ifndef KNOWLEDGEPOINTCAROUSEL_H
+#define KNOWLEDGEPOINTCAROUSEL_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QHash>
+
+class DatabaseManager;
+
+/**
+ * @brief 首页智点轮播
+ *
+ * 只保存智点ID列表，并预取当前位置之后的若干条智点内容，
+ * 定时切换时无需重新读取整张智点表。
+ * 智点被添加、删除、导入或清空后，在下次切换时刷新ID列表。
+ */
+class KnowledgePointCarousel : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int currentId READ currentId NOTIFY currentChanged)
+    Q_PROPERTY(QString title READ title NOTIFY currentChanged)
+    Q_PROPERTY(QString content READ content NOTIFY currentChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int prefetchCount READ prefetchCount WRITE setPrefetchCount NOTIFY prefetchCountChanged)
+
+public:
+    explicit KnowledgePointCarousel(DatabaseManager *dbManager, QObject *parent = nullptr);
+
+    int currentId() const { return m_currentId; }
+    QString title() const { return m_title; }
+    QString content() const { return m_content; }
+    int count() const { return m_ids.size(); }
+
+    int prefetchCount() const { return m_prefetchCount; }
+    void setPrefetchCount(int prefetchCount);
+
+    /**
+     * @brief 重新读取智点ID列表并显示第一个智点
+     */
+    Q_INVOKABLE void reload();
+
+    /**
+     * @brief 切换到下一个智点
+     */
+    Q_INVOKABLE void next();
+
+signals:
+    void currentChanged();
+    void countChanged();
+    void prefetchCountChanged();
+
+private slots:
+    // 智点数据变化时标记ID列表失效
+    void invalidate();
+
+private:
+    // 重新读取ID列表，尽量保持当前显示的智点位置
+    void refreshIds();
+
+    // 预取从当前位置开始的智点内容，并淘汰窗口外的缓存
+    void prefetch();
+
+    // 显示当前位置的智点
+    void showCurrent();
+
+    struct Point {
+        QString title;
+        QString content;
+    };
+
+    DatabaseManager *m_dbManager;
+
+    // 智点ID列表（与getAllKnowledgePoints顺序一致）
+    QList<int> m_ids;
+
+    // 预取窗口内的智点内容
+    QHash<int, Point> m_cache;
+
+    int m_index;
+    int m_prefetchCount;
+    bool m_dirty;
+
+    int m_currentId;
+    QString m_title;
+    QString m_content;
+};
+
+#endif // KNOWLEDGEPOINTCAROUSEL_H
@@ -0,0 +1,136 @@
+#include "ModelLocator.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+
+QMutex ModelLocator::s_mutex;
+QString ModelLocator::s_configuredPath;
+
+namespace {
+
+const char *kManifestName = "models.json";
+
+// OpenCV DNN后端的模型，只在选择该后端时需要，不影响模型目录是否有效
+const QStringList kOptionalRoles = {"yunet", "sface"};
+
+} // namespace
+
+void ModelLocator::setConfiguredPath(const QString &path)
+{
+    QMutexLocker locker(&s_mutex);
+    s_configuredPath = path.trimmed();
+}
+
+QString ModelLocator::locate()
+{
+    // 1. 配置的目录
+    QString configuredPath = qEnvironmentVariable("SPARKEXAM_MODEL_DIR").trimmed();
+    if (configuredPath.isEmpty()) {
+        QMutexLocker locker(&s_mutex);
+        configuredPath = s_configuredPath;
+    }
+    if (!configuredPath.isEmpty()) {
+        if (isValidModelDir(configuredPath)) {
+            QString path = QFileInfo(configuredPath).absoluteFilePath();
+            qDebug() << "使用配置的模型目录:" << path;
+            return path;
+        }
+        qDebug() << "配置的模型目录无效，继续查找:" << configuredPath;
+    }
+
+    // 2. 缓存的目录
+    QString cachedPath = readCachedPath();
+    if (!cachedPath.isEmpty() && isValidModelDir(cachedPath)) {
+        qDebug() << "使用缓存的模型目录:" << cachedPath;
+        return cachedPath;
+    }
+
+    // 3. 固定的候选目录
+    QString appDir = QCoreApplication::applicationDirPath();
+    const QStringList candidates = {
+        appDir + "/model",
+        appDir,
+        QDir::currentPath() + "/model"
+    };
+    for (const QString &candidate : candidates) {
+        if (isValidModelDir(candidate)) {
+            QString path = QFileInfo(candidate).absoluteFilePath();
+            qDebug() << "找到模型目录:" << path;
+            if (path != cachedPath) {
+                writeCachedPath(path);
+            }
+            return path;
+        }
+    }
+
+    qDebug() << "未找到模型目录，已检查:" << candidates;
+    return QString();
+}
+
+QHash<QString, QString> ModelLocator::modelFiles(const QString &modelDir)
+{
+    QHash<QString, QString> fileNames;
+    fileNames["detector"] = "fd_2_00.dat";
+    fileNames["landmarker"] = "pd_2_00_pts5.dat";
+    fileNames["recognizer"] = "fr_2_10.dat";
+    fileNames["yunet"] = "face_detection_yunet_2021dec.onnx";
+    fileNames["sface"] = "face_recognition_sface_2021dec.onnx";
+
+    QFile manifest(modelDir + "/" + kManifestName);
+    if (manifest.open(QIODevice::ReadOnly)) {
+        QJsonObject models = QJsonDocument::fromJson(manifest.readAll()).object().value("models").toObject();
+        for (auto it = models.constBegin(); it != models.constEnd(); ++it) {
+            QString fileName = it.value().toString();
+            if (fileNames.contains(it.key()) && !fileName.isEmpty()) {
+                fileNames[it.key()] = fileName;
+            }
+        }
+    }
+
+    QHash<QString, QString> files;
+    for (auto it = fileNames.constBegin(); it != fileNames.constEnd(); ++it) {
+        files.insert(it.key(), modelDir + "/" + it.value());
+    }
+    return files;
+}
+
+bool ModelLocator::isValidModelDir(const QString &modelDir)
+{
+    const QHash<QString, QString> files = modelFiles(modelDir);
+    for (auto it = files.constBegin(); it != files.constEnd(); ++it) {
+        if (!kOptionalRoles.contains(it.key()) && !QFileInfo(it.value()).isFile()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QString ModelLocator::cacheFilePath()
+{
+    return QCoreApplication::applicationDirPath() + "/model_path.cache";
+}
+
+QString ModelLocator::readCachedPath()
+{
+    QFile file(cacheFilePath());
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return QString();
+    }
+    return QString::fromUtf8(file.readAll()).trimmed();
+}
+
+void ModelLocator::writeCachedPath(const QString &path)
+{
+    QFile file(cacheFilePath());
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qDebug() << "无法写入模型目录缓存:" << file.fileName();
+        return;
+    }
+    file.write(path.toUtf8());
+}
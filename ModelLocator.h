@@ -0,0 +1,57 @@
+#ifndef MODELLOCATOR_H
+#define MODELLOCATOR_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief 人脸模型目录定位器
+ *
+ * 按固定顺序查找模型目录，不做递归搜索：
+ * 1. 环境变量 SPARKEXAM_MODEL_DIR 或设置项 face_model_path 指定的目录
+ * 2. 上次成功定位并缓存的目录
+ * 3. 应用程序目录下的model子目录、应用程序目录、当前工作目录下的model子目录
+ *
+ * 模型目录中的 models.json 清单声明检测器、特征点定位器和识别器的文件名，
+ * 没有清单时使用SeetaFace2的默认文件名。yunet、sface为OpenCV DNN后端的可选模型。
+ */
+class ModelLocator
+{
+public:
+    /**
+     * @brief 设置配置的模型目录（来自设置项 face_model_path），环境变量优先
+     */
+    static void setConfiguredPath(const QString &path);
+
+    /**
+     * @brief 定位模型目录，成功后缓存结果供下次启动直接使用
+     * @return 模型目录的绝对路径，找不到时返回空字符串
+     */
+    static QString locate();
+
+    /**
+     * @brief 读取目录中的模型清单
+     * @param modelDir 模型目录
+     * @return 角色(detector/landmarker/recognizer/yunet/sface) -> 模型文件的完整路径
+     */
+    static QHash<QString, QString> modelFiles(const QString &modelDir);
+
+    /**
+     * @brief 检查目录是否包含清单要求的全部SeetaFace2模型文件（可选模型不检查）
+     */
+    static bool isValidModelDir(const QString &modelDir);
+
+private:
+    // 缓存文件路径
+    static QString cacheFilePath();
+
+    static QString readCachedPath();
+    static void writeCachedPath(const QString &path);
+
+    static QMutex s_mutex;
+    static QString s_configuredPath;
+};
+
+#endif // MODELLOCATOR_H
@@ -0,0 +1,300 @@
+#include "OpenCvDnnBackend.h"
+#include "FaceGallery.h"
+#include "ModelLocator.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 检测前把图像缩放到长边不超过该值，摄像头画面中的人脸缩放后仍远大于YuNet的最小检测尺寸
+const int kDetectMaxSide = 320;
+
+const float kDetectScoreThreshold = 0.6f;
+const float kNmsThreshold = 0.3f;
+const int kNmsTopK = 5000;
+
+// YuNet的先验框参数
+const int kPriorSteps[] = {8, 16, 32, 64};
+const std::vector<std::vector<float>> kPriorMinSizes = {{10.0f, 16.0f, 24.0f}, {32.0f, 48.0f}, {64.0f, 96.0f}, {128.0f, 192.0f, 256.0f}};
+const float kVariance[] = {0.1f, 0.2f};
+
+// SFace输入为按5点对齐到该模板的112x112人脸
+const int kAlignedSize = 112;
+const float kAlignTemplate[5][2] = {
+    {38.2946f, 51.6963f},
+    {73.5318f, 51.5014f},
+    {56.0252f, 71.7366f},
+    {41.5493f, 92.3655f},
+    {70.7299f, 92.2041f}
+};
+
+const int kFeatureSize = 128;
+
+// SFace推荐的余弦相似度阈值映射为0.6（face_recognition_threshold的默认值），两段线性保持单调
+const float kCosineThreshold = 0.363f;
+const float kCalibratedThreshold = 0.6f;
+
+// 最小二乘相似变换（旋转、等比缩放、平移），把src映射到dst
+cv::Mat similarityTransform(const std::vector<cv::Point2f> &src, const std::vector<cv::Point2f> &dst)
+{
+    int count = static_cast<int>(std::min(src.size(), dst.size()));
+    cv::Point2f srcMean(0.0f, 0.0f);
+    cv::Point2f dstMean(0.0f, 0.0f);
+    for (int i = 0; i < count; ++i) {
+        srcMean += src[i];
+        dstMean += dst[i];
+    }
+    srcMean *= 1.0f / count;
+    dstMean *= 1.0f / count;
+
+    double norm = 0.0;
+    double a = 0.0;
+    double b = 0.0;
+    for (int i = 0; i < count; ++i) {
+        cv::Point2f p = src[i] - srcMean;
+        cv::Point2f q = dst[i] - dstMean;
+        norm += p.x * p.x + p.y * p.y;
+        a += p.x * q.x + p.y * q.y;
+        b += p.x * q.y - p.y * q.x;
+    }
+    if (norm <= 0.0) {
+        return cv::Mat();
+    }
+    a /= norm;
+    b /= norm;
+
+    cv::Mat transform = (cv::Mat_<double>(2, 3) <<
+        a, -b, dstMean.x - (a * srcMean.x - b * srcMean.y),
+        b, a, dstMean.y - (b * srcMean.x + a * srcMean.y));
+    return transform;
+}
+
+} // namespace
+
+QSharedPointer<OpenCvDnnBackend> OpenCvDnnBackend::load(const QString &modelPath)
+{
+    QHash<QString, QString> files = ModelLocator::modelFiles(modelPath);
+    QString detectorPath = files.value("yunet");
+    QString recognizerPath = files.value("sface");
+    if (!QFileInfo(detectorPath).isFile() || !QFileInfo(recognizerPath).isFile()) {
+        qDebug() << "OpenCV DNN模型文件不存在:" << detectorPath << recognizerPath;
+        return QSharedPointer<OpenCvDnnBackend>();
+    }
+
+    QSharedPointer<OpenCvDnnBackend> backend(new OpenCvDnnBackend);
+    backend->m_modelPath = QFileInfo(modelPath).absoluteFilePath();
+
+    try {
+        qDebug() << "创建YuNet人脸检测器:" << detectorPath;
+        backend->m_detector = cv::dnn::readNet(detectorPath.toStdString());
+        backend->m_detector.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        backend->m_detector.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+
+        qDebug() << "创建SFace人脸特征提取器:" << recognizerPath;
+        backend->m_recognizer = cv::dnn::readNet(recognizerPath.toStdString());
+        backend->m_recognizer.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        backend->m_recognizer.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    } catch (const std::exception &e) {
+        qDebug() << "加载OpenCV DNN模型失败:" << e.what();
+        return QSharedPointer<OpenCvDnnBackend>();
+    }
+
+    if (backend->m_detector.empty() || backend->m_recognizer.empty()) {
+        qDebug() << "加载OpenCV DNN模型失败:" << modelPath;
+        return QSharedPointer<OpenCvDnnBackend>();
+    }
+    return backend;
+}
+
+QString OpenCvDnnBackend::name() const
+{
+    return "opencv_dnn";
+}
+
+std::vector<FaceDetection> OpenCvDnnBackend::detect(const cv::Mat &image)
+{
+    std::vector<FaceDetection> detections;
+    if (image.empty()) {
+        return detections;
+    }
+
+    cv::Mat bgr;
+    if (image.channels() == 1) {
+        cv::cvtColor(image, bgr, cv::COLOR_GRAY2BGR);
+    } else {
+        bgr = image;
+    }
+
+    // 缩小后检测，结果再换算回原图坐标
+    double scale = std::min(1.0, static_cast<double>(kDetectMaxSide) / std::max(bgr.cols, bgr.rows));
+    cv::Mat input;
+    if (scale < 1.0) {
+        cv::resize(bgr, input, cv::Size(), scale, scale, cv::INTER_AREA);
+    } else {
+        input = bgr;
+    }
+
+    cv::Size inputSize(input.cols, input.rows);
+    if (inputSize != m_priorSize) {
+        generatePriors(inputSize);
+    }
+
+    std::vector<cv::Mat> outputs;
+    m_detector.setInput(cv::dnn::blobFromImage(input));
+    m_detector.forward(outputs, std::vector<cv::String>{"loc", "conf", "iou"});
+    if (outputs.size() != 3 || outputs[0].total() < m_priors.size() * 14
+            || outputs[1].total() < m_priors.size() * 2 || outputs[2].total() < m_priors.size()) {
+        qDebug() << "YuNet输出与先验框数量不一致:" << m_priors.size();
+        return detections;
+    }
+
+    const float *loc = outputs[0].ptr<float>();
+    const float *conf = outputs[1].ptr<float>();
+    const float *iou = outputs[2].ptr<float>();
+    float inputW = static_cast<float>(inputSize.width);
+    float inputH = static_cast<float>(inputSize.height);
+
+    std::vector<cv::Rect> boxes;
+    std::vector<float> scores;
+    std::vector<std::vector<cv::Point2f>> landmarks;
+    for (size_t i = 0; i < m_priors.size(); ++i) {
+        float iouScore = std::min(std::max(iou[i], 0.0f), 1.0f);
+        float score = std::sqrt(conf[i * 2 + 1] * iouScore);
+        if (score < kDetectScoreThreshold) {
+            continue;
+        }
+
+        const cv::Rect2f &prior = m_priors[i];
+        const float *l = loc + i * 14;
+        float cx = (prior.x + l[0] * kVariance[0] * prior.width) * inputW;
+        float cy = (prior.y + l[1] * kVariance[0] * prior.height) * inputH;
+        float w = prior.width * std::exp(l[2] * kVariance[0]) * inputW;
+        float h = prior.height * std::exp(l[3] * kVariance[1]) * inputH;
+        boxes.push_back(cv::Rect(cvRound((cx - w / 2) / scale), cvRound((cy - h / 2) / scale),
+                                 cvRound(w / scale), cvRound(h / scale)));
+        scores.push_back(score);
+
+        // YuNet的特征点顺序为右眼、左眼、鼻尖、右嘴角、左嘴角（人脸自身的左右），即图像中从左到右
+        std::vector<cv::Point2f> points;
+        for (int j = 0; j < 5; ++j) {
+            float x = (prior.x + l[4 + j * 2] * kVariance[0] * prior.width) * inputW;
+            float y = (prior.y + l[5 + j * 2] * kVariance[0] * prior.height) * inputH;
+            points.push_back(cv::Point2f(static_cast<float>(x / scale), static_cast<float>(y / scale)));
+        }
+        landmarks.push_back(points);
+    }
+
+    std::vector<int> keep;
+    cv::dnn::NMSBoxes(boxes, scores, kDetectScoreThreshold, kNmsThreshold, keep, 1.0f, kNmsTopK);
+    for (int index : keep) {
+        FaceDetection detection;
+        detection.box = boxes[index];
+        detection.score = scores[index];
+        detection.landmarks = landmarks[index];
+        detections.push_back(detection);
+    }
+    return detections;
+}
+
+bool OpenCvDnnBackend::align(const cv::Mat &image, FaceDetection &face)
+{
+    Q_UNUSED(image);
+    // YuNet检测时已输出特征点
+    return face.landmarks.size() >= 5;
+}
+
+QVector<float> OpenCvDnnBackend::embed(const cv::Mat &image, const FaceDetection &face)
+{
+    QVector<float> feature;
+    if (face.landmarks.size() < 5) {
+        return feature;
+    }
+
+    std::vector<cv::Point2f> src(face.landmarks.begin(), face.landmarks.begin() + 5);
+    std::vector<cv::Point2f> dst;
+    for (int i = 0; i < 5; ++i) {
+        dst.push_back(cv::Point2f(kAlignTemplate[i][0], kAlignTemplate[i][1]));
+    }
+    cv::Mat transform = similarityTransform(src, dst);
+    if (transform.empty()) {
+        return feature;
+    }
+
+    cv::Mat bgr;
+    if (image.channels() == 1) {
+        cv::cvtColor(image, bgr, cv::COLOR_GRAY2BGR);
+    } else {
+        bgr = image;
+    }
+    cv::Mat aligned;
+    cv::warpAffine(bgr, aligned, transform, cv::Size(kAlignedSize, kAlignedSize), cv::INTER_LINEAR);
+
+    m_recognizer.setInput(cv::dnn::blobFromImage(aligned, 1.0, cv::Size(kAlignedSize, kAlignedSize),
+                                                 cv::Scalar(), true, false));
+    cv::Mat output = m_recognizer.forward();
+    if (static_cast<int>(output.total()) != kFeatureSize) {
+        qDebug() << "SFace输出维度不正确:" << output.total();
+        return feature;
+    }
+
+    const float *data = output.ptr<float>();
+    feature = QVector<float>(data, data + kFeatureSize);
+    return feature;
+}
+
+float OpenCvDnnBackend::similarity(const QVector<float> &feature1, const QVector<float> &feature2) const
+{
+    if (feature1.size() != kFeatureSize || feature2.size() != kFeatureSize) {
+        return 0.0f;
+    }
+
+    QVector<float> a = FaceGallery::normalized(feature1);
+    QVector<float> b = FaceGallery::normalized(feature2);
+    float cosine = 0.0f;
+    for (int i = 0; i < kFeatureSize; ++i) {
+        cosine += a[i] * b[i];
+    }
+
+    if (cosine <= kCosineThreshold) {
+        return std::max(cosine, 0.0f) / kCosineThreshold * kCalibratedThreshold;
+    }
+    return kCalibratedThreshold + (std::min(cosine, 1.0f) - kCosineThreshold) / (1.0f - kCosineThreshold)
+            * (1.0f - kCalibratedThreshold);
+}
+
+int OpenCvDnnBackend::featureSize() const
+{
+    return kFeatureSize;
+}
+
+void OpenCvDnnBackend::generatePriors(const cv::Size &inputSize)
+{
+    m_priorSize = inputSize;
+    m_priors.clear();
+
+    // 特征图尺寸：输入连续减半，使用第3至第6级
+    std::vector<cv::Size> featureMaps;
+    cv::Size featureMap((inputSize.width + 1) / 2 / 2, (inputSize.height + 1) / 2 / 2);
+    for (int i = 0; i < 4; ++i) {
+        featureMap = cv::Size(featureMap.width / 2, featureMap.height / 2);
+        featureMaps.push_back(featureMap);
+    }
+
+    float inputW = static_cast<float>(inputSize.width);
+    float inputH = static_cast<float>(inputSize.height);
+    for (size_t i = 0; i < featureMaps.size(); ++i) {
+        for (int y = 0; y < featureMaps[i].height; ++y) {
+            for (int x = 0; x < featureMaps[i].width; ++x) {
+                for (float minSize : kPriorMinSizes[i]) {
+                    m_priors.push_back(cv::Rect2f((x + 0.5f) * kPriorSteps[i] / inputW,
+                                                  (y + 0.5f) * kPriorSteps[i] / inputH,
+                                                  minSize / inputW, minSize / inputH));
+                }
+            }
+        }
+    }
+}
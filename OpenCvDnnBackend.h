@@ -0,0 +1,46 @@
+#ifndef OPENCVDNNBACKEND_H
+#define OPENCVDNNBACKEND_H
+
+#include "FaceBackend.h"
+
+#include <opencv2/dnn.hpp>
+
+/**
+ * @brief OpenCV DNN后端：YuNet检测 + SFace识别，在CPU上推理
+ *
+ * 模型文件由models.json中的yunet、sface声明（face_detection_yunet_2021dec.onnx、
+ * face_recognition_sface_2021dec.onnx）。当前链接的OpenCV 4.5.2没有FaceDetectorYN/FaceRecognizerSF，
+ * 这里直接用cv::dnn::Net加载，先验框解码和对齐与OpenCV 4.5.4中的实现一致。
+ */
+class OpenCvDnnBackend : public FaceBackend
+{
+public:
+    /**
+     * @brief 从模型目录加载
+     * @return 后端，模型文件不存在或加载失败时返回空
+     */
+    static QSharedPointer<OpenCvDnnBackend> load(const QString &modelPath);
+
+    QString name() const override;
+    QString modelPath() const override { return m_modelPath; }
+    std::vector<FaceDetection> detect(const cv::Mat &image) override;
+    bool align(const cv::Mat &image, FaceDetection &face) override;
+    QVector<float> embed(const cv::Mat &image, const FaceDetection &face) override;
+    float similarity(const QVector<float> &feature1, const QVector<float> &feature2) const override;
+    int featureSize() const override;
+
+private:
+    OpenCvDnnBackend() = default;
+
+    // 按网络输入尺寸生成YuNet的先验框（归一化的中心点和宽高）
+    void generatePriors(const cv::Size &inputSize);
+
+    cv::dnn::Net m_detector;
+    cv::dnn::Net m_recognizer;
+    QString m_modelPath;
+
+    cv::Size m_priorSize;
+    std::vector<cv::Rect2f> m_priors;
+};
+
+#endif // OPENCVDNNBACKEND_H
@@ -0,0 +1,214 @@
+#include "PagedListModels.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QUrl>
+
+namespace {
+
+// 列顺序，与roleKeys()一致
+enum FaceDataColumn {
+    FaceId, FaceName, FaceGender, FaceWorkId, FaceImage, FaceAvatarPath, FaceIsAdmin, FaceCreatedAt
+};
+
+// 转换相对路径为绝对路径并编码为URL，与DatabaseManager::getAllFaceData一致
+QString toImageUrl(QString path, const QString &appDir)
+{
+    if (path.isEmpty() || path.startsWith("file:///")) {
+        return path;
+    }
+    if (path.startsWith("/")) {
+        path = appDir + path;
+    } else {
+        path = appDir + "/" + path;
+    }
+    return QUrl::fromLocalFile(path).toString();
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// PagedListModel
+
+PagedListModel::PagedListModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_pageSize(50)
+    , m_atEnd(false)
+{
+}
+
+int PagedListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_rows.size();
+}
+
+QVariant PagedListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+
+    int column = role - (Qt::UserRole + 1);
+    const Row &row = m_rows.at(index.row());
+    if (column < 0 || column >= row.size()) {
+        return QVariant();
+    }
+    return columnData(row, column);
+}
+
+QHash<int, QByteArray> PagedListModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    const QList<QByteArray> keys = roleKeys();
+    for (int i = 0; i < keys.size(); ++i) {
+        roles.insert(Qt::UserRole + 1 + i, keys.at(i));
+    }
+    return roles;
+}
+
+bool PagedListModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return false;
+    }
+    return !m_atEnd && isQueryReady();
+}
+
+void PagedListModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    bool ok = true;
+    QList<Row> page = fetchPage(m_rows.isEmpty() ? Row() : m_rows.last(), m_pageSize, &ok);
+    if (!ok || page.size() < m_pageSize) {
+        // 查询失败时也停止加载，避免视图反复重试
+        m_atEnd = true;
+    }
+
+    if (page.isEmpty()) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + page.size() - 1);
+    m_rows.append(page);
+    endInsertRows();
+    emit countChanged();
+}
+
+void PagedListModel::setPageSize(int pageSize)
+{
+    if (pageSize < 1 || m_pageSize == pageSize) {
+        return;
+    }
+    m_pageSize = pageSize;
+    emit pageSizeChanged();
+}
+
+void PagedListModel::reload()
+{
+    beginResetModel();
+    m_rows.clear();
+    m_atEnd = false;
+    endResetModel();
+    emit countChanged();
+}
+
+QVariantMap PagedListModel::get(int row) const
+{
+    QVariantMap result;
+    if (row < 0 || row >= m_rows.size()) {
+        return result;
+    }
+
+    const QList<QByteArray> keys = roleKeys();
+    const Row &rowData = m_rows.at(row);
+    for (int i = 0; i < keys.size() && i < rowData.size(); ++i) {
+        result.insert(QString::fromUtf8(keys.at(i)), columnData(rowData, i));
+    }
+    return result;
+}
+
+void PagedListModel::remove(int row)
+{
+    if (row < 0 || row >= m_rows.size()) {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_rows.removeAt(row);
+    endRemoveRows();
+    emit countChanged();
+}
+
+QVariant PagedListModel::columnData(const Row &row, int column) const
+{
+    return row.at(column);
+}
+
+// ---------------------------------------------------------------------------
+// FaceDataListModel
+
+FaceDataListModel::FaceDataListModel(QObject *parent)
+    : PagedListModel(parent)
+{
+}
+
+QList<QByteArray> FaceDataListModel::roleKeys() const
+{
+    return { "id", "name", "gender", "workId", "faceImage", "avatarPath", "isAdmin", "createdAt" };
+}
+
+QList<PagedListModel::Row> FaceDataListModel::fetchPage(const Row &lastRow, int limit, bool *ok)
+{
+    QList<Row> rows;
+
+    QString sql =
+        "SELECT id, name, gender, work_id, face_image_path, avatar_path, is_admin, created_at "
+        "FROM users ";
+    if (!lastRow.isEmpty()) {
+        // keyset：(name, id) 严格大于上一页最后一行
+        sql += "WHERE name >= ? AND (name > ? OR id > ?) ";
+    }
+    sql += "ORDER BY name, id LIMIT ?";
+
+    QSqlQuery query(QSqlDatabase::database());
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    if (!lastRow.isEmpty()) {
+        query.addBindValue(lastRow.at(FaceName));
+        query.addBindValue(lastRow.at(FaceName));
+        query.addBindValue(lastRow.at(FaceId));
+    }
+    query.addBindValue(limit);
+
+    if (!query.exec()) {
+        qDebug() << "分页获取人脸数据失败:" << query.lastError().text();
+        *ok = false;
+        return rows;
+    }
+
+    QString appDir = QCoreApplication::applicationDirPath();
+    while (query.next()) {
+        Row row(FaceCreatedAt + 1);
+        row[FaceId] = query.value(0).toInt();
+        row[FaceName] = query.value(1).toString();
+        row[FaceGender] = query.value(2).toString();
+        row[FaceWorkId] = query.value(3).toString();
+        row[FaceImage] = toImageUrl(query.value(4).toString(), appDir);
+        row[FaceAvatarPath] = toImageUrl(query.value(5).toString(), appDir);
+        row[FaceIsAdmin] = query.value(6).toBool();
+        row[FaceCreatedAt] = query.value(7).toString();
+        rows.append(row);
+    }
+
+    *ok = true;
+    return rows;
+}
@@ -0,0 +1,106 @@
+#ifndef PAGEDLISTMODELS_H
+#define PAGEDLISTMODELS_H
+
+#include <QAbstractListModel>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVariant>
+#include <QVariantMap>
+#include <QVector>
+
+/**
+ * @brief 分页列表模型基类
+ *
+ * 通过canFetchMore/fetchMore按需加载数据，ListView滚动到末尾时才读取下一页。
+ * 分页使用keyset查询（以上一页最后一行的排序键为起点），而不是OFFSET，
+ * 翻页开销不随已加载行数增长。每行以QVector<QVariant>按角色顺序保存。
+ */
+class PagedListModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int pageSize READ pageSize WRITE setPageSize NOTIFY pageSizeChanged)
+
+public:
+    explicit PagedListModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    int count() const { return m_rows.size(); }
+
+    int pageSize() const { return m_pageSize; }
+    void setPageSize(int pageSize);
+
+    /**
+     * @brief 清空已加载的数据，重新从第一页开始加载
+     */
+    Q_INVOKABLE void reload();
+
+    /**
+     * @brief 获取指定行的全部角色数据
+     * @param row 行号
+     * @return 以角色名为键的数据
+     */
+    Q_INVOKABLE QVariantMap get(int row) const;
+
+    /**
+     * @brief 从模型中移除一行（不修改数据库，用于删除数据后同步界面）
+     * @param row 行号
+     */
+    Q_INVOKABLE void remove(int row);
+
+signals:
+    void countChanged();
+    void pageSizeChanged();
+
+protected:
+    typedef QVector<QVariant> Row;
+
+    // 角色名列表，角色值从Qt::UserRole + 1开始依次分配，每行数据按此顺序存放
+    virtual QList<QByteArray> roleKeys() const = 0;
+
+    /**
+     * @brief 读取一页数据
+     * @param lastRow 上一页的最后一行，为空表示读取第一页
+     * @param limit 最多读取的行数
+     * @param ok 查询是否成功
+     * @return 按角色顺序存放的行数据
+     */
+    virtual QList<Row> fetchPage(const Row &lastRow, int limit, bool *ok) = 0;
+
+    // 读取指定列的数据，子类可在此做延迟转换
+    virtual QVariant columnData(const Row &row, int column) const;
+
+    // 过滤条件是否完整，不完整时不加载数据
+    virtual bool isQueryReady() const { return true; }
+
+private:
+    QList<Row> m_rows;
+    int m_pageSize;
+    bool m_atEnd;
+};
+
+/**
+ * @brief 人脸数据分页模型
+ *
+ * 按姓名排序分页，图像路径转换为file:// URL，与getAllFaceData一致。
+ */
+class FaceDataListModel : public PagedListModel
+{
+    Q_OBJECT
+
+public:
+    explicit FaceDataListModel(QObject *parent = nullptr);
+
+protected:
+    QList<QByteArray> roleKeys() const override;
+    QList<Row> fetchPage(const Row &lastRow, int limit, bool *ok) override;
+};
+
+#endif // PAGEDLISTMODELS_H
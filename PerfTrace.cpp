@@ -0,0 +1,265 @@
+#include "PerfTrace.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+#include <QUrl>
+#include <algorithm>
+
+namespace {
+
+// 保留的调用事件数量
+const int kMaxEvents = 20000;
+
+const qint64 kBucketUpperUs[PerfTrace::kBucketCount - 1] = {
+    100, 500, 1000, 5000, 10000, 50000, 100000, 500000
+};
+
+// 当前线程正在执行的最内层调用
+thread_local PerfTrace::Scope *t_currentScope = nullptr;
+
+int bucketIndex(qint64 durationNs)
+{
+    qint64 us = durationNs / 1000;
+    for (int i = 0; i < PerfTrace::kBucketCount - 1; ++i) {
+        if (us < kBucketUpperUs[i]) {
+            return i;
+        }
+    }
+    return PerfTrace::kBucketCount - 1;
+}
+
+} // namespace
+
+PerfTrace::Site::Site()
+{
+    for (int i = 0; i < kBucketCount; ++i) {
+        buckets[i] = 0;
+    }
+}
+
+PerfTrace::Scope::Scope(Site *site)
+    : m_site(site)
+    , m_parent(t_currentScope)
+    , m_startNs(PerfTrace::getInstance().m_timer.nsecsElapsed())
+    , m_rows(-1)
+{
+    t_currentScope = this;
+}
+
+PerfTrace::Scope::~Scope()
+{
+    PerfTrace &trace = PerfTrace::getInstance();
+    trace.record(m_site, m_startNs, trace.m_timer.nsecsElapsed() - m_startNs, m_rows);
+    t_currentScope = m_parent;
+}
+
+PerfTrace& PerfTrace::getInstance()
+{
+    static PerfTrace trace;
+    return trace;
+}
+
+PerfTrace::PerfTrace(QObject *parent)
+    : QObject(parent)
+    , m_nextEvent(0)
+    , m_eventsWrapped(false)
+{
+    m_timer.start();
+}
+
+PerfTrace::Site *PerfTrace::site(const char *className, const char *function)
+{
+    Site *site = new Site;
+    site->name = QString("%1::%2").arg(QString::fromLatin1(className), QString::fromLatin1(function));
+
+    QMutexLocker locker(&m_mutex);
+    m_sites.append(site);
+    return site;
+}
+
+void PerfTrace::setRows(qint64 rows)
+{
+    if (t_currentScope) {
+        t_currentScope->setRows(rows);
+    }
+}
+
+bool PerfTrace::isEnabled() const
+{
+#ifdef ENABLE_PERF_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void PerfTrace::record(Site *site, qint64 startNs, qint64 durationNs, qint64 rows)
+{
+    site->calls.fetch_add(1, std::memory_order_relaxed);
+    site->totalNs.fetch_add(durationNs, std::memory_order_relaxed);
+    site->buckets[bucketIndex(durationNs)].fetch_add(1, std::memory_order_relaxed);
+    qint64 maxNs = site->maxNs.load(std::memory_order_relaxed);
+    while (durationNs > maxNs && !site->maxNs.compare_exchange_weak(maxNs, durationNs, std::memory_order_relaxed)) {
+    }
+    if (rows >= 0) {
+        site->rows.fetch_add(rows, std::memory_order_relaxed);
+        site->rowCalls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Event event;
+    event.site = site;
+    event.startNs = startNs;
+    event.durationNs = durationNs;
+    event.rows = rows;
+    event.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+
+    QMutexLocker locker(&m_mutex);
+    if (m_events.size() < kMaxEvents) {
+        m_events.append(event);
+    } else {
+        m_events[m_nextEvent] = event;
+        m_eventsWrapped = true;
+    }
+    m_nextEvent = (m_nextEvent + 1) % kMaxEvents;
+}
+
+QVariantList PerfTrace::getStats() const
+{
+    QList<Site *> sites;
+    {
+        QMutexLocker locker(&m_mutex);
+        sites = m_sites;
+    }
+
+    std::sort(sites.begin(), sites.end(), [](const Site *a, const Site *b) {
+        return a->totalNs.load() > b->totalNs.load();
+    });
+
+    QVariantList stats;
+    for (const Site *site : sites) {
+        qint64 calls = site->calls.load();
+        if (calls == 0) {
+            continue;
+        }
+
+        QVariantList buckets;
+        qint64 counts[kBucketCount];
+        for (int i = 0; i < kBucketCount; ++i) {
+            counts[i] = site->buckets[i].load();
+            buckets.append(counts[i]);
+        }
+
+        // 按分布估算P95，取所在区间的上限
+        qint64 p95Target = (calls * 95 + 99) / 100;
+        qint64 seen = 0;
+        double p95Ms = site->maxNs.load() / 1000000.0;
+        for (int i = 0; i < kBucketCount - 1; ++i) {
+            seen += counts[i];
+            if (seen >= p95Target) {
+                p95Ms = qMin(p95Ms, kBucketUpperUs[i] / 1000.0);
+                break;
+            }
+        }
+
+        qint64 rowCalls = site->rowCalls.load();
+
+        QVariantMap item;
+        item["name"] = site->name;
+        item["calls"] = calls;
+        item["totalMs"] = site->totalNs.load() / 1000000.0;
+        item["avgMs"] = site->totalNs.load() / 1000000.0 / calls;
+        item["maxMs"] = site->maxNs.load() / 1000000.0;
+        item["p95Ms"] = p95Ms;
+        item["avgRows"] = rowCalls > 0 ? static_cast<double>(site->rows.load()) / rowCalls : -1.0;
+        item["buckets"] = buckets;
+        stats.append(item);
+    }
+    return stats;
+}
+
+QStringList PerfTrace::getBucketLabels() const
+{
+    QStringList labels;
+    for (int i = 0; i < kBucketCount - 1; ++i) {
+        labels.append(QString("<%1ms").arg(kBucketUpperUs[i] / 1000.0));
+    }
+    labels.append(QString(">=%1ms").arg(kBucketUpperUs[kBucketCount - 2] / 1000.0));
+    return labels;
+}
+
+void PerfTrace::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    for (Site *site : m_sites) {
+        site->calls = 0;
+        site->totalNs = 0;
+        site->maxNs = 0;
+        site->rows = 0;
+        site->rowCalls = 0;
+        for (int i = 0; i < kBucketCount; ++i) {
+            site->buckets[i] = 0;
+        }
+    }
+    m_events.clear();
+    m_nextEvent = 0;
+    m_eventsWrapped = false;
+}
+
+QString PerfTrace::exportTrace(const QString &filePath) const
+{
+    QString path = filePath;
+    if (path.startsWith("file:")) {
+        path = QUrl(path).toLocalFile();
+    }
+    if (path.isEmpty()) {
+        QString logDir = QCoreApplication::applicationDirPath() + "/logs";
+        QDir().mkpath(logDir);
+        path = QString("%1/perf_trace_%2.json").arg(logDir, QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
+    }
+
+    qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+    {
+        QMutexLocker locker(&m_mutex);
+        // 环形缓冲区写满后从最旧的事件开始输出
+        int start = m_eventsWrapped ? m_nextEvent : 0;
+        for (int i = 0; i < m_events.size(); ++i) {
+            const Event &event = m_events[(start + i) % m_events.size()];
+            QJsonObject object;
+            object["name"] = event.site->name;
+            object["cat"] = "invokable";
+            object["ph"] = "X";
+            object["pid"] = pid;
+            object["tid"] = static_cast<qint64>(event.threadId);
+            object["ts"] = event.startNs / 1000.0;
+            object["dur"] = event.durationNs / 1000.0;
+            if (event.rows >= 0) {
+                QJsonObject args;
+                args["rows"] = event.rows;
+                object["args"] = args;
+            }
+            traceEvents.append(object);
+        }
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "无法写入性能追踪文件:" << path;
+        return QString();
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    qDebug() << "性能追踪已导出:" << path << "事件数:" << traceEvents.size();
+    return path;
+}
@@ -0,0 +1,131 @@
+#ifndef PERFTRACE_H
+#define PERFTRACE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QVector>
+#include <atomic>
+
+/**
+ * @brief 热点调用追踪
+ *
+ * 记录各管理类Q_INVOKABLE方法的调用次数、耗时分布和返回行数，
+ * 并保留最近的调用事件，可导出为Chrome Trace JSON（chrome://tracing和Perfetto均可打开）。
+ * 统计结果通过上下文属性 perfTrace 在调试页面查看。
+ *
+ * 在方法开头使用 PERF_TRACE_METHOD()，返回列表前使用 PERF_TRACE_ROWS(行数)。
+ * 未定义 ENABLE_PERF_TRACE 时这两个宏为空，不产生任何开销。
+ */
+class PerfTrace : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled CONSTANT)
+
+public:
+    // 耗时分布的区间上限（微秒），最后一个区间无上限
+    static const int kBucketCount = 9;
+
+    /**
+     * @brief 一个调用点的累计统计，由宏中的静态变量持有，地址在程序运行期间不变
+     */
+    struct Site {
+        QString name;
+        std::atomic<qint64> calls{0};
+        std::atomic<qint64> totalNs{0};
+        std::atomic<qint64> maxNs{0};
+        std::atomic<qint64> rows{0};
+        std::atomic<qint64> rowCalls{0};
+        std::atomic<qint64> buckets[kBucketCount];
+
+        Site();
+    };
+
+    /**
+     * @brief 调用作用域，析构时记录耗时
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(Site *site);
+        ~Scope();
+
+        void setRows(qint64 rows) { m_rows = rows; }
+
+    private:
+        Q_DISABLE_COPY(Scope)
+        Site *m_site;
+        Scope *m_parent;
+        qint64 m_startNs;
+        qint64 m_rows;
+    };
+
+    static PerfTrace& getInstance();
+
+    // 注册调用点（每个调用点只调用一次）
+    Site *site(const char *className, const char *function);
+
+    // 记录当前线程正在执行的调用返回的行数
+    static void setRows(qint64 rows);
+
+    bool isEnabled() const;
+
+    /**
+     * @brief 获取所有调用点的统计，按总耗时降序
+     * @return 每项包含 name、calls、totalMs、avgMs、maxMs、p95Ms、avgRows、buckets
+     */
+    Q_INVOKABLE QVariantList getStats() const;
+
+    /**
+     * @brief 获取耗时分布的区间标签
+     */
+    Q_INVOKABLE QStringList getBucketLabels() const;
+
+    // 清空统计和事件
+    Q_INVOKABLE void reset();
+
+    /**
+     * @brief 导出最近的调用事件为Chrome Trace JSON
+     * @param filePath 文件路径，可以是file:// URL；为空时保存到应用程序目录下的logs目录
+     * @return 实际保存的路径，失败时返回空字符串
+     */
+    Q_INVOKABLE QString exportTrace(const QString &filePath = QString()) const;
+
+private:
+    explicit PerfTrace(QObject *parent = nullptr);
+
+    struct Event {
+        const Site *site;
+        qint64 startNs;
+        qint64 durationNs;
+        qint64 rows;
+        quint64 threadId;
+    };
+
+    // 记录一次调用
+    void record(Site *site, qint64 startNs, qint64 durationNs, qint64 rows);
+
+    QElapsedTimer m_timer;
+
+    mutable QMutex m_mutex;
+    QList<Site *> m_sites;
+    QVector<Event> m_events;   // 环形缓冲区
+    int m_nextEvent;
+    bool m_eventsWrapped;
+};
+
+#ifdef ENABLE_PERF_TRACE
+#define PERF_TRACE_METHOD() \
+    static PerfTrace::Site *perfTraceSite = PerfTrace::getInstance().site(staticMetaObject.className(), __func__); \
+    PerfTrace::Scope perfTraceScope(perfTraceSite)
+#define PERF_TRACE_ROWS(rows) PerfTrace::setRows(rows)
+#else
+#define PERF_TRACE_METHOD() do {} while (0)
+#define PERF_TRACE_ROWS(rows) do {} while (0)
+#endif
+
+#endif // PERFTRACE_H
@@ -121,49 +121,21 @@ Rectangle {
                 
                 // 如果用户错题表中没有数据，尝试从旧的答题记录中提取错题
                 if (wrongQuestionIds.length === 0) {
-                    console.log("错题表中无数据，尝试从旧答题记录中提取")
-                    var records = dbManager.getUserAnswerRecords(userData.workId, 1000, 0)
-                    var tempWrongIds = []
+                    console.log("错题表中无数据，尝试从答题记录错题汇总中加载")
+                    // 错题汇总由C++端在保存答题记录时增量维护，无需在此遍历历史记录
+                    wrongQuestionIds = dbManager.getRecordWrongQuestionIds(userData.workId, questionBankId)
                     
-                    // 遍历用户的答题记录，找出当前题库的错题
-                    for (var i = 0; i < records.length; i++) {
-                        var record = records[i]
-                        var answerData = JSON.parse(record.answer_data || "{}")
-                        var bankInfo = JSON.parse(record.question_bank_info || "{}")
-                        
-                        // 检查是否包含当前题库的题目
-                        for (var questionId in answerData) {
-                            // 检查题目是否属于当前题库
-                            var bankId = bankInfo[questionId]
-                            // 确保两个值都是数字类型进行比较
-                            if (parseInt(bankId) === parseInt(questionBankId)) {
-                                // 检查是否答错
-                                var questionAnswer = answerData[questionId]
-                                if (questionAnswer && !questionAnswer.correct) {
-                                    tempWrongIds.push(parseInt(questionId))
-                                }
-                            }
-                        }
-                    }
-                    
-                    // 移除重复的题目ID
-                    wrongQuestionIds = [...new Set(tempWrongIds)]
-                    console.log("从旧记录加载错题ID:", wrongQuestionIds)
+                    console.log("从答题记录加载错题ID:", wrongQuestionIds)
                     
                     // 保存错题到新表中
                     if (wrongQuestionIds.length > 0) {
-                        var updateSuccess = dbManager.updateUserWrongQuestions(userData.workId, questionBankId, wrongQuestionIds)
-                        console.log("更新错题集" + (updateSuccess ? "成功" : "失败"))
+                        var updateResult = dbManager.updateUserWrongQuestions(userData.workId, questionBankId, wrongQuestionIds)
+                        console.log("更新错题集" + (updateResult.success ? "成功" : "失败"))
                     }
                 }
                 
-                // 加载每个错题的详细信息
-                for (var j = 0; j < wrongQuestionIds.length; j++) {
-                    var question = dbManager.getQuestionById(wrongQuestionIds[j])
-                    if (Object.keys(question).length > 0) {
-                        currentQuestions.push(question)
-                    }
-                }
+                // 一次性批量加载所有错题的详细信息
+                currentQuestions = dbManager.getQuestionsByIds(wrongQuestionIds)
             }
         } else {
             // 加载所有题目（顺序模式）
@@ -204,10 +176,8 @@ Rectangle {
                 var savedAnswers = JSON.parse(progress.userAnswers || "{}")
                 userAnswers = savedAnswers
                 
-                // 新增：记录进入时已经答过的题目ID（这些不计入本次会话）
-                for (var questionId in savedAnswers) {
-                    previouslyAnsweredQuestionIds.push(parseInt(questionId))
-                }
+                // 新增：记录进入时已经答过的题目ID（这些不计入本次会话），由C++端解码提供
+                previouslyAnsweredQuestionIds = progress.answeredQuestionIds || []
                 
                 console.log("已恢复用户进度，当前题目索引:", currentQuestionIndex, "已答题数:", Object.keys(userAnswers).length)
                 console.log("本次进入时已答过的题目ID:", previouslyAnsweredQuestionIds)
@@ -330,12 +300,13 @@ Rectangle {
         }
         // 错题刷题模式下，更新错题集
         else if (wrongQuestionsMode) {
-            var updateSuccess = dbManager.updateUserWrongQuestions(
+            var updateResult = dbManager.updateUserWrongQuestions(
                 userData.workId, 
                 questionBankId, 
                 wrongQuestionIds
             )
-            console.log("更新错题集" + (updateSuccess ? "成功" : "失败") + "，共" + wrongQuestionIds.length + "道错题")
+            console.log("更新错题集" + (updateResult.success ? "成功" : "失败") + "，共" + wrongQuestionIds.length + "道错题" +
+                       "，移除" + updateResult.deletedCount + "道")
         }
         
         // 保存用户当前的题库进度
@@ -365,13 +336,13 @@ Rectangle {
         }
         
         // 更新错题集
-        var updateSuccess = dbManager.updateUserWrongQuestions(
+        var updateResult = dbManager.updateUserWrongQuestions(
             userData.workId, 
             questionBankId, 
             allWrongQuestionIds
         );
-        console.log("保存新错题" + (updateSuccess ? "成功" : "失败") + 
-                   "，新增" + newWrongQuestionIds.length + "道错题，" +
+        console.log("保存新错题" + (updateResult.success ? "成功" : "失败") + 
+                   "，新增" + updateResult.insertedCount + "道错题，" +
                    "错题集现共有" + allWrongQuestionIds.length + "道题");
         
         // 清空新产生的错题集合
@@ -615,12 +586,12 @@ Rectangle {
         console.log("更新后的错题ID列表:", JSON.stringify(wrongQuestionIds), "长度:", wrongQuestionIds.length);
         
         // 更新数据库中的错题记录
-        var updateSuccess = dbManager.updateUserWrongQuestions(
+        var updateResult = dbManager.updateUserWrongQuestions(
             userData.workId, 
             questionBankId, 
             remainingWrongQuestionIds // 即使是空数组也能被正确处理
         );
-        console.log("从错题集移除题目" + (updateSuccess ? "成功" : "失败") + ", 剩余错题数:" + remainingWrongQuestionIds.length);
+        console.log("从错题集移除题目" + (updateResult.success ? "成功" : "失败") + ", 剩余错题数:" + remainingWrongQuestionIds.length);
         
         // 在答题完成时提示用户
         if (questionRemoved) {
@@ -983,63 +954,6 @@ Rectangle {
     Component.onCompleted: {
         loadQuestions()
         forceActiveFocus() // 确保组件获得焦点
-        
-        // 在第一次加载时，如果是错题模式但没有找到错题，尝试分析答题记录找出错题
-        if (wrongQuestionsMode && currentQuestions.length === 0 && userData && userData.workId) {
-            console.log("尝试从答题记录中提取错题...")
-            
-            // 从答题记录中查找错题
-            var records = dbManager.getUserAnswerRecords(userData.workId, 1000, 0)
-            var wrongIds = []
-            
-            // 遍历用户的答题记录，找出当前题库的错题
-            for (var i = 0; i < records.length; i++) {
-                var record = records[i]
-                var answerData = JSON.parse(record.answer_data || "{}")
-                var bankInfo = JSON.parse(record.question_bank_info || "{}")
-                
-                // 检查是否包含当前题库的题目
-                for (var questionId in answerData) {
-                    // 检查题目是否属于当前题库
-                    var bankId = bankInfo[questionId]
-                    // 确保两个值都是数字类型进行比较
-                    if (parseInt(bankId) === parseInt(questionBankId)) {
-                        // 检查是否答错
-                        var questionAnswer = answerData[questionId]
-                        if (questionAnswer && !questionAnswer.correct) {
-                            wrongIds.push(parseInt(questionId))
-                        }
-                    }
-                }
-            }
-            
-            // 移除重复的题目ID
-            wrongQuestionIds = [...new Set(wrongIds)]
-            
-            if (wrongQuestionIds.length > 0) {
-                console.log("从答题记录找到", wrongQuestionIds.length, "道错题")
-                
-                // 更新错题集
-                var updateSuccess = dbManager.updateUserWrongQuestions(userData.workId, questionBankId, wrongQuestionIds)
-                console.log("更新错题集" + (updateSuccess ? "成功" : "失败"))
-                
-                // 重新加载错题
-                for (var j = 0; j < wrongQuestionIds.length; j++) {
-                    var question = dbManager.getQuestionById(wrongQuestionIds[j])
-                    if (Object.keys(question).length > 0) {
-                        currentQuestions.push(question)
-                    }
-                }
-                
-                // 更新UI
-                if (currentQuestions.length > 0) {
-                    noQuestionsText.visible = false;
-                    questionsContainer.visible = true;
-                    // 强制刷新UI
-                    refresh();
-                }
-            }
-        }
     }
     
     // 辅助函数：查找mainPage组件
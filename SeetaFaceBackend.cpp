@@ -0,0 +1,115 @@
+#include "SeetaFaceBackend.h"
+
+namespace {
+
+// SeetaImageData不支持行间距，ROI等不连续的图像先复制
+cv::Mat continuousImage(const cv::Mat &image)
+{
+    return image.isContinuous() ? image : image.clone();
+}
+
+SeetaImageData toImageData(const cv::Mat &image)
+{
+    SeetaImageData imageData;
+    imageData.width = image.cols;
+    imageData.height = image.rows;
+    imageData.channels = image.channels();
+    imageData.data = const_cast<unsigned char *>(image.data);
+    return imageData;
+}
+
+SeetaRect toSeetaRect(const cv::Rect &box)
+{
+    SeetaRect rect;
+    rect.x = box.x;
+    rect.y = box.y;
+    rect.width = box.width;
+    rect.height = box.height;
+    return rect;
+}
+
+} // namespace
+
+SeetaFaceBackend::SeetaFaceBackend(const QSharedPointer<SeetaModelRegistry::ModelSet> &models)
+    : m_models(models)
+{
+}
+
+QString SeetaFaceBackend::name() const
+{
+    return "seeta";
+}
+
+QString SeetaFaceBackend::modelPath() const
+{
+    return m_models->modelPath;
+}
+
+std::vector<FaceDetection> SeetaFaceBackend::detect(const cv::Mat &image)
+{
+    cv::Mat mat = continuousImage(image);
+    SeetaFaceInfoArray faces = m_models->detector->detect(toImageData(mat));
+
+    std::vector<FaceDetection> detections;
+    detections.reserve(faces.size);
+    for (int i = 0; i < faces.size; ++i) {
+        FaceDetection detection;
+        detection.box = cv::Rect(faces.data[i].pos.x, faces.data[i].pos.y, faces.data[i].pos.width, faces.data[i].pos.height);
+        detection.score = faces.data[i].score;
+        detections.push_back(detection);
+    }
+    return detections;
+}
+
+bool SeetaFaceBackend::align(const cv::Mat &image, FaceDetection &face)
+{
+    if (face.landmarks.size() >= 5) {
+        return true;
+    }
+
+    cv::Mat mat = continuousImage(image);
+    std::vector<SeetaPointF> points = m_models->landmarker->mark(toImageData(mat), toSeetaRect(face.box));
+    if (points.size() < 5) {
+        return false;
+    }
+
+    face.landmarks.clear();
+    for (const SeetaPointF &point : points) {
+        face.landmarks.push_back(cv::Point2f(static_cast<float>(point.x), static_cast<float>(point.y)));
+    }
+    return true;
+}
+
+QVector<float> SeetaFaceBackend::embed(const cv::Mat &image, const FaceDetection &face)
+{
+    QVector<float> feature;
+    if (face.landmarks.size() < 5) {
+        return feature;
+    }
+
+    SeetaPointF points[5];
+    for (int i = 0; i < 5; ++i) {
+        points[i].x = face.landmarks[i].x;
+        points[i].y = face.landmarks[i].y;
+    }
+
+    cv::Mat mat = continuousImage(image);
+    feature.resize(m_models->recognizer->GetExtractFeatureSize());
+    if (!m_models->recognizer->Extract(toImageData(mat), points, feature.data())) {
+        feature.clear();
+    }
+    return feature;
+}
+
+float SeetaFaceBackend::similarity(const QVector<float> &feature1, const QVector<float> &feature2) const
+{
+    if (feature1.isEmpty() || feature1.size() != feature2.size() || feature1.size() != featureSize()) {
+        return 0.0f;
+    }
+    return m_models->recognizer->CalculateSimilarity(feature1.constData(), feature2.constData());
+}
+
+int SeetaFaceBackend::featureSize() const
+{
+    return m_models->recognizer->GetExtractFeatureSize();
+}
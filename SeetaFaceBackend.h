@@ -0,0 +1,29 @@
+#ifndef SEETAFACEBACKEND_H
+#define SEETAFACEBACKEND_H
+
+#include "FaceBackend.h"
+#include "SeetaModelRegistry.h"
+
+/**
+ * @brief SeetaFace2后端
+ *
+ * 模型由SeetaModelRegistry按线程共享，本对象只持有引用。
+ */
+class SeetaFaceBackend : public FaceBackend
+{
+public:
+    explicit SeetaFaceBackend(const QSharedPointer<SeetaModelRegistry::ModelSet> &models);
+
+    QString name() const override;
+    QString modelPath() const override;
+    std::vector<FaceDetection> detect(const cv::Mat &image) override;
+    bool align(const cv::Mat &image, FaceDetection &face) override;
+    QVector<float> embed(const cv::Mat &image, const FaceDetection &face) override;
+    float similarity(const QVector<float> &feature1, const QVector<float> &feature2) const override;
+    int featureSize() const override;
+
+private:
+    QSharedPointer<SeetaModelRegistry::ModelSet> m_models;
+};
+
+#endif // SEETAFACEBACKEND_H
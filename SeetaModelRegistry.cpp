@@ -0,0 +1,123 @@
+#include "SeetaModelRegistry.h"
+#include "ModelLocator.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QThread>
+
+SeetaModelRegistry::ModelSet::~ModelSet()
+{
+    delete detector;
+    delete landmarker;
+    delete recognizer;
+    qDebug() << "已释放SeetaFace模型:" << modelPath;
+}
+
+SeetaModelRegistry &SeetaModelRegistry::instance()
+{
+    static SeetaModelRegistry registry;
+    return registry;
+}
+
+QSharedPointer<SeetaModelRegistry::ModelSet> SeetaModelRegistry::acquireLoaded(QThread *owner)
+{
+    QMutexLocker locker(&m_mutex);
+    return m_contexts.value(owner ? owner : QThread::currentThread()).toStrongRef();
+}
+
+QSharedPointer<SeetaModelRegistry::ModelSet> SeetaModelRegistry::acquire(const QString &modelPath, QThread *owner)
+{
+    QThread *thread = owner ? owner : QThread::currentThread();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        // 等待进行中的加载（例如启动后的后台加载）完成
+        while (m_loading.contains(thread)) {
+            m_loaded.wait(&m_mutex);
+        }
+        QSharedPointer<ModelSet> models = m_contexts.value(thread).toStrongRef();
+        if (models) {
+            return models;
+        }
+        m_loading.insert(thread);
+    }
+
+    // 加载耗时较长，不持有锁
+    QSharedPointer<ModelSet> models = load(modelPath);
+
+    QMutexLocker locker(&m_mutex);
+    m_loading.remove(thread);
+    m_loaded.wakeAll();
+    if (!models) {
+        return models;
+    }
+
+    m_contexts.insert(thread, models);
+    m_modelPath = models->modelPath;
+
+    // 清理已释放的上下文
+    for (auto it = m_contexts.begin(); it != m_contexts.end();) {
+        if (it.value().isNull()) {
+            it = m_contexts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    qDebug() << "SeetaFace模型已加载，当前推理上下文数量:" << m_contexts.size();
+    return models;
+}
+
+QString SeetaModelRegistry::modelPath() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_modelPath;
+}
+
+int SeetaModelRegistry::contextCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    int count = 0;
+    for (auto it = m_contexts.constBegin(); it != m_contexts.constEnd(); ++it) {
+        if (!it.value().isNull()) {
+            count++;
+        }
+    }
+    return count;
+}
+
+QSharedPointer<SeetaModelRegistry::ModelSet> SeetaModelRegistry::load(const QString &modelPath)
+{
+    QSharedPointer<ModelSet> models(new ModelSet);
+    models->modelPath = QFileInfo(modelPath).absoluteFilePath();
+
+    seeta::ModelSetting::Device device = seeta::ModelSetting::CPU;
+    int id = 0;
+
+    QHash<QString, QString> files = ModelLocator::modelFiles(modelPath);
+    QString detectorPath = files.value("detector");
+    QString landmarkerPath = files.value("landmarker");
+    QString recognizerPath = files.value("recognizer");
+
+    try {
+        qDebug() << "创建人脸检测器:" << detectorPath;
+        seeta::ModelSetting FD_model(detectorPath.toStdString(), device, id);
+        models->detector = new seeta::FaceDetector(FD_model);
+        models->detector->set(seeta::FaceDetector::PROPERTY_MIN_FACE_SIZE, 80);
+
+        qDebug() << "创建人脸特征点定位器:" << landmarkerPath;
+        seeta::ModelSetting PD_model(landmarkerPath.toStdString(), device, id);
+        models->landmarker = new seeta::FaceLandmarker(PD_model);
+
+        qDebug() << "创建人脸特征提取器:" << recognizerPath;
+        seeta::ModelSetting FR_model(recognizerPath.toStdString(), device, id);
+        models->recognizer = new seeta::FaceRecognizer(FR_model);
+    } catch (const std::exception &e) {
+        qDebug() << "加载SeetaFace模型失败:" << e.what();
+        // 已创建的模型随models析构释放
+        return QSharedPointer<ModelSet>();
+    }
+
+    return models;
+}
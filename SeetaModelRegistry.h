@@ -0,0 +1,85 @@
+#ifndef SEETAMODELREGISTRY_H
+#define SEETAMODELREGISTRY_H
+
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QWaitCondition>
+#include <QWeakPointer>
+
+#include <seeta/FaceDetector.h>
+#include <seeta/FaceRecognizer.h>
+#include <seeta/FaceLandmarker.h>
+
+class QThread;
+
+/**
+ * @brief SeetaFace2模型注册表
+ *
+ * 按线程缓存已加载的检测器、特征点定位器和识别器，同一线程上的所有FaceRecognizer共享一份模型。
+ * SeetaFace2的模型对象不是线程安全的，因此每个线程持有独立的推理上下文。
+ * 模型通过引用计数管理，最后一个使用者释放后才卸载。
+ */
+class SeetaModelRegistry
+{
+public:
+    /**
+     * @brief 一个线程的推理上下文
+     */
+    struct ModelSet {
+        ~ModelSet();
+
+        seeta::FaceDetector *detector = nullptr;
+        seeta::FaceLandmarker *landmarker = nullptr;
+        seeta::FaceRecognizer *recognizer = nullptr;
+        QString modelPath;
+    };
+
+    static SeetaModelRegistry &instance();
+
+    /**
+     * @brief 获取指定线程已加载的模型
+     * @param owner 使用模型的线程，为空时为当前线程
+     * @return 模型，该线程尚未加载时返回空
+     */
+    QSharedPointer<ModelSet> acquireLoaded(QThread *owner = nullptr);
+
+    /**
+     * @brief 获取指定线程的模型，尚未加载时从指定目录加载
+     *
+     * 可以在后台线程中为其他线程加载模型，加载期间该线程的其他请求会等待加载完成。
+     * @param modelPath 模型目录，文件名由目录中的models.json清单决定
+     * @param owner 使用模型的线程，为空时为当前线程
+     * @return 模型，加载失败时返回空
+     */
+    QSharedPointer<ModelSet> acquire(const QString &modelPath, QThread *owner = nullptr);
+
+    /**
+     * @brief 最近一次成功加载使用的模型目录，其他线程可直接复用，无需重新查找
+     */
+    QString modelPath() const;
+
+    /**
+     * @brief 当前仍在使用的推理上下文数量
+     */
+    int contextCount() const;
+
+    /**
+     * @brief 从目录加载一组不登记到注册表的模型（用于基准测试）
+     */
+    static QSharedPointer<ModelSet> load(const QString &modelPath);
+
+private:
+    SeetaModelRegistry() = default;
+    Q_DISABLE_COPY(SeetaModelRegistry)
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_loaded;
+    QSet<QThread *> m_loading;
+    QHash<QThread *, QWeakPointer<ModelSet>> m_contexts;
+    QString m_modelPath;
+};
+
+#endif // SEETAMODELREGISTRY_H
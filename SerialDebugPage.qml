@@ -215,6 +215,241 @@ Rectangle {
             }
         }
         
+        // 人脸登录统计
+        Rectangle {
+            Layout.fillWidth: true
+            height: 50
+            color: "#252525"
+            radius: 10
+            
+            RowLayout {
+                anchors.fill: parent
+                anchors.margins: 10
+                spacing: 10
+                
+                Text {
+                    id: recognitionStatsText
+                    color: "white"
+                    Layout.fillWidth: true
+                    elide: Text.ElideRight
+                    
+                    function refresh() {
+                        var stats = dbManager.getRecognitionStats(30)
+                        if (stats.logins === undefined) {
+                            text = "人脸登录统计读取失败"
+                            return
+                        }
+                        text = "人脸登录（最近30天）: " + stats.logins + "次"
+                                + "  首帧成功率 " + (stats.firstFrameSuccessRate * 100).toFixed(1) + "%"
+                                + "  平均尝试 " + stats.meanAttempts.toFixed(2) + "次"
+                                + "  最多尝试 " + stats.maxAttempts + "次"
+                                + "  平均每人模板 " + (stats.templates || 0).toFixed(1) + "个"
+                    }
+                }
+                
+                Button {
+                    text: "刷新"
+                    onClicked: recognitionStatsText.refresh()
+                }
+            }
+        }
+        
+        // 推理线程各配置的丢帧和推理耗时统计
+        Rectangle {
+            Layout.fillWidth: true
+            Layout.preferredHeight: 160
+            color: "#252525"
+            radius: 10
+            
+            ColumnLayout {
+                anchors.fill: parent
+                anchors.margins: 10
+                spacing: 6
+                
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 10
+                    
+                    Text {
+                        text: "推理线程统计（当前配置: " + inferenceExecutor.profile + "）"
+                        color: "white"
+                        Layout.fillWidth: true
+                    }
+                    
+                    Button {
+                        text: "刷新"
+                        onClicked: inferenceStatsView.refresh()
+                    }
+                    
+                    Button {
+                        text: "清空"
+                        onClicked: {
+                            inferenceExecutor.resetStats()
+                            inferenceStatsView.refresh()
+                        }
+                    }
+                }
+                
+                // 表头
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 0
+                    
+                    Repeater {
+                        model: ["配置", "帧数", "丢帧", "丢帧率", "推理次数", "跳过帧", "平均(ms)", "最大(ms)"]
+                        delegate: Text {
+                            text: modelData
+                            color: "#AAAAAA"
+                            font.bold: true
+                            Layout.preferredWidth: index === 0 ? 160 : 100
+                        }
+                    }
+                }
+                
+                ListView {
+                    id: inferenceStatsView
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+                    clip: true
+                    
+                    function refresh() {
+                        model = inferenceExecutor.getProfileStats()
+                    }
+                    
+                    delegate: RowLayout {
+                        width: inferenceStatsView.width
+                        spacing: 0
+                        
+                        Text {
+                            text: modelData.profile
+                            color: modelData.current ? "#FFD966" : "white"
+                            Layout.preferredWidth: 160
+                        }
+                        Text { text: modelData.frames; color: "white"; Layout.preferredWidth: 100 }
+                        Text { text: modelData.droppedFrames; color: "white"; Layout.preferredWidth: 100 }
+                        Text { text: (modelData.dropRate * 100).toFixed(1) + "%"; color: "white"; Layout.preferredWidth: 100 }
+                        Text { text: modelData.inferences; color: "white"; Layout.preferredWidth: 100 }
+                        Text { text: modelData.skippedFrames; color: "white"; Layout.preferredWidth: 100 }
+                        Text { text: modelData.meanInferenceMs.toFixed(1); color: "white"; Layout.preferredWidth: 100 }
+                        Text { text: modelData.maxInferenceMs.toFixed(1); color: "white"; Layout.preferredWidth: 100 }
+                    }
+                }
+            }
+        }
+        
+        // 调用耗时统计
+        Rectangle {
+            Layout.fillWidth: true
+            Layout.preferredHeight: 300
+            color: "#252525"
+            radius: 10
+            
+            ColumnLayout {
+                anchors.fill: parent
+                anchors.margins: 10
+                spacing: 6
+                
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 10
+                    
+                    Text {
+                        text: perfTrace.enabled ? "调用耗时统计（按总耗时排序）" : "调用耗时统计未启用（Debug构建或以-DENABLE_PERF_TRACE=ON配置时开启）"
+                        color: "white"
+                        Layout.fillWidth: true
+                    }
+                    
+                    Button {
+                        text: "刷新"
+                        enabled: perfTrace.enabled
+                        onClicked: perfStatsView.refresh()
+                    }
+                    
+                    Button {
+                        text: "清空"
+                        enabled: perfTrace.enabled
+                        onClicked: {
+                            perfTrace.reset()
+                            perfStatsView.refresh()
+                        }
+                    }
+                    
+                    Button {
+                        text: "检查查询计划"
+                        onClicked: {
+                            var plans = dbManager.checkHotQueryPlans()
+                            var missed = 0
+                            for (var i = 0; i < plans.length; i++) {
+                                if (!plans[i].usesIndex) {
+                                    missed++
+                                    logTextArea.text += "\n未命中索引: " + plans[i].name + "（预期 " + plans[i].expectedIndex + "）: " + plans[i].plan
+                                }
+                            }
+                            logTextArea.text += "\n热点查询计划检查完成，共" + plans.length + "条，未命中索引" + missed + "条"
+                        }
+                    }
+                    
+                    Button {
+                        text: "导出追踪"
+                        enabled: perfTrace.enabled
+                        onClicked: {
+                            var path = perfTrace.exportTrace("")
+                            logTextArea.text += "\n" + (path !== "" ? "性能追踪已导出: " + path : "性能追踪导出失败")
+                        }
+                    }
+                }
+                
+                // 表头
+                RowLayout {
+                    Layout.fillWidth: true
+                    spacing: 0
+                    
+                    Repeater {
+                        model: ["方法", "次数", "平均(ms)", "P95(ms)", "最大(ms)", "总计(ms)", "平均行数"]
+                        delegate: Text {
+                            text: modelData
+                            color: "#AAAAAA"
+                            font.bold: true
+                            Layout.preferredWidth: index === 0 ? 360 : 100
+                        }
+                    }
+                }
+                
+                ListView {
+                    id: perfStatsView
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+                    clip: true
+                    
+                    function refresh() {
+                        model = perfTrace.getStats()
+                    }
+                    
+                    delegate: RowLayout {
+                        width: perfStatsView.width
+                        spacing: 0
+                        
+                        Text {
+                            text: modelData.name
+                            color: "white"
+                            elide: Text.ElideLeft
+                            Layout.preferredWidth: 360
+                        }
+                        Text { text: modelData.calls; color: "white"; Layout.preferredWidth: 100 }
+                        Text { text: modelData.avgMs.toFixed(2); color: "white"; Layout.preferredWidth: 100 }
+                        Text { text: modelData.p95Ms.toFixed(2); color: "white"; Layout.preferredWidth: 100 }
+                        Text { text: modelData.maxMs.toFixed(2); color: "white"; Layout.preferredWidth: 100 }
+                        Text { text: modelData.totalMs.toFixed(1); color: "#FFD966"; Layout.preferredWidth: 100 }
+                        Text {
+                            text: modelData.avgRows >= 0 ? modelData.avgRows.toFixed(1) : "-"
+                            color: "white"
+                            Layout.preferredWidth: 100
+                        }
+                    }
+                }
+            }
+        }
+        
         // 日志显示
         Rectangle {
             Layout.fillWidth: true
@@ -271,5 +506,8 @@ Rectangle {
         // 初始刷新串口列表
         serialPortManager.refreshPorts()
         logTextArea.text = "串口调试页面已加载"
+        perfStatsView.refresh()
+        recognitionStatsText.refresh()
+        inferenceStatsView.refresh()
     }
 } 
\ No newline at end of file
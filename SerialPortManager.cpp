@@ -1,4 +1,5 @@
 #include "SerialPortManager.h"
+#include "PerfTrace.h"
 #include <QDebug>
 #include "DatabaseManager.h"
 #include <QJsonDocument>
@@ -78,6 +79,7 @@ QVector<bool> SerialPortManager::lightStatus() const
 
 bool SerialPortManager::refreshPorts()
 {
+    PERF_TRACE_METHOD();
     m_availablePorts.clear();
     
     const auto serialPortInfos = QSerialPortInfo::availablePorts();
@@ -98,6 +100,7 @@ bool SerialPortManager::refreshPorts()
 
 bool SerialPortManager::connectToPort()
 {
+    PERF_TRACE_METHOD();
     if (m_currentPort.isEmpty()) {
         // 如果当前没有选择端口，尝试从数据库读取
         DatabaseManager dbManager;
@@ -137,6 +140,7 @@ bool SerialPortManager::connectToPort()
 
 bool SerialPortManager::disconnectFromPort()
 {
+    PERF_TRACE_METHOD();
     if (m_serialPort->isOpen()) {
         m_serialPort->close();
         emit connectionStatusChanged();
@@ -148,6 +152,7 @@ bool SerialPortManager::disconnectFromPort()
 
 bool SerialPortManager::toggleLight(int lightIndex, bool state)
 {
+    PERF_TRACE_METHOD();
     if (!m_serialPort->isOpen()) {
         emit serialError("串口未连接");
         return false;
@@ -172,6 +177,7 @@ bool SerialPortManager::toggleLight(int lightIndex, bool state)
 
 bool SerialPortManager::toggleLights(const QString &jsonControls)
 {
+    PERF_TRACE_METHOD();
     if (!m_serialPort->isOpen()) {
         emit serialError("串口未连接");
         return false;
@@ -241,6 +247,7 @@ bool SerialPortManager::toggleLights(const QString &jsonControls)
 
 bool SerialPortManager::getAllLightStatus()
 {
+    PERF_TRACE_METHOD();
     if (!m_serialPort->isOpen()) {
         emit serialError("串口未连接");
         return false;
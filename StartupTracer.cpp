@@ -0,0 +1,146 @@
+#include "StartupTracer.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+
+StartupTracer& StartupTracer::getInstance()
+{
+    static StartupTracer tracer;
+    return tracer;
+}
+
+StartupTracer::StartupTracer()
+    : m_exitAfterFirstFrame(false)
+{
+    m_timer.start();
+}
+
+void StartupTracer::parseArguments(int argc, char *argv[])
+{
+    m_traceFilePath = qEnvironmentVariable("SPARKEXAM_STARTUP_TRACE");
+    m_exitAfterFirstFrame = qEnvironmentVariable("SPARKEXAM_EXIT_AFTER_FIRST_FRAME") == "1";
+
+    for (int i = 1; i < argc; ++i) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--startup-trace" && i + 1 < argc) {
+            m_traceFilePath = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg.startsWith("--startup-trace=")) {
+            m_traceFilePath = arg.mid(16);
+        } else if (arg == "--exit-after-first-frame") {
+            m_exitAfterFirstFrame = true;
+        }
+    }
+}
+
+quint64 StartupTracer::currentThreadId()
+{
+    return reinterpret_cast<quintptr>(QThread::currentThreadId());
+}
+
+void StartupTracer::begin(const QString &name)
+{
+    Event event;
+    event.name = name;
+    event.startNs = m_timer.nsecsElapsed();
+    event.durationNs = -1;
+    event.threadId = currentThreadId();
+    event.instant = false;
+
+    QMutexLocker locker(&m_mutex);
+    m_events.append(event);
+}
+
+void StartupTracer::end(const QString &name)
+{
+    qint64 now = m_timer.nsecsElapsed();
+
+    QMutexLocker locker(&m_mutex);
+    for (int i = m_events.size() - 1; i >= 0; --i) {
+        Event &event = m_events[i];
+        if (!event.instant && event.durationNs < 0 && event.name == name) {
+            event.durationNs = now - event.startNs;
+            return;
+        }
+    }
+    qDebug() << "启动追踪：结束了未开始的阶段" << name;
+}
+
+void StartupTracer::instant(const QString &name)
+{
+    Event event;
+    event.name = name;
+    event.startNs = m_timer.nsecsElapsed();
+    event.durationNs = 0;
+    event.threadId = currentThreadId();
+    event.instant = true;
+
+    QMutexLocker locker(&m_mutex);
+    m_events.append(event);
+}
+
+void StartupTracer::report() const
+{
+    QMutexLocker locker(&m_mutex);
+    qDebug() << "\n----- 启动耗时汇总 -----";
+    for (const Event &event : m_events) {
+        if (event.instant) {
+            qDebug().noquote() << QString("  %1 @ %2 ms").arg(event.name).arg(event.startNs / 1000000.0, 0, 'f', 1);
+        } else if (event.durationNs >= 0) {
+            qDebug().noquote() << QString("  %1: %2 ms").arg(event.name).arg(event.durationNs / 1000000.0, 0, 'f', 1);
+        } else {
+            qDebug().noquote() << QString("  %1: 未结束").arg(event.name);
+        }
+    }
+    qDebug() << "  总计:" << m_timer.elapsed() << "ms";
+}
+
+bool StartupTracer::writeTrace(const QString &filePath) const
+{
+    QString path = filePath.isEmpty() ? m_traceFilePath : filePath;
+    if (path.isEmpty()) {
+        return false;
+    }
+
+    qint64 pid = QCoreApplication::instance() ? QCoreApplication::applicationPid() : 0;
+    QJsonArray traceEvents;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const Event &event : m_events) {
+            QJsonObject object;
+            object["name"] = event.name;
+            object["cat"] = "startup";
+            object["pid"] = pid;
+            object["tid"] = static_cast<qint64>(event.threadId);
+            object["ts"] = event.startNs / 1000.0;
+            if (event.instant) {
+                object["ph"] = "i";
+                object["s"] = "p";
+            } else {
+                object["ph"] = "X";
+                // 未结束的阶段记录到当前时刻
+                qint64 durationNs = event.durationNs >= 0 ? event.durationNs : m_timer.nsecsElapsed() - event.startNs;
+                object["dur"] = durationNs / 1000.0;
+            }
+            traceEvents.append(object);
+        }
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "无法写入启动追踪文件:" << path;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    qDebug() << "启动追踪已写入:" << path;
+    return true;
+}
@@ -0,0 +1,90 @@
+#ifndef STARTUPTRACER_H
+#define STARTUPTRACER_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+/**
+ * @brief 启动过程追踪器
+ *
+ * 使用单调时钟记录启动各阶段的起止时间，可导出为Chrome Trace格式的JSON
+ * （在chrome://tracing或Perfetto中打开），用于分析冷启动耗时。
+ *
+ * 启动参数：
+ *   --startup-trace <文件>     退出时（或首帧后退出时）写入追踪文件
+ *   --exit-after-first-frame   首帧渲染后写入追踪文件并退出，便于在CI中无界面测量启动耗时
+ *                              （配合 QT_QPA_PLATFORM=offscreen 使用）
+ * 也可以通过环境变量 SPARKEXAM_STARTUP_TRACE 和 SPARKEXAM_EXIT_AFTER_FIRST_FRAME=1 设置。
+ */
+class StartupTracer
+{
+public:
+    static StartupTracer& getInstance();
+
+    // 解析启动参数和环境变量，需在创建QCoreApplication之前调用
+    void parseArguments(int argc, char *argv[]);
+
+    // 开始一个阶段，可嵌套，可在任意线程调用
+    void begin(const QString &name);
+
+    // 结束最近开始的同名阶段
+    void end(const QString &name);
+
+    // 记录一个瞬时事件（例如首帧显示）
+    void instant(const QString &name);
+
+    // 距追踪开始的毫秒数
+    qint64 elapsedMs() const { return m_timer.elapsed(); }
+
+    // 输出各阶段耗时汇总
+    void report() const;
+
+    /**
+     * @brief 写入Chrome Trace JSON
+     * @param filePath 文件路径，为空时使用 --startup-trace 指定的路径
+     * @return 是否写入成功（未指定路径时返回false）
+     */
+    bool writeTrace(const QString &filePath = QString()) const;
+
+    QString traceFilePath() const { return m_traceFilePath; }
+    bool exitAfterFirstFrame() const { return m_exitAfterFirstFrame; }
+
+    /**
+     * @brief 阶段作用域，析构时结束阶段
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(const QString &name) : m_name(name) { StartupTracer::getInstance().begin(m_name); }
+        ~Scope() { StartupTracer::getInstance().end(m_name); }
+
+    private:
+        Q_DISABLE_COPY(Scope)
+        QString m_name;
+    };
+
+private:
+    StartupTracer();
+    Q_DISABLE_COPY(StartupTracer)
+
+    struct Event {
+        QString name;
+        qint64 startNs;
+        qint64 durationNs;   // -1表示尚未结束，0表示瞬时事件
+        quint64 threadId;
+        bool instant;
+    };
+
+    static quint64 currentThreadId();
+
+    QElapsedTimer m_timer;
+    mutable QMutex m_mutex;
+    QList<Event> m_events;
+
+    QString m_traceFilePath;
+    bool m_exitAfterFirstFrame;
+};
+
+#endif // STARTUPTRACER_H
@@ -0,0 +1,1173 @@
+/**
+ * 人脸识别流水线基准测试
+ *
+ * 不启动界面，直接在一组图像上依次运行 解码 -> 检测 -> 特征点定位 -> 特征提取 -> 1:N比对，
+ * 与detectFacePosition、compareFaces、recognizeFace使用的后端和特征库相同。
+ * 输出各阶段耗时的分位数、每核吞吐量和进程峰值内存，可按后端、线程数和输入分辨率组合测试。
+ *
+ * 用法：
+ *   FacePipelineBenchmark <图像目录> [--backend seeta|opencv_dnn|all] [--threads 1,2,4]
+ *                         [--resolutions 0,640,320] [--iterations 3] [--gallery 1000]
+ *                         [--manifest corpus.sha256] [--write-manifest corpus.sha256]
+ *                         [--output result.json] [--baseline baseline.json] [--max-regression 0.1]
+ *   FacePipelineBenchmark <图像目录> --mode backends [--threshold 0.6] [--resolutions 1280]
+ *   FacePipelineBenchmark <测试图像目录> --mode gallery --enrol <注册图像目录> [--template-scoring max|mean]
+ *   FacePipelineBenchmark --mode index [--index-sizes 1000,10000,100000] [--dimension 1024]
+ *
+ * backends模式比较各后端的加载耗时、内存、检出率、Rank-1准确率和FAR/FRR，
+ * 图像文件名中第一个下划线之前为工号（例如 1001_2.jpg）。
+ * gallery模式用注册图像建立特征库（每人可有多个模板），比较逐一全精度比对与各量化方式召回+重排序的
+ * 首位一致率、准确率、近似得分误差、内存和每秒识别次数。
+ * index模式用随机特征测试HNSW索引，与逐一全精度比对比较recall@1和单次检索耗时，不需要图像和模型。
+ *
+ * 图像语料由清单文件固定（格式与sha256sum的输出相同），清单中的文件缺失或内容不同时拒绝运行，
+ * 保证不同机器、不同版本之间的结果可以比较。指定baseline时，任一组合中任一阶段的p50或p90
+ * 比基线慢超过max-regression，以退出码2结束，可作为人脸相关改动的回归门禁。
+ */
+
+#include "FaceBackend.h"
+#include "FaceGallery.h"
+#include "HnswIndex.h"
+#include "ModelLocator.h"
+
+#include <QBuffer>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QImage>
+#include <QImageReader>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QThread>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+
+#ifdef Q_OS_WIN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const QStringList kStages = {"decode", "detect", "landmark", "extract", "match"};
+
+// 与DatabaseManager的kFaceRerankCandidates一致
+const int kRerankCandidates = 32;
+
+// index模式每个规模的查询次数
+const int kIndexQueries = 200;
+
+// 合成特征库使用固定的随机种子，每次运行的特征库相同
+const unsigned kGallerySeed = 20240601;
+
+struct CorpusImage {
+    QString name;
+    QByteArray data;   // 原始文件内容，解码计入decode阶段
+};
+
+// 一个线程记录的各阶段耗时（毫秒）
+struct StageSamples {
+    QHash<QString, QVector<double>> samples;
+    int processed = 0;
+    int detected = 0;
+};
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QList<int> parseIntList(const QString &text)
+{
+    QList<int> values;
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        int value = part.trimmed().toInt(&ok);
+        if (ok) {
+            values.append(value);
+        }
+    }
+    return values;
+}
+
+// 进程的峰值物理内存（字节），单调不减
+qint64 peakRssBytes()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<qint64>(counters.PeakWorkingSetSize);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return static_cast<qint64>(usage.ru_maxrss) * 1024;
+    }
+    return 0;
+#endif
+}
+
+// 进程当前占用的物理内存（字节），无法获取时为0
+qint64 currentRssBytes()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<qint64>(counters.WorkingSetSize);
+    }
+    return 0;
+#else
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    QList<QByteArray> fields = statm.readAll().split(' ');
+    return fields.size() > 1 ? fields[1].toLongLong() * sysconf(_SC_PAGESIZE) : 0;
+#endif
+}
+
+// 图像文件名中第一个下划线之前为工号
+QString imageLabel(const QString &name)
+{
+    return QFileInfo(name).completeBaseName().section('_', 0, 0);
+}
+
+// 解码并按长边缩放，maxSide为0时保持原始分辨率
+// 与FaceRecognizer::loadWorkingImage一致，由解码器直接输出缩小后的图像
+cv::Mat decodeImage(const QByteArray &data, int maxSide)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    QImageReader reader(&buffer);
+    QSize size = reader.size();
+    if (maxSide > 0 && size.isValid() && std::max(size.width(), size.height()) > maxSide) {
+        reader.setScaledSize(size.scaled(maxSide, maxSide, Qt::KeepAspectRatio));
+    }
+
+    QImage image = reader.read();
+    if (image.isNull()) {
+        return cv::Mat();
+    }
+    image = image.convertToFormat(QImage::Format_RGB888);
+
+    cv::Mat rgb(image.height(), image.width(), CV_8UC3, const_cast<uchar *>(image.constBits()), image.bytesPerLine());
+    cv::Mat bgr;
+    cv::cvtColor(rgb, bgr, cv::COLOR_RGB2BGR);
+
+    // 无法预先读取尺寸的格式按原分辨率解码后再缩小
+    int longSide = std::max(bgr.cols, bgr.rows);
+    if (maxSide > 0 && longSide > maxSide) {
+        double scale = static_cast<double>(maxSide) / longSide;
+        cv::resize(bgr, bgr, cv::Size(), scale, scale, cv::INTER_AREA);
+    }
+    return bgr;
+}
+
+int bestFace(const std::vector<FaceDetection> &faces)
+{
+    int best = -1;
+    for (int i = 0; i < static_cast<int>(faces.size()); ++i) {
+        if (best < 0 || faces[i].score > faces[best].score) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/**
+ * 读取图像目录，有清单时按清单校验并只使用清单中的文件
+ * @return 图像，校验失败时为空
+ */
+QList<CorpusImage> loadCorpus(const QString &dirPath, const QString &manifestPath, QString *fingerprint)
+{
+    QList<CorpusImage> corpus;
+    QDir dir(dirPath);
+
+    // 清单：每行 "<sha256>  <文件名>"
+    QList<QPair<QString, QString>> expected;
+    if (!manifestPath.isEmpty()) {
+        QFile manifest(manifestPath);
+        if (!manifest.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            qWarning() << "无法读取语料清单:" << manifestPath;
+            return corpus;
+        }
+        while (!manifest.atEnd()) {
+            QString line = QString::fromUtf8(manifest.readLine()).trimmed();
+            if (line.isEmpty() || line.startsWith('#')) {
+                continue;
+            }
+            QString hash = line.section(' ', 0, 0);
+            QString name = line.section(' ', 1).trimmed();
+            if (name.startsWith('*')) {
+                name.remove(0, 1);
+            }
+            expected.append(qMakePair(hash.toLower(), name));
+        }
+    } else {
+        const QStringList files = dir.entryList(QStringList() << "*.jpg" << "*.jpeg" << "*.png" << "*.bmp",
+                                                QDir::Files, QDir::Name);
+        for (const QString &name : files) {
+            expected.append(qMakePair(QString(), name));
+        }
+    }
+
+    QCryptographicHash corpusHash(QCryptographicHash::Sha256);
+    for (const auto &entry : expected) {
+        QFile file(dir.filePath(entry.second));
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "语料中的图像不存在:" << entry.second;
+            return QList<CorpusImage>();
+        }
+        CorpusImage image;
+        image.name = entry.second;
+        image.data = file.readAll();
+
+        QString hash = QString::fromLatin1(QCryptographicHash::hash(image.data, QCryptographicHash::Sha256).toHex());
+        if (!entry.first.isEmpty() && entry.first != hash) {
+            qWarning() << "语料中的图像与清单不一致:" << entry.second;
+            return QList<CorpusImage>();
+        }
+        corpusHash.addData(QString("%1  %2\n").arg(hash, image.name).toUtf8());
+        corpus.append(image);
+    }
+
+    *fingerprint = QString::fromLatin1(corpusHash.result().toHex());
+    return corpus;
+}
+
+bool writeManifest(const QString &path, const QList<CorpusImage> &corpus)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        qWarning() << "无法写入语料清单:" << path;
+        return false;
+    }
+    for (const CorpusImage &image : corpus) {
+        QByteArray hash = QCryptographicHash::hash(image.data, QCryptographicHash::Sha256).toHex();
+        file.write(hash + "  " + image.name.toUtf8() + "\n");
+    }
+    return true;
+}
+
+/**
+ * 用全分辨率图像的特征加上合成特征建立特征库，与DatabaseManager相同使用int8召回、全精度重排
+ */
+void buildGallery(FaceBackend *backend, const QList<CorpusImage> &corpus, int gallerySize,
+                  FaceGallery &gallery, QHash<QString, QVector<float>> &features)
+{
+    gallery.setQuantization(FaceGallery::Int8);
+    for (const CorpusImage &image : corpus) {
+        cv::Mat mat = decodeImage(image.data, 0);
+        std::vector<FaceDetection> faces = backend->detect(mat);
+        int best = bestFace(faces);
+        if (best < 0 || !backend->align(mat, faces[best])) {
+            continue;
+        }
+        QVector<float> feature = backend->embed(mat, faces[best]);
+        if (!feature.isEmpty()) {
+            features.insert(image.name, feature);
+            gallery.setFeature(image.name, feature);
+        }
+    }
+
+    std::mt19937 random(kGallerySeed);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    for (int i = features.size(); i < gallerySize; ++i) {
+        QVector<float> feature(backend->featureSize());
+        for (float &value : feature) {
+            value = normal(random);
+        }
+        QString label = QString("synthetic_%1").arg(i);
+        features.insert(label, feature);
+        gallery.setFeature(label, feature);
+    }
+}
+
+QJsonObject summarize(QVector<double> values)
+{
+    QJsonObject summary;
+    summary["count"] = values.size();
+    if (values.isEmpty()) {
+        return summary;
+    }
+    std::sort(values.begin(), values.end());
+    auto percentile = [&values](double p) {
+        int index = qBound(0, static_cast<int>(std::ceil(p * values.size())) - 1, static_cast<int>(values.size()) - 1);
+        return values[index];
+    };
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    summary["mean"] = sum / values.size();
+    summary["p50"] = percentile(0.50);
+    summary["p90"] = percentile(0.90);
+    summary["p99"] = percentile(0.99);
+    summary["max"] = values.last();
+    return summary;
+}
+
+/**
+ * 运行一个组合（后端、线程数、分辨率），每个线程使用独立加载的后端
+ */
+QJsonObject runConfig(const QString &backendName, const QString &modelDir, int threads, int resolution,
+                      int iterations, const QList<CorpusImage> &corpus,
+                      const FaceGallery &gallery, const QHash<QString, QVector<float>> &galleryFeatures)
+{
+    QJsonObject result;
+    result["backend"] = backendName;
+    result["threads"] = threads;
+    result["resolution"] = resolution;
+
+    QVector<StageSamples> workerSamples(threads);
+    std::atomic<int> nextTask(0);
+    std::atomic<int> readyWorkers(0);
+    std::atomic<bool> failed(false);
+    int totalTasks = iterations * corpus.size();
+    QElapsedTimer wallTimer;
+
+    auto worker = [&](int index) {
+        QSharedPointer<FaceBackend> backend = FaceBackend::create(backendName, modelDir);
+        if (!backend) {
+            failed = true;
+            ++readyWorkers;
+            return;
+        }
+
+        // 预热，首次推理的内存分配不计入耗时
+        cv::Mat warmup = decodeImage(corpus.first().data, resolution);
+        std::vector<FaceDetection> warmupFaces = backend->detect(warmup);
+        if (!warmupFaces.empty() && backend->align(warmup, warmupFaces[0])) {
+            backend->embed(warmup, warmupFaces[0]);
+        }
+
+        // 所有线程都准备好后同时开始
+        ++readyWorkers;
+        while (readyWorkers.load() < threads) {
+            std::this_thread::yield();
+        }
+
+        StageSamples &samples = workerSamples[index];
+        QElapsedTimer timer;
+        for (int task = nextTask++; task < totalTasks && !failed; task = nextTask++) {
+            const CorpusImage &image = corpus[task % corpus.size()];
+            ++samples.processed;
+
+            timer.start();
+            cv::Mat mat = decodeImage(image.data, resolution);
+            samples.samples["decode"].append(timer.nsecsElapsed() / 1e6);
+            if (mat.empty()) {
+                continue;
+            }
+
+            timer.start();
+            std::vector<FaceDetection> faces = backend->detect(mat);
+            samples.samples["detect"].append(timer.nsecsElapsed() / 1e6);
+            int best = bestFace(faces);
+            if (best < 0) {
+                continue;
+            }
+            ++samples.detected;
+
+            timer.start();
+            bool aligned = backend->align(mat, faces[best]);
+            samples.samples["landmark"].append(timer.nsecsElapsed() / 1e6);
+            if (!aligned) {
+                continue;
+            }
+
+            timer.start();
+            QVector<float> feature = backend->embed(mat, faces[best]);
+            samples.samples["extract"].append(timer.nsecsElapsed() / 1e6);
+            if (feature.isEmpty()) {
+                continue;
+            }
+
+            // 召回候选后用全精度特征重新计算相似度，与recognizeFace相同
+            timer.start();
+            float bestScore = 0.0f;
+            for (const FaceGallery::Candidate &candidate : gallery.candidates(feature, kRerankCandidates)) {
+                bestScore = std::max(bestScore, backend->similarity(feature, galleryFeatures.value(candidate.workId)));
+            }
+            samples.samples["match"].append(timer.nsecsElapsed() / 1e6);
+            Q_UNUSED(bestScore);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(worker, i);
+    }
+    while (readyWorkers.load() < threads) {
+        std::this_thread::yield();
+    }
+    wallTimer.start();
+    for (std::thread &thread : workers) {
+        thread.join();
+    }
+    double wallMs = wallTimer.nsecsElapsed() / 1e6;
+
+    if (failed) {
+        result["error"] = QString("无法加载后端 %1").arg(backendName);
+        return result;
+    }
+
+    int processed = 0;
+    int detected = 0;
+    QHash<QString, QVector<double>> merged;
+    for (const StageSamples &samples : workerSamples) {
+        processed += samples.processed;
+        detected += samples.detected;
+        for (const QString &stage : kStages) {
+            merged[stage] += samples.samples.value(stage);
+        }
+    }
+
+    QJsonObject stages;
+    for (const QString &stage : kStages) {
+        stages[stage] = summarize(merged.value(stage));
+    }
+
+    double throughput = wallMs > 0.0 ? processed * 1000.0 / wallMs : 0.0;
+    result["images"] = processed;
+    result["detectionRate"] = processed > 0 ? static_cast<double>(detected) / processed : 0.0;
+    result["wallMs"] = wallMs;
+    result["throughput"] = throughput;
+    result["throughputPerCore"] = throughput / threads;
+    result["peakRssBytes"] = peakRssBytes();
+    result["stages"] = stages;
+    return result;
+}
+
+/**
+ * 比较一个后端：单独加载一份模型，统计加载耗时、预热后增加的内存、检测和特征提取耗时，
+ * 以及两两比对的留一法Rank-1（只统计有其他同人图像的查询）和按阈值的FAR、FRR。
+ * 已释放的内存未必归还系统，内存结果仅供参考。
+ */
+QJsonObject compareBackend(const QString &backendName, const QString &modelDir, int resolution,
+                           float threshold, const QList<CorpusImage> &corpus)
+{
+    QJsonObject result;
+    result["backend"] = backendName;
+    result["resolution"] = resolution;
+
+    // 先解码全部图像，解码时间不计入后端的耗时
+    QList<cv::Mat> images;
+    QStringList labels;
+    for (const CorpusImage &image : corpus) {
+        cv::Mat mat = decodeImage(image.data, resolution);
+        if (!mat.empty()) {
+            images.append(mat);
+            labels.append(imageLabel(image.name));
+        }
+    }
+    result["images"] = images.size();
+    if (images.isEmpty()) {
+        result["error"] = QString("没有可解码的图像");
+        return result;
+    }
+
+    qint64 memoryBefore = currentRssBytes();
+    QElapsedTimer timer;
+    timer.start();
+    QSharedPointer<FaceBackend> backend = FaceBackend::create(backendName, modelDir);
+    if (!backend) {
+        result["error"] = QString("无法加载后端 %1").arg(backendName);
+        return result;
+    }
+    result["loadMs"] = timer.nsecsElapsed() / 1e6;
+    result["featureSize"] = backend->featureSize();
+
+    // 预热一次，首次推理时分配的缓冲区计入内存
+    std::vector<FaceDetection> warmupFaces = backend->detect(images.first());
+    if (!warmupFaces.empty() && backend->align(images.first(), warmupFaces[0])) {
+        backend->embed(images.first(), warmupFaces[0]);
+    }
+    result["memoryBytes"] = currentRssBytes() - memoryBefore;
+
+    QList<QVector<float>> features;
+    QStringList featureLabels;
+    QVector<double> detectMs;
+    QVector<double> embedMs;
+    for (int i = 0; i < images.size(); ++i) {
+        timer.start();
+        std::vector<FaceDetection> faces = backend->detect(images[i]);
+        detectMs.append(timer.nsecsElapsed() / 1e6);
+        int best = bestFace(faces);
+        if (best < 0) {
+            continue;
+        }
+
+        timer.start();
+        QVector<float> feature;
+        if (backend->align(images[i], faces[best])) {
+            feature = backend->embed(images[i], faces[best]);
+        }
+        embedMs.append(timer.nsecsElapsed() / 1e6);
+        if (!feature.isEmpty()) {
+            features.append(feature);
+            featureLabels.append(labels[i]);
+        }
+    }
+    result["detectionRate"] = static_cast<double>(embedMs.size()) / images.size();
+    result["detect"] = summarize(detectMs);
+    result["embed"] = summarize(embedMs);
+
+    int genuinePairs = 0;
+    int impostorPairs = 0;
+    int falseRejects = 0;
+    int falseAccepts = 0;
+    int rankQueries = 0;
+    int rankCorrect = 0;
+    for (int i = 0; i < features.size(); ++i) {
+        float bestScore = -1.0f;
+        int bestIndex = -1;
+        bool hasGenuine = false;
+        for (int j = 0; j < features.size(); ++j) {
+            if (j == i) {
+                continue;
+            }
+            float score = backend->similarity(features[i], features[j]);
+            bool genuine = featureLabels[i] == featureLabels[j];
+            hasGenuine = hasGenuine || genuine;
+            if (score > bestScore) {
+                bestScore = score;
+                bestIndex = j;
+            }
+            if (j < i) {
+                continue;
+            }
+            if (genuine) {
+                ++genuinePairs;
+                falseRejects += score < threshold ? 1 : 0;
+            } else {
+                ++impostorPairs;
+                falseAccepts += score >= threshold ? 1 : 0;
+            }
+        }
+        if (hasGenuine) {
+            ++rankQueries;
+            rankCorrect += featureLabels[bestIndex] == featureLabels[i] ? 1 : 0;
+        }
+    }
+    result["threshold"] = threshold;
+    result["rank1Accuracy"] = rankQueries > 0 ? static_cast<double>(rankCorrect) / rankQueries : 0.0;
+    result["genuinePairs"] = genuinePairs;
+    result["impostorPairs"] = impostorPairs;
+    result["frr"] = genuinePairs > 0 ? static_cast<double>(falseRejects) / genuinePairs : 0.0;
+    result["far"] = impostorPairs > 0 ? static_cast<double>(falseAccepts) / impostorPairs : 0.0;
+    return result;
+}
+
+void printBackendComparison(const QJsonObject &result)
+{
+    out() << QString("%1  分辨率=%2")
+             .arg(result["backend"].toString())
+             .arg(result["resolution"].toInt() > 0 ? QString::number(result["resolution"].toInt()) : QString("原始"));
+    if (result.contains("error")) {
+        out() << "  " << result["error"].toString() << Qt::endl;
+        return;
+    }
+    out() << QString("  加载 %1ms  内存 %2 MB  检出率 %3  检测p50 %4ms  特征提取p50 %5ms")
+             .arg(result["loadMs"].toDouble(), 0, 'f', 1)
+             .arg(result["memoryBytes"].toDouble() / (1024.0 * 1024.0), 0, 'f', 1)
+             .arg(result["detectionRate"].toDouble(), 0, 'f', 3)
+             .arg(result["detect"].toObject()["p50"].toDouble(), 0, 'f', 2)
+             .arg(result["embed"].toObject()["p50"].toDouble(), 0, 'f', 2) << Qt::endl;
+    out() << QString("    Rank-1 %1  阈值 %2  FAR %3 (%4对)  FRR %5 (%6对)")
+             .arg(result["rank1Accuracy"].toDouble(), 0, 'f', 3)
+             .arg(result["threshold"].toDouble(), 0, 'f', 2)
+             .arg(result["far"].toDouble(), 0, 'f', 4).arg(result["impostorPairs"].toInt())
+             .arg(result["frr"].toDouble(), 0, 'f', 4).arg(result["genuinePairs"].toInt()) << Qt::endl;
+}
+
+// 图像中置信度最高的人脸的特征，未检测到或提取失败时为空
+QVector<float> extractBestFeature(FaceBackend *backend, const QByteArray &data, int resolution)
+{
+    cv::Mat mat = decodeImage(data, resolution);
+    if (mat.empty()) {
+        return QVector<float>();
+    }
+    std::vector<FaceDetection> faces = backend->detect(mat);
+    int best = bestFace(faces);
+    if (best < 0 || !backend->align(mat, faces[best])) {
+        return QVector<float>();
+    }
+    return backend->embed(mat, faces[best]);
+}
+
+// 一个人的各模板与查询特征的得分，与DatabaseManager::aggregateTemplateScore一致
+float templateScore(FaceBackend *backend, const QVector<float> &probe, const QList<QVector<float>> &templates, bool useMean)
+{
+    if (templates.isEmpty()) {
+        return 0.0f;
+    }
+    float best = 0.0f;
+    float sum = 0.0f;
+    for (const QVector<float> &feature : templates) {
+        float similarity = backend->similarity(probe, feature);
+        best = std::max(best, similarity);
+        sum += similarity;
+    }
+    return useMean ? sum / templates.size() : best;
+}
+
+/**
+ * 评估特征库量化对识别的影响：逐一全精度比对为基准，各量化方式召回候选后用全精度模板重排序，
+ * 与recognizeFace相同
+ */
+QJsonObject evaluateGallery(FaceBackend *backend, const QList<CorpusImage> &enrolCorpus,
+                            const QList<CorpusImage> &probeCorpus, int resolution, bool useMean)
+{
+    QJsonObject result;
+
+    // 工号 -> 模板特征，模板标识为 工号#序号
+    QHash<QString, QList<QVector<float>>> templates;
+    QHash<QString, QVector<float>> templateFeatures;
+    QHash<QString, QString> templateOwners;
+    for (const CorpusImage &image : enrolCorpus) {
+        QVector<float> feature = extractBestFeature(backend, image.data, resolution);
+        if (feature.isEmpty()) {
+            qWarning() << "注册图像中未能提取特征，跳过:" << image.name;
+            continue;
+        }
+        QString workId = imageLabel(image.name);
+        QString label = QString("%1#%2").arg(workId).arg(templates[workId].size());
+        templates[workId].append(feature);
+        templateFeatures.insert(label, feature);
+        templateOwners.insert(label, workId);
+    }
+
+    QStringList expectedIds;
+    QList<QVector<float>> probes;
+    for (const CorpusImage &image : probeCorpus) {
+        QVector<float> probe = extractBestFeature(backend, image.data, resolution);
+        if (probe.isEmpty()) {
+            qWarning() << "测试图像中未能提取特征，跳过:" << image.name;
+            continue;
+        }
+        expectedIds.append(imageLabel(image.name));
+        probes.append(probe);
+    }
+    if (templates.isEmpty() || probes.isEmpty()) {
+        result["error"] = QString("没有可用的注册图像或测试图像");
+        return result;
+    }
+
+    // 基准：逐一全精度比对
+    QStringList exactIds;
+    int exactCorrect = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < probes.size(); ++i) {
+        float best = -1.0f;
+        QString bestId;
+        for (auto it = templates.constBegin(); it != templates.constEnd(); ++it) {
+            float similarity = templateScore(backend, probes[i], it.value(), useMean);
+            if (similarity > best) {
+                best = similarity;
+                bestId = it.key();
+            }
+        }
+        exactIds.append(bestId);
+        exactCorrect += bestId == expectedIds[i] ? 1 : 0;
+    }
+    double exactMs = timer.nsecsElapsed() / 1e6;
+
+    result["queries"] = probes.size();
+    result["galleryCount"] = templates.size();
+    result["templateCount"] = templateFeatures.size();
+    result["exactAccuracy"] = static_cast<double>(exactCorrect) / probes.size();
+    result["exactQueriesPerSecond"] = exactMs > 0 ? probes.size() * 1000.0 / exactMs : 0.0;
+
+    QJsonArray modes;
+    const QList<FaceGallery::Quantization> quantizations = {
+        FaceGallery::NoQuantization, FaceGallery::Float16, FaceGallery::Int8
+    };
+    for (FaceGallery::Quantization quantization : quantizations) {
+        FaceGallery gallery;
+        gallery.setQuantization(quantization);
+        for (auto it = templateFeatures.constBegin(); it != templateFeatures.constEnd(); ++it) {
+            gallery.setFeature(it.key(), it.value());
+        }
+
+        int agreed = 0;
+        int correct = 0;
+        double errorSum = 0.0;
+        double errorMax = 0.0;
+        int errorCount = 0;
+        qint64 searchNs = 0;
+
+        timer.start();
+        for (int i = 0; i < probes.size(); ++i) {
+            QElapsedTimer searchTimer;
+            searchTimer.start();
+            QList<FaceGallery::Candidate> candidates = gallery.candidates(probes[i], kRerankCandidates);
+            searchNs += searchTimer.nsecsElapsed();
+
+            float best = -1.0f;
+            QString bestId;
+            for (const FaceGallery::Candidate &candidate : candidates) {
+                QString workId = templateOwners.value(candidate.workId);
+                float similarity = templateScore(backend, probes[i], templates.value(workId), useMean);
+                if (similarity > best) {
+                    best = similarity;
+                    bestId = workId;
+                }
+            }
+            agreed += bestId == exactIds[i] ? 1 : 0;
+            correct += bestId == expectedIds[i] ? 1 : 0;
+
+            // 近似得分与全精度余弦相似度的误差
+            QVector<float> query = FaceGallery::normalized(probes[i]);
+            for (const FaceGallery::Candidate &candidate : candidates) {
+                QVector<float> target = FaceGallery::normalized(templateFeatures.value(candidate.workId));
+                double exactScore = 0.0;
+                for (int k = 0; k < query.size(); ++k) {
+                    exactScore += query[k] * target[k];
+                }
+                double error = std::abs(exactScore - candidate.score);
+                errorSum += error;
+                errorMax = std::max(errorMax, error);
+                ++errorCount;
+            }
+        }
+        double totalMs = timer.nsecsElapsed() / 1e6;
+
+        QJsonObject mode = QJsonObject::fromVariantMap(gallery.statistics());
+        mode["top1Agreement"] = static_cast<double>(agreed) / probes.size();
+        mode["accuracy"] = static_cast<double>(correct) / probes.size();
+        mode["meanScoreError"] = errorCount > 0 ? errorSum / errorCount : 0.0;
+        mode["maxScoreError"] = errorMax;
+        mode["searchQueriesPerSecond"] = searchNs > 0 ? probes.size() * 1e9 / searchNs : 0.0;
+        mode["queriesPerSecond"] = totalMs > 0 ? probes.size() * 1000.0 / totalMs : 0.0;
+        modes.append(mode);
+    }
+    result["modes"] = modes;
+    return result;
+}
+
+void printGalleryResult(const QJsonObject &result)
+{
+    if (result.contains("error")) {
+        out() << result["backend"].toString() << "  " << result["error"].toString() << Qt::endl;
+        return;
+    }
+    out() << QString("%1  测试图像 %2 张，注册 %3 人 %4 个模板  逐一比对准确率 %5  每秒 %6 次")
+             .arg(result["backend"].toString())
+             .arg(result["queries"].toInt())
+             .arg(result["galleryCount"].toInt())
+             .arg(result["templateCount"].toInt())
+             .arg(result["exactAccuracy"].toDouble(), 0, 'f', 3)
+             .arg(result["exactQueriesPerSecond"].toDouble(), 0, 'f', 0) << Qt::endl;
+    for (const QJsonValue &value : result["modes"].toArray()) {
+        QJsonObject mode = value.toObject();
+        out() << QString("    %1  首位一致率 %2  准确率 %3  得分误差 平均 %4 最大 %5  内存 %6/%7 字节  召回每秒 %8 次  含重排序每秒 %9 次")
+                 .arg(mode["quantization"].toString(), -6)
+                 .arg(mode["top1Agreement"].toDouble(), 0, 'f', 3)
+                 .arg(mode["accuracy"].toDouble(), 0, 'f', 3)
+                 .arg(mode["meanScoreError"].toDouble(), 0, 'f', 4)
+                 .arg(mode["maxScoreError"].toDouble(), 0, 'f', 4)
+                 .arg(mode["memoryBytes"].toDouble(), 0, 'f', 0)
+                 .arg(mode["fullPrecisionBytes"].toDouble(), 0, 'f', 0)
+                 .arg(mode["searchQueriesPerSecond"].toDouble(), 0, 'f', 0)
+                 .arg(mode["queriesPerSecond"].toDouble(), 0, 'f', 0) << Qt::endl;
+    }
+}
+
+/**
+ * 测试一个规模的HNSW索引：注册特征为随机方向，查询为某个注册特征加噪声（同一人的另一张照片）。
+ * 100000人时建索引需要数分钟、占用约1GB内存。
+ */
+QJsonObject benchmarkIndex(int count, int dimension)
+{
+    std::mt19937 random(count);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    QVector<QVector<float>> features(count);
+    for (QVector<float> &feature : features) {
+        feature.resize(dimension);
+        for (float &value : feature) {
+            value = normal(random);
+        }
+        feature = FaceGallery::normalized(feature);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    HnswIndex index;
+    for (int i = 0; i < count; ++i) {
+        index.setFeature(QString::number(i), features[i]);
+    }
+    double buildMs = timer.nsecsElapsed() / 1e6;
+
+    std::uniform_int_distribution<int> pick(0, count - 1);
+    int recallHits = 0;
+    int rerankHits = 0;
+    QVector<double> bruteForceMs;
+    QVector<double> indexMs;
+    for (int q = 0; q < kIndexQueries; ++q) {
+        QVector<float> query = features[pick(random)];
+        for (float &value : query) {
+            value += normal(random) * 0.03f;
+        }
+        query = FaceGallery::normalized(query);
+
+        // 逐一全精度比对
+        timer.start();
+        int exactBest = -1;
+        float exactScore = -2.0f;
+        for (int i = 0; i < count; ++i) {
+            const float *target = features[i].constData();
+            float score = 0.0f;
+            for (int k = 0; k < dimension; ++k) {
+                score += query[k] * target[k];
+            }
+            if (score > exactScore) {
+                exactScore = score;
+                exactBest = i;
+            }
+        }
+        bruteForceMs.append(timer.nsecsElapsed() / 1e6);
+
+        timer.start();
+        QList<FaceGallery::Candidate> candidates = index.candidates(query, kRerankCandidates);
+        indexMs.append(timer.nsecsElapsed() / 1e6);
+
+        QString expected = QString::number(exactBest);
+        if (!candidates.isEmpty() && candidates.first().workId == expected) {
+            ++recallHits;
+        }
+        // 与识别流程相同：最佳结果在候选中即可由重排序找回
+        for (const FaceGallery::Candidate &candidate : candidates) {
+            if (candidate.workId == expected) {
+                ++rerankHits;
+                break;
+            }
+        }
+    }
+
+    QJsonObject result = QJsonObject::fromVariantMap(index.statistics());
+    result["buildMs"] = buildMs;
+    result["queries"] = kIndexQueries;
+    result["recallAt1"] = static_cast<double>(recallHits) / kIndexQueries;
+    result["rerankRecallAt1"] = static_cast<double>(rerankHits) / kIndexQueries;
+    result["bruteForce"] = summarize(bruteForceMs);
+    result["index"] = summarize(indexMs);
+    return result;
+}
+
+void printIndexResult(const QJsonObject &result)
+{
+    QJsonObject bruteForce = result["bruteForce"].toObject();
+    QJsonObject index = result["index"].toObject();
+    out() << QString("人数 %1  维度 %2  建索引 %3ms  内存 %4 MB")
+             .arg(result["count"].toInt())
+             .arg(result["dimension"].toInt())
+             .arg(result["buildMs"].toDouble(), 0, 'f', 0)
+             .arg(result["memoryBytes"].toDouble() / (1024.0 * 1024.0), 0, 'f', 1) << Qt::endl;
+    out() << QString("    recall@1 %1  重排序后 %2  逐一比对 p50 %3ms  索引 p50 %4ms  p99 %5ms")
+             .arg(result["recallAt1"].toDouble(), 0, 'f', 3)
+             .arg(result["rerankRecallAt1"].toDouble(), 0, 'f', 3)
+             .arg(bruteForce["p50"].toDouble(), 0, 'f', 3)
+             .arg(index["p50"].toDouble(), 0, 'f', 3)
+             .arg(index["p99"].toDouble(), 0, 'f', 3) << Qt::endl;
+}
+
+QString configKey(const QJsonObject &config)
+{
+    return QString("%1/%2/%3").arg(config["backend"].toString())
+            .arg(config["threads"].toInt()).arg(config["resolution"].toInt());
+}
+
+/**
+ * 与基线比较，返回超过允许回退比例的阶段
+ */
+QStringList compareWithBaseline(const QJsonArray &results, const QJsonArray &baseline, double maxRegression)
+{
+    QHash<QString, QJsonObject> baselineConfigs;
+    for (const QJsonValue &value : baseline) {
+        baselineConfigs.insert(configKey(value.toObject()), value.toObject());
+    }
+
+    QStringList regressions;
+    for (const QJsonValue &value : results) {
+        QJsonObject config = value.toObject();
+        QString key = configKey(config);
+        if (!baselineConfigs.contains(key)) {
+            continue;
+        }
+        QJsonObject baseStages = baselineConfigs.value(key)["stages"].toObject();
+        QJsonObject stages = config["stages"].toObject();
+        for (const QString &stage : kStages) {
+            for (const QString &metric : {QString("p50"), QString("p90")}) {
+                double base = baseStages[stage].toObject()[metric].toDouble();
+                double current = stages[stage].toObject()[metric].toDouble();
+                if (base > 0.0 && current > base * (1.0 + maxRegression)) {
+                    regressions.append(QString("%1 %2 %3: %4ms -> %5ms")
+                                       .arg(key, stage, metric)
+                                       .arg(base, 0, 'f', 2).arg(current, 0, 'f', 2));
+                }
+            }
+        }
+    }
+    return regressions;
+}
+
+void printResult(const QJsonObject &result)
+{
+    out() << QString("%1  线程=%2  分辨率=%3")
+             .arg(result["backend"].toString())
+             .arg(result["threads"].toInt())
+             .arg(result["resolution"].toInt() > 0 ? QString::number(result["resolution"].toInt()) : QString("原始"));
+    if (result.contains("error")) {
+        out() << "  " << result["error"].toString() << Qt::endl;
+        return;
+    }
+    out() << QString("  %1 张/秒（每核 %2）  检出率 %3  峰值内存 %4 MB")
+             .arg(result["throughput"].toDouble(), 0, 'f', 1)
+             .arg(result["throughputPerCore"].toDouble(), 0, 'f', 1)
+             .arg(result["detectionRate"].toDouble(), 0, 'f', 3)
+             .arg(result["peakRssBytes"].toDouble() / (1024.0 * 1024.0), 0, 'f', 1) << Qt::endl;
+
+    QJsonObject stages = result["stages"].toObject();
+    for (const QString &stage : kStages) {
+        QJsonObject summary = stages[stage].toObject();
+        out() << QString("    %1 p50 %2ms  p90 %3ms  p99 %4ms  (n=%5)")
+                 .arg(stage, -8)
+                 .arg(summary["p50"].toDouble(), 0, 'f', 2)
+                 .arg(summary["p90"].toDouble(), 0, 'f', 2)
+                 .arg(summary["p99"].toDouble(), 0, 'f', 2)
+                 .arg(summary["count"].toInt()) << Qt::endl;
+    }
+}
+
+// 写入结果JSON，未指定文件时不写
+bool writeReport(const QString &path, const QJsonObject &report)
+{
+    if (path.isEmpty()) {
+        return true;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "无法写入结果文件:" << path;
+        return false;
+    }
+    file.write(QJsonDocument(report).toJson());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("FacePipelineBenchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("人脸识别流水线基准测试");
+    parser.addHelpOption();
+    parser.addPositionalArgument("images", "图像目录");
+    parser.addOptions({
+        {"backend", "识别后端：seeta、opencv_dnn或all", "name", "all"},
+        {"model-dir", "模型目录，默认按ModelLocator的顺序查找", "dir"},
+        {"threads", "线程数，逗号分隔", "list", "1"},
+        {"resolutions", "输入图像长边上限，逗号分隔，0为原始分辨率", "list", "0"},
+        {"iterations", "每个组合遍历图像的次数", "n", "3"},
+        {"gallery", "特征库人数（不足部分用固定种子的合成特征补齐）", "n", "1000"},
+        {"manifest", "语料清单，校验图像内容并只使用清单中的文件", "file"},
+        {"write-manifest", "为当前图像目录生成语料清单", "file"},
+        {"output", "结果JSON文件", "file"},
+        {"baseline", "基线结果JSON文件", "file"},
+        {"max-regression", "相对基线允许的p50/p90回退比例", "ratio", "0.1"},
+        {"mode", "pipeline：流水线各阶段耗时；backends：比较各后端的耗时、内存和准确率；"
+                 "gallery：特征库量化对识别的影响；index：HNSW索引的recall@1和检索耗时", "mode", "pipeline"},
+        {"threshold", "backends模式计算FAR、FRR使用的相似度阈值", "value", "0.6"},
+        {"enrol", "gallery模式的注册图像目录，图像按 工号_序号 命名", "dir"},
+        {"template-scoring", "gallery模式多模板的得分方式：max或mean", "mode", "max"},
+        {"index-sizes", "index模式的注册人数，逗号分隔", "list", "1000,10000,100000"},
+        {"dimension", "index模式的特征维度", "n", "1024"}
+    });
+    parser.process(app);
+
+    QString mode = parser.value("mode");
+    if (mode == "index") {
+        int dimension = qMax(1, parser.value("dimension").toInt());
+        QJsonArray sizes;
+        for (int count : parseIntList(parser.value("index-sizes"))) {
+            if (count <= 0) {
+                continue;
+            }
+            QJsonObject result = benchmarkIndex(count, dimension);
+            printIndexResult(result);
+            sizes.append(result);
+        }
+
+        QJsonObject report;
+        report["index"] = sizes;
+        return writeReport(parser.value("output"), report) ? 0 : 1;
+    }
+
+    if (parser.positionalArguments().isEmpty()) {
+        parser.showHelp(1);
+    }
+    QString imageDir = parser.positionalArguments().first();
+
+    QString fingerprint;
+    QList<CorpusImage> corpus = loadCorpus(imageDir, parser.value("manifest"), &fingerprint);
+    if (corpus.isEmpty()) {
+        qWarning() << "没有可用的图像:" << imageDir;
+        return 1;
+    }
+    if (parser.isSet("write-manifest") && !writeManifest(parser.value("write-manifest"), corpus)) {
+        return 1;
+    }
+
+    if (parser.isSet("model-dir")) {
+        ModelLocator::setConfiguredPath(parser.value("model-dir"));
+    }
+    QString modelDir = ModelLocator::locate();
+    if (modelDir.isEmpty()) {
+        qWarning() << "未找到模型目录";
+        return 1;
+    }
+
+    QStringList backends = parser.value("backend") == "all" ? FaceBackend::names() : QStringList(parser.value("backend"));
+    QList<int> threadCounts = parseIntList(parser.value("threads"));
+    QList<int> resolutions = parseIntList(parser.value("resolutions"));
+    int iterations = qMax(1, parser.value("iterations").toInt());
+    int gallerySize = qMax(0, parser.value("gallery").toInt());
+
+    out() << "语料: " << corpus.size() << " 张图像，指纹 " << fingerprint << Qt::endl;
+    out() << "模型目录: " << modelDir << "  CPU核数: " << QThread::idealThreadCount() << Qt::endl;
+
+    if (mode == "backends") {
+        QJsonArray comparisons;
+        float threshold = parser.value("threshold").toFloat();
+        for (const QString &backendName : backends) {
+            for (int resolution : resolutions) {
+                QJsonObject result = compareBackend(backendName, modelDir, resolution, threshold, corpus);
+                printBackendComparison(result);
+                comparisons.append(result);
+            }
+        }
+
+        QJsonObject report;
+        report["corpus"] = fingerprint;
+        report["images"] = corpus.size();
+        report["backends"] = comparisons;
+        return writeReport(parser.value("output"), report) ? 0 : 1;
+    }
+    if (mode == "gallery") {
+        QString enrolFingerprint;
+        QList<CorpusImage> enrolCorpus = loadCorpus(parser.value("enrol"), QString(), &enrolFingerprint);
+        if (enrolCorpus.isEmpty()) {
+            qWarning() << "没有可用的注册图像:" << parser.value("enrol");
+            return 1;
+        }
+
+        QJsonArray evaluations;
+        int resolution = resolutions.isEmpty() ? 0 : resolutions.first();
+        bool useMean = parser.value("template-scoring") == "mean";
+        for (const QString &backendName : backends) {
+            QSharedPointer<FaceBackend> backend = FaceBackend::create(backendName, modelDir);
+            QJsonObject result;
+            if (backend) {
+                result = evaluateGallery(backend.data(), enrolCorpus, corpus, resolution, useMean);
+            } else {
+                result["error"] = QString("无法加载后端 %1").arg(backendName);
+            }
+            result["backend"] = backendName;
+            printGalleryResult(result);
+            evaluations.append(result);
+        }
+
+        QJsonObject report;
+        report["corpus"] = fingerprint;
+        report["enrol"] = enrolFingerprint;
+        report["gallery"] = evaluations;
+        return writeReport(parser.value("output"), report) ? 0 : 1;
+    }
+    if (mode != "pipeline") {
+        qWarning() << "未知的模式:" << mode;
+        return 1;
+    }
+
+    QJsonArray results;
+    for (const QString &backendName : backends) {
+        QSharedPointer<FaceBackend> backend = FaceBackend::create(backendName, modelDir);
+        if (!backend) {
+            qWarning() << "无法加载后端:" << backendName;
+            continue;
+        }
+        FaceGallery gallery;
+        QHash<QString, QVector<float>> galleryFeatures;
+        buildGallery(backend.data(), corpus, gallerySize, gallery, galleryFeatures);
+        backend.reset();
+
+        for (int threads : threadCounts) {
+            for (int resolution : resolutions) {
+                QJsonObject result = runConfig(backendName, modelDir, qMax(1, threads), resolution, iterations,
+                                               corpus, gallery, galleryFeatures);
+                result["gallerySize"] = gallery.size();
+                printResult(result);
+                results.append(result);
+            }
+        }
+    }
+
+    QJsonObject report;
+    report["corpus"] = fingerprint;
+    report["images"] = corpus.size();
+    report["iterations"] = iterations;
+    report["cpuCores"] = QThread::idealThreadCount();
+    report["results"] = results;
+
+    if (!writeReport(parser.value("output"), report)) {
+        return 1;
+    }
+
+    if (parser.isSet("baseline")) {
+        QFile file(parser.value("baseline"));
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "无法读取基线文件:" << parser.value("baseline");
+            return 1;
+        }
+        QJsonObject baseline = QJsonDocument::fromJson(file.readAll()).object();
+        if (baseline["corpus"].toString() != fingerprint) {
+            qWarning() << "基线使用的语料与本次不同，结果不可比较";
+            return 1;
+        }
+        QStringList regressions = compareWithBaseline(results, baseline["results"].toArray(),
+                                                      parser.value("max-regression").toDouble());
+        if (!regressions.isEmpty()) {
+            out() << "相对基线的性能回退:" << Qt::endl;
+            for (const QString &regression : regressions) {
+                out() << "  " << regression << Qt::endl;
+            }
+            return 2;
+        }
+        out() << "与基线相比没有超过允许范围的回退" << Qt::endl;
+    }
+
+    return 0;
+}
@@ -3,13 +3,21 @@
 #include <QQmlContext>
 #include <QIcon>
 #include <QDir>
-#include <QFileInfo>
-#include <QProcess>
+#include <QTimer>
+#include <QQuickWindow>
 #include "FileManager.h"
 #include "DatabaseManager.h"
 #include "FaceRecognizer.h"
+#include "FaceBackend.h"
 #include "LogManager.h"
 #include "SerialPortManager.h"
+#include "KnowledgePointCarousel.h"
+#include "PagedListModels.h"
+#include "AvatarImageProvider.h"
+#include "ModelLocator.h"
+#include "StartupTracer.h"
+#include "PerfTrace.h"
+#include "InferenceExecutor.h"
 #include <QMediaDevices>
 #include <QAudioDevice>
 
@@ -17,42 +25,18 @@
 #include <QtWebEngineQuick/QtWebEngineQuick>
 #endif
 
-// 检查文件是否存在并输出信息的辅助函数
-void checkFileExists(const QString &filePath) {
-    QFileInfo fileInfo(filePath);
-    qDebug() << "检查文件:" << filePath;
-    qDebug() << "  - 存在:" << (fileInfo.exists() ? "是" : "否");
-    if (fileInfo.exists()) {
-        qDebug() << "  - 大小:" << fileInfo.size() << "字节";
-        qDebug() << "  - 权限:" << (fileInfo.isReadable() ? "可读 " : "不可读 ")
-                 << (fileInfo.isWritable() ? "可写 " : "不可写 ")
-                 << (fileInfo.isExecutable() ? "可执行" : "不可执行");
-    }
-}
-
-// 检查目录并列出内容的辅助函数
-void listDirectoryContents(const QString &dirPath) {
-    QDir dir(dirPath);
-    if (dir.exists()) {
-        qDebug() << "目录内容:" << dirPath;
-        QStringList entries = dir.entryList(QDir::AllEntries | QDir::NoDotAndDotDot);
-        for (const QString &entry : entries) {
-            QFileInfo info(dir.absoluteFilePath(entry));
-            qDebug() << "  - " << entry
-                     << (info.isDir() ? " [目录]" : "")
-                     << (info.isFile() ? " [文件]" : "")
-                     << (info.isSymLink() ? " [链接]" : "");
-        }
-    } else {
-        qDebug() << "目录不存在:" << dirPath;
-    }
-}
-
 int main(int argc, char *argv[])
 {
+    // 启动追踪（--startup-trace <文件>、--exit-after-first-frame）
+    StartupTracer &tracer = StartupTracer::getInstance();
+    tracer.parseArguments(argc, argv);
+    tracer.begin("启动至首帧");
+    
     // 初始化日志系统
+    tracer.begin("初始化日志");
     LogManager::getInstance().init();
     LogManager::getInstance().installMessageHandler();
+    tracer.end("初始化日志");
 
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
@@ -60,13 +44,16 @@ int main(int argc, char *argv[])
 
     // 创建临时QCoreApplication用于读取数据库设置
     {
+        StartupTracer::Scope settingsScope("读取启动设置");
         QCoreApplication tempApp(argc, argv);
         
         // 创建临时数据库管理器实例来读取设置
+        tracer.begin("临时数据库初始化");
         DatabaseManager tempDbManager;
         if (!tempDbManager.initDatabase()) {
             qDebug() << "数据库初始化失败，将使用默认设置";
         }
+        tracer.end("临时数据库初始化");
         
         // 从数据库读取虚拟键盘设置
         QString enableVirtualKeyboard = tempDbManager.getSetting("enable_virtual_keyboard", "true");
@@ -98,94 +85,102 @@ int main(int argc, char *argv[])
     } // 临时QCoreApplication在这里被销毁
 
     // 创建真正的应用程序实例
+    tracer.begin("创建应用程序");
     QGuiApplication app(argc, argv);
+    tracer.end("创建应用程序");
     
     // 检查输入法模块
     qDebug() << "当前输入法模块:" << QGuiApplication::inputMethod()->objectName();
     
 #ifdef HAS_WEBENGINE
     // 初始化 QtWebEngineQuick
+    tracer.begin("初始化WebEngine");
     QtWebEngineQuick::initialize();
+    tracer.end("初始化WebEngine");
 #endif
     
-    // 详细的启动日志
+    // 启动日志
     qDebug() << "\n\n====================== 应用程序启动 ======================";
     qDebug() << "应用程序路径:" << QCoreApplication::applicationFilePath();
-    qDebug() << "应用程序目录:" << QCoreApplication::applicationDirPath();
     qDebug() << "当前工作目录:" << QDir::currentPath();
     
-    // 检查环境变量
-    qDebug() << "\n----- 环境变量 -----";
-    QStringList envVars = QProcess::systemEnvironment();
-    for (const QString &var : envVars) {
-        if (var.startsWith("PATH=") || var.startsWith("Path=")) {
-            qDebug() << var;
-        }
-    }
-    
-    // 检查应用程序目录中的模型文件
-    qDebug() << "\n----- 模型文件检查 -----";
-    QString appDir = QCoreApplication::applicationDirPath();
-    // 检查model子目录
-    listDirectoryContents(appDir + "/model");
-    
-    // 检查具体的模型文件
-    checkFileExists(appDir + "/model/fd_2_00.dat");
-    checkFileExists(appDir + "/model/pd_2_00_pts5.dat");
-    checkFileExists(appDir + "/model/fr_2_10.dat");
-    
-    // 检查根目录中的模型文件（也可能放在这里）
-    checkFileExists(appDir + "/fd_2_00.dat");
-    checkFileExists(appDir + "/pd_2_00_pts5.dat");
-    checkFileExists(appDir + "/fr_2_10.dat");
-    
-    // 检查DLL文件
-    qDebug() << "\n----- DLL文件检查 -----";
-    checkFileExists(appDir + "/SeetaFaceDetector.dll");
-    checkFileExists(appDir + "/SeetaFaceLandmarker.dll");
-    checkFileExists(appDir + "/SeetaFaceRecognizer.dll");
-    checkFileExists(appDir + "/SeetaNet.dll");
-    
     // 设置应用程序图标
     app.setWindowIcon(QIcon(":/images/SparkExamAI.ico"));
     
     QQmlApplicationEngine engine;
     
+    // 注册调用统计（调试页面查看和导出）
+    engine.rootContext()->setContextProperty("perfTrace", &PerfTrace::getInstance());
+    
     // 创建FileManager实例并注册到QML上下文
     FileManager fileManager;
     engine.rootContext()->setContextProperty("fileManager", &fileManager);
     
+    // 识别器先于dbManager创建，退出时晚于dbManager析构（dbManager析构时保存人脸索引）
+    FaceRecognizer faceRecognizer;
+    
     // 创建DatabaseManager实例并注册到QML上下文
+    tracer.begin("初始化数据库");
     DatabaseManager dbManager;
     if (!dbManager.initDatabase()) {
         qDebug() << "数据库初始化失败";
     }
     engine.rootContext()->setContextProperty("dbManager", &dbManager);
-    
-    qDebug() << "\n----- 开始初始化人脸识别器 -----";
-    // 创建FaceRecognizer实例并注册到QML上下文
-    FaceRecognizer faceRecognizer;
-    if (!faceRecognizer.initialize()) {
-        qDebug() << "人脸识别器初始化失败 - 但仍继续运行";
-        qDebug() << "请检查以下内容：";
-        qDebug() << "1. 模型文件是否存在于正确位置";
-        qDebug() << "2. DLL文件是否存在于应用程序目录";
-        qDebug() << "3. 应用程序是否有足够的权限访问这些文件";
-    } else {
-        qDebug() << "人脸识别器初始化成功";
-    }
+    tracer.end("初始化数据库");
+    
+    // 创建首页智点轮播并注册到QML上下文
+    tracer.begin("创建智点轮播");
+    KnowledgePointCarousel knowledgePointCarousel(&dbManager);
+    engine.rootContext()->setContextProperty("knowledgePointCarousel", &knowledgePointCarousel);
+    tracer.end("创建智点轮播");
+    
+    // 注册头像缩略图提供器（image://avatars/<工号>），由QML引擎负责释放
+    tracer.begin("注册头像提供器");
+    AvatarImageProvider *avatarImageProvider = new AvatarImageProvider;
+    avatarImageProvider->setUserImagePaths(dbManager.getUserImagePaths());
+    QObject::connect(&dbManager, &DatabaseManager::userImagesChanged,
+                     avatarImageProvider, &AvatarImageProvider::updateUserImages);
+    QObject::connect(&dbManager, &DatabaseManager::userImagesRemoved,
+                     avatarImageProvider, &AvatarImageProvider::removeUserImages);
+    engine.addImageProvider("avatars", avatarImageProvider);
+    tracer.end("注册头像提供器");
+    
+    // 创建FaceRecognizer实例并注册到QML上下文，模型在界面显示后于后台加载
+    ModelLocator::setConfiguredPath(dbManager.getSetting("face_model_path", ""));
+    FaceBackend::setConfiguredName(dbManager.getSetting("face_backend", "seeta"));
+    InferenceExecutor::getInstance().configure(dbManager.getSetting("face_inference_profile", "balanced"),
+                                               dbManager.getSetting("face_inference_threads", "0").toInt(),
+                                               dbManager.getSetting("face_inference_cores", ""));
+    engine.rootContext()->setContextProperty("inferenceExecutor", &InferenceExecutor::getInstance());
+    // 识别与跟踪共用同一个识别器，跟踪轨迹未中断时复用已确认的身份
+    dbManager.setFaceRecognizer(&faceRecognizer);
+    QObject::connect(&faceRecognizer, &FaceRecognizer::initializedChanged, &app, [&tracer]() {
+        tracer.end("后台加载人脸模型");
+        qDebug() << "人脸识别模型就绪，距启动" << tracer.elapsedMs() << "ms";
+    });
+    QObject::connect(&faceRecognizer, &FaceRecognizer::initializationFailed, &app, [&tracer]() {
+        tracer.end("后台加载人脸模型");
+        qDebug() << "人脸识别器初始化失败 - 但仍继续运行，请检查模型目录或设置项 face_model_path";
+    });
     engine.rootContext()->setContextProperty("faceRecognizer", &faceRecognizer);
     
-    // 创建SerialPortManager实例并注册到QML上下文
+    // 创建SerialPortManager实例并注册到QML上下文（构造时会按设置自动连接串口）
+    tracer.begin("创建串口管理器");
     SerialPortManager serialPortManager;
     engine.rootContext()->setContextProperty("serialPortManager", &serialPortManager);
+    tracer.end("创建串口管理器");
     
     // 注册SerialPortManager类型
+    tracer.begin("注册QML类型");
     qmlRegisterType<SerialPortManager>("SerialPortManager", 1, 0, "SerialPortManager");
     
+    // 注册分页列表模型类型
+    qmlRegisterType<FaceDataListModel>("PagedListModels", 1, 0, "FaceDataListModel");
+    
     // 注册MediaDevices类型
     qmlRegisterType<QMediaDevices>("QtMultimedia", 6, 0, "MediaDevices");
     qmlRegisterType<QAudioDevice>("QtMultimedia", 6, 0, "AudioDevice");
+    tracer.end("注册QML类型");
     
     const QUrl url(QStringLiteral("qrc:/main.qml"));
     QObject::connect(&engine, &QQmlApplicationEngine::objectCreated,
@@ -193,7 +188,45 @@ int main(int argc, char *argv[])
             if (!obj && url == objUrl)
                 QCoreApplication::exit(-1);
         }, Qt::QueuedConnection);
+    tracer.begin("加载QML界面");
     engine.load(url);
+    tracer.end("加载QML界面");
+    
+    // 首帧显示后输出启动耗时，并开始后台加载人脸识别模型
+    auto onFirstFrame = [&tracer, &faceRecognizer]() {
+        tracer.instant("首帧显示");
+        tracer.end("启动至首帧");
+        tracer.report();
+        
+        if (tracer.exitAfterFirstFrame()) {
+            // 用于CI测量启动耗时：写入追踪文件后直接退出，不加载人脸模型
+            tracer.writeTrace();
+            QTimer::singleShot(0, QCoreApplication::instance(), &QCoreApplication::quit);
+            return;
+        }
+        
+        if (!faceRecognizer.isInitialized()) {
+            tracer.begin("后台加载人脸模型");
+            faceRecognizer.initializeAsync();
+        }
+    };
+    
+    QQuickWindow *window = engine.rootObjects().isEmpty()
+            ? nullptr : qobject_cast<QQuickWindow *>(engine.rootObjects().first());
+    if (window) {
+        QObject::connect(window, &QQuickWindow::frameSwapped, &app, onFirstFrame, Qt::SingleShotConnection);
+        // 按推理配置统计人脸推理期间的界面掉帧
+        InferenceExecutor::getInstance().attachWindow(window);
+    } else {
+        onFirstFrame();
+    }
+    
+    // 正常退出时写入追踪文件（包含后台模型加载）
+    if (!tracer.traceFilePath().isEmpty() && !tracer.exitAfterFirstFrame()) {
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, &app, [&tracer]() {
+            tracer.writeTrace();
+        });
+    }
     
     qDebug() << "====================== 应用程序初始化完成 ======================\n";
 
@@ -898,43 +898,47 @@ Window {
                     loadKnowledgePoints()
                 }
 
-                // 加载智点列表
+                // 加载智点列表（智点ID列表和预取内容由C++端knowledgePointCarousel维护）
                 function loadKnowledgePoints() {
                     console.log("开始加载智点列表")
-                    var points = dbManager.getAllKnowledgePoints()
-                    console.log("从数据库获取到", points.length, "个智点")
-                    
-                    if (points.length > 0) {
-                        currentKnowledgePointIndex = 0
-                        displayKnowledgePoint(points[currentKnowledgePointIndex])
-                        // 启动定时器
-                        knowledge_point_timer.start()
-                    } else {
-                        knowledge_point_title.text = "暂无智点"
-                        knowledge_point_content.text = "请先在策略引擎中添加智点"
-                    }
+                    knowledgePointCarousel.reload()
+                    console.log("从数据库获取到", knowledgePointCarousel.count, "个智点")
+                    updateKnowledgePointState()
                 }
 
                 // 切换到下一个智点
                 function switchToNextKnowledgePoint() {
                     console.log("切换到下一个智点")
-                    var points = dbManager.getAllKnowledgePoints()
-                    if (points.length > 0) {
-                        currentKnowledgePointIndex = (currentKnowledgePointIndex + 1) % points.length
-                        displayKnowledgePoint(points[currentKnowledgePointIndex])
-                        console.log("显示智点:", points[currentKnowledgePointIndex].title)
-                    }
+                    knowledgePointCarousel.next()
+                    console.log("显示智点:", knowledgePointCarousel.title)
                 }
 
-                // 显示智点
-                function displayKnowledgePoint(point) {
-                    knowledge_point_title.text = point.title
-                    knowledge_point_content.text = point.content
-                    console.log("更新显示智点 - 标题:", point.title)
+                // 根据智点数量显示提示并启停定时器
+                function updateKnowledgePointState() {
+                    if (knowledgePointCarousel.count > 0) {
+                        if (visible) {
+                            knowledge_point_timer.start()
+                        }
+                    } else {
+                        knowledge_point_timer.stop()
+                        knowledge_point_title.text = "暂无智点"
+                        knowledge_point_content.text = "请先在策略引擎中添加智点"
+                    }
                 }
 
-                // 当前显示的智点索引
-                property int currentKnowledgePointIndex: 0
+                // 显示当前智点
+                Connections {
+                    target: knowledgePointCarousel
+                    function onCurrentChanged() {
+                        if (knowledgePointCarousel.count > 0) {
+                            knowledge_point_title.text = knowledgePointCarousel.title
+                            knowledge_point_content.text = knowledgePointCarousel.content
+                        }
+                    }
+                    function onCountChanged() {
+                        knowledge_point_bg_image.updateKnowledgePointState()
+                    }
+                }
 
                 // 确保组件可见时定时器运行，不可见时停止
                 onVisibleChanged: {
@@ -943,7 +947,9 @@ Window {
                         var interval = dbManager.getSetting("knowledge_point_switch_interval", "7")
                         knowledge_point_timer.interval = parseInt(interval) * 1000
                         console.log("更新定时器间隔为:", interval, "秒")
-                        knowledge_point_timer.restart()
+                        if (knowledgePointCarousel.count > 0) {
+                            knowledge_point_timer.restart()
+                        }
                     } else {
                         knowledge_point_timer.stop()
                     }
@@ -2173,32 +2179,6 @@ Window {
                     function refreshRankingImages() {
                         console.log("刷新排行榜图像");
                         
-                        // 修复路径格式的辅助函数
-                        function fixPath(path) {
-                            if (!path || path.toString().trim() === "") {
-                                return ""; // 返回空字符串而不是默认头像
-                            }
-                            
-                            var fixedPath = path.toString().trim();
-                            
-                            // 该路径已经是QUrl格式，直接返回
-                            if (fixedPath.startsWith("file:///")) {
-                                console.log("路径已经是URL格式，不需要修正:", fixedPath);
-                                return fixedPath;
-                            }
-                            
-                            // 替换反斜杠为正斜杠
-                            fixedPath = fixedPath.replace(/\\/g, "/");
-                            
-                            // 确保有file:///前缀
-                            if (!fixedPath.startsWith("file:///")) {
-                                fixedPath = "file:///" + fixedPath;
-                            }
-                            
-                            console.log("原始路径:", path, "修正后:", fixedPath);
-                            return fixedPath;
-                        }
-                        
                         // 首先将所有头像设置为空
                         firstPlaceAvatar.source = "";
                         secondPlaceAvatar.source = "";
@@ -2206,24 +2186,28 @@ Window {
                         
                         // 延迟一下再尝试加载真实头像
                         Qt.callLater(function() {
+                            // 头像通过avatars图像提供器加载缩略图
                             if (userButtonModel.count > 0) {
                                 var path1 = userButtonModel.get(0).avatarPath;
                                 if (path1 && path1 !== "") {
-                                    firstPlaceAvatar.source = fixPath(path1);
+                                    firstPlaceAvatar.source = "image://avatars/" + userButtonModel.get(0).workId
+                                            + "?v=" + dbManager.getUserImageVersion(userButtonModel.get(0).workId);
                                 }
                             }
                             
                             if (userButtonModel.count > 1) {
                                 var path2 = userButtonModel.get(1).avatarPath;
                                 if (path2 && path2 !== "") {
-                                    secondPlaceAvatar.source = fixPath(path2);
+                                    secondPlaceAvatar.source = "image://avatars/" + userButtonModel.get(1).workId
+                                            + "?v=" + dbManager.getUserImageVersion(userButtonModel.get(1).workId);
                                 }
                             }
                             
                             if (userButtonModel.count > 2) {
                                 var path3 = userButtonModel.get(2).avatarPath;
                                 if (path3 && path3 !== "") {
-                                    thirdPlaceAvatar.source = fixPath(path3);
+                                    thirdPlaceAvatar.source = "image://avatars/" + userButtonModel.get(2).workId
+                                            + "?v=" + dbManager.getUserImageVersion(userButtonModel.get(2).workId);
                                 }
                             }
                         });
@@ -2435,6 +2419,7 @@ Window {
             
             // 停止人脸追踪框旋转
             faceRecognizer.stopRotation()
+            faceRecognizer.resetTracking()
             
             // 清理变量
             isRecognizing = false
@@ -2487,7 +2472,7 @@ Window {
         // 人脸跟踪定时器
         Timer {
             id: faceTrackingTimer
-            interval: 200  // 减少为200毫秒，提高跟踪速度
+            interval: 100  // 跟踪时只在人脸附近区域检测，可以提高跟踪频率
             repeat: true
             running: false
             onTriggered: {
@@ -2540,10 +2525,25 @@ Window {
                 return
             }
             
-            // 使用FaceRecognizer检测人脸位置
-            var faceInfo = faceRecognizer.detectFacePosition(path)
-            console.log("Face detection result: " + JSON.stringify(faceInfo))
-            
+            // 在推理线程上跟踪人脸位置（关键帧全图检测，其余帧在人脸附近区域检测并平滑），
+            // 结果由onFaceTracked处理；推理线程正忙或模型加载中时丢弃本帧，界面不等待
+            if (!faceRecognizer.trackFacePositionAsync(path)) {
+                console.log("Face tracking busy or model loading, frame skipped")
+            }
+        }
+        
+        // 异步人脸跟踪结果
+        Connections {
+            target: faceRecognizer
+            function onFaceTracked(faceInfo) {
+                if (faceRecognitionPopup.visible) {
+                    faceRecognitionPopup.applyTrackedFace(faceInfo)
+                }
+            }
+        }
+        
+        // 根据跟踪结果更新人脸框
+        function applyTrackedFace(faceInfo) {
             if (faceInfo.faceDetected) {
                 console.log("Face detected at: x=" + faceInfo.x + ", y=" + faceInfo.y + 
                            ", width=" + faceInfo.width + ", height=" + faceInfo.height)
@@ -2602,9 +2602,14 @@ Window {
             // 停止定时器，避免重复识别
             periodicRecognitionTimer.stop()
             
-            // 首先检查是否检测到人脸
-            var faceInfo = faceRecognizer.detectFacePosition(imagePath)
-            if (!faceInfo.faceDetected) {
+            // 显示正在识别状态
+            statusText.text = "正在识别人脸..."
+            
+            // 调用后端进行人脸识别（后端先检测人脸并评估质量，质量不合格时不进行比对）
+            var result = dbManager.recognizeFace(imagePath)
+            console.log("人脸识别结果: " + JSON.stringify(result))
+            
+            if (!result.faceDetected) {
                 console.log("未检测到人脸，无法识别")
                 statusText.text = "未检测到人脸，请正对摄像头"
                 // 重新启动定时器继续识别
@@ -2612,12 +2617,12 @@ Window {
                 return
             }
             
-            // 显示正在识别状态
-            statusText.text = "正在识别人脸..."
-            
-            // 调用后端进行人脸识别
-            var result = dbManager.recognizeFace(imagePath)
-            console.log("人脸识别结果: " + JSON.stringify(result))
+            if (result.qualityRejected) {
+                // 质量不合格，提示用户调整后自动重新采集
+                statusText.text = result.qualityMessage
+                periodicRecognitionTimer.start()
+                return
+            }
             
             if (result.recognized) {
                 // 识别成功
@@ -2966,6 +2971,7 @@ Window {
     // 开始人脸跟踪
     function startFaceTracking() {
         console.log("开始人脸跟踪...")
+        faceRecognizer.resetTracking()
         faceTrackingTimer.start()
         statusText.text = "请将面部对准摄像头..."
         
@@ -3137,13 +3143,9 @@ Window {
                         if (!userVerificationDialog.userData || !userVerificationDialog.userData.avatarPath) {
                             return ""
                         }
-                        var path = userVerificationDialog.userData.avatarPath
-                        // 如果路径已经包含file:///前缀，直接返回
-                        if (path.startsWith("file:///")) {
-                            return path
-                        }
-                        // 否则添加file:///前缀
-                        return "file:///" + path
+                        // 通过avatars图像提供器加载头像缩略图
+                        return "image://avatars/" + userVerificationDialog.userData.workId
+                               + "?v=" + dbManager.getUserImageVersion(userVerificationDialog.userData.workId)
                     }
                     fillMode: Image.PreserveAspectCrop
                 }